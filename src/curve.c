@@ -0,0 +1,129 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "curve.h"
+
+static const float binomial[CURVE_MAX_ORDER + 1][CURVE_MAX_ORDER + 1] = {
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 1.0f, 1.0f, 0.0f, 0.0f },
+	{ 1.0f, 2.0f, 1.0f, 0.0f },
+	{ 1.0f, 3.0f, 3.0f, 1.0f }
+};
+
+/*
+ * Convert bernstein control points to power basis:
+ * c[j] = C(n,j) * sum(i = 0..j) (-1)^(j-i) * C(j,i) * p[i]
+ */
+
+void bezier_to_poly(const float point[], int order, float poly[])
+{
+	int i, j;
+
+	if (order < 0)
+		order = 0;
+	else if (order > CURVE_MAX_ORDER)
+		order = CURVE_MAX_ORDER;
+
+	for (j = 0; j <= CURVE_MAX_ORDER; j++) {
+		float sum = 0.0f;
+
+		if (j > order) {
+			poly[j] = 0.0f;
+			continue;
+		}
+
+		for (i = 0; i <= j; i++) {
+			float term = binomial[j][i] * point[i];
+			sum += ((j - i) & 1) ? -term : term;
+		}
+
+		poly[j] = binomial[order][j] * sum;
+	}
+}
+
+void curve_init(struct curve *curve)
+{
+	int i;
+	for (i = 0; i <= CURVE_MAX_ORDER; i++)
+		vec4_zero(&curve->coeff[i]);
+	curve->order = 0;
+}
+
+void curve_set_channel(struct curve *curve, int channel, const float point[],
+	int order)
+{
+	float poly[CURVE_MAX_ORDER + 1];
+	int i;
+
+	bezier_to_poly(point, order, poly);
+
+	for (i = 0; i <= CURVE_MAX_ORDER; i++)
+		curve->coeff[i].ptr[channel] = poly[i];
+
+	if (order > curve->order)
+		curve->order = order > CURVE_MAX_ORDER ? CURVE_MAX_ORDER : order;
+}
+
+void curve_build_arc_table(const struct curve *curve,
+	struct curve_arc_table *table)
+{
+	struct vec4 prev, cur;
+	int i;
+
+	curve_eval(curve, 0.0f, &prev);
+	table->length[0] = 0.0f;
+
+	for (i = 1; i <= CURVE_ARC_SAMPLES; i++) {
+		float dx, dy;
+
+		curve_eval(curve, (float)i / CURVE_ARC_SAMPLES, &cur);
+		dx = cur.ptr[CURVE_POS_X] - prev.ptr[CURVE_POS_X];
+		dy = cur.ptr[CURVE_POS_Y] - prev.ptr[CURVE_POS_Y];
+		table->length[i] = table->length[i - 1] + sqrtf(dx * dx + dy * dy);
+		prev = cur;
+	}
+}
+
+float curve_arc_param(const struct curve_arc_table *table, float percent)
+{
+	float total = table->length[CURVE_ARC_SAMPLES];
+	float target, span;
+	int low = 0;
+	int high = CURVE_ARC_SAMPLES;
+
+	if (percent <= 0.0f || percent >= 1.0f || total <= 0.0f)
+		return percent;
+
+	target = percent * total;
+
+	while (high - low > 1) {
+		int mid = (low + high) / 2;
+		if (table->length[mid] <= target)
+			low = mid;
+		else
+			high = mid;
+	}
+
+	span = table->length[high] - table->length[low];
+	if (span <= 0.0f)
+		return (float)low / CURVE_ARC_SAMPLES;
+
+	return (low + (target - table->length[low]) / span) / CURVE_ARC_SAMPLES;
+}
@@ -0,0 +1,87 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/vec4.h>
+
+#define CURVE_MAX_ORDER     3
+#define CURVE_ARC_SAMPLES   64
+
+enum {
+	CURVE_POS_X = 0,
+	CURVE_POS_Y = 1,
+	CURVE_SCALE_X = 2,
+	CURVE_SCALE_Y = 3
+};
+
+/*
+ * A bezier curve stored as power basis polynomial, one lane per channel.
+ * coeff[i] holds the t^i term of every channel, so a single horner pass
+ * evaluates position and scale together.
+ */
+
+struct curve {
+	struct vec4         coeff[CURVE_MAX_ORDER + 1];
+	int                 order;
+};
+
+/*
+ * Cumulative length of the position lanes sampled at even steps of t,
+ * used to map a time fraction to a constant speed curve parameter.
+ */
+
+struct curve_arc_table {
+	float               length[CURVE_ARC_SAMPLES + 1];
+};
+
+void curve_init(struct curve *curve);
+
+void curve_set_channel(struct curve *curve, int channel, const float point[],
+	int order);
+
+static inline void curve_eval(const struct curve *curve, float t,
+	struct vec4 *result)
+{
+	int i = curve->order;
+
+	vec4_copy(result, &curve->coeff[i]);
+	while (i-- > 0) {
+		vec4_mulf(result, result, t);
+		vec4_add(result, result, &curve->coeff[i]);
+	}
+}
+
+void curve_build_arc_table(const struct curve *curve,
+	struct curve_arc_table *table);
+
+float curve_arc_param(const struct curve_arc_table *table, float percent);
+
+/* Always writes CURVE_MAX_ORDER + 1 coefficients, zero above order. */
+void bezier_to_poly(const float point[], int order, float poly[]);
+
+static inline float poly_eval(const float poly[], int order, float t)
+{
+	float result = poly[order];
+	while (order-- > 0)
+		result = result * t + poly[order];
+	return result;
+}
@@ -23,27 +23,71 @@
 #include <util/dstr.h>
 
 
-obs_sceneitem_t *get_item(obs_source_t *context,
-	const char *name)
+struct item_search {
+	const char          *name;
+	int64_t             id;
+	obs_sceneitem_t     *result;
+};
+
+static bool search_group_items(obs_scene_t *scene, obs_sceneitem_t *item,
+	void *param)
 {
-	obs_source_t *source = obs_filter_get_parent(context);
-	obs_scene_t *scene = obs_scene_from_source(source);
-	return obs_scene_find_source(scene, name);
+	struct item_search *search = param;
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	const char *name = obs_source_get_name(source);
+
+	if (search->name ? (name && strcmp(name, search->name) == 0) :
+		obs_sceneitem_get_id(item) == search->id) {
+		search->result = item;
+		return false;
+	}
+
+	if (obs_sceneitem_is_group(item))
+		obs_sceneitem_group_enum_items(item, search_group_items, param);
+
+	UNUSED_PARAMETER(scene);
+	return !search->result;
 }
 
-obs_sceneitem_t *get_item_by_id(obs_source_t* context, 
+/*
+ * Top level items are matched first, so a name shared with an item inside
+ * a group keeps resolving to the top level one as before.
+ */
+
+static obs_sceneitem_t *find_item(obs_source_t *context, const char *name,
 	int64_t id)
 {
 	obs_source_t *source = obs_filter_get_parent(context);
 	obs_scene_t *scene = obs_scene_from_source(source);
-	obs_sceneitem_t* item = obs_scene_find_sceneitem_by_id(scene, id);
-	return item;
+	struct item_search search = { name, id, NULL };
+	obs_sceneitem_t *item;
+
+	if (!scene)
+		return NULL;
+
+	if (name)
+		item = obs_scene_find_source(scene, name);
+	else
+		item = obs_scene_find_sceneitem_by_id(scene, id);
+
+	if (!item)
+		obs_scene_enum_items(scene, search_group_items, &search);
+
+	return item ? item : search.result;
 }
 
-int64_t get_item_id(obs_source_t* context, const char* name)
+obs_sceneitem_t *get_item(obs_source_t *context,
+	const char *name)
 {
-	obs_sceneitem_t *item = get_item(context, name);
-	return item ? obs_sceneitem_get_id(item) : -1;
+	if (!name)
+		return NULL;
+	return find_item(context, name, 0);
+}
+
+obs_sceneitem_t *get_item_by_id(obs_source_t* context, 
+	int64_t id)
+{
+	return find_item(context, NULL, id);
 }
 
 bool cal_size(obs_sceneitem_t* item, float sx, float sy,
@@ -109,6 +153,48 @@ bool is_program_scene(obs_source_t *scene)
 	return true;
 }
 
+/*
+ * Workaround way to judge if is a private scene, like the duplicate of
+ * the preview studio mode hands to transitions. It may carry the name of
+ * the scene it copies, but lookups by name only find public sources.
+ */
+
+bool is_private_scene(obs_source_t *scene)
+{
+	obs_source_t *source;
+	bool result;
+
+	if (!obs_scene_from_source(scene))
+		return false;
+
+	source = obs_get_source_by_name(obs_source_get_name(scene));
+	result = source != scene;
+	obs_source_release(source);
+	return result;
+}
+
+/*
+ * Whether the main output shows the scene, or transitions to it. Scenes
+ * nested in the program are active too but are not on the output.
+ */
+
+bool is_output_scene(obs_source_t *scene)
+{
+	obs_source_t *output = obs_get_output_source(0);
+	obs_source_t *active = output;
+	bool result;
+
+	if (output && obs_source_get_type(output) == OBS_SOURCE_TYPE_TRANSITION)
+		active = obs_transition_get_active_source(output);
+	else
+		obs_source_addref(active);
+
+	result = scene && active == scene;
+	obs_source_release(active);
+	obs_source_release(output);
+	return result;
+}
+
 obs_hotkey_id register_hotkey(obs_source_t *context, obs_source_t *scene, 
 	const char *name, const char *text, obs_hotkey_func func, void *data)
 {
@@ -207,3 +293,52 @@ void crop_linear(struct obs_sceneitem_crop a, struct obs_sceneitem_crop b,
 	result->top = (1.0f - t) * a.top + t * b.top;
 	result->right = (1.0f - t) * a.right + t * b.right;
 }
+
+void motion_cost_add(struct motion_cost *cost, uint64_t ns)
+{
+	cost->samples++;
+	cost->total_ns += ns;
+	if (ns > cost->max_ns)
+		cost->max_ns = ns;
+}
+
+void motion_cost_to_calldata(const struct motion_cost *cost, calldata_t *cd,
+	const char *prefix)
+{
+	struct dstr name = { 0 };
+	uint64_t avg = cost->samples ? cost->total_ns / cost->samples : 0;
+
+	dstr_printf(&name, "%ssamples", prefix);
+	calldata_set_int(cd, name.array, (long long)cost->samples);
+	dstr_printf(&name, "%savg_ns", prefix);
+	calldata_set_int(cd, name.array, (long long)avg);
+	dstr_printf(&name, "%smax_ns", prefix);
+	calldata_set_int(cd, name.array, (long long)cost->max_ns);
+	dstr_free(&name);
+}
+
+void motion_stats_to_calldata(const struct motion_stats *stats,
+	calldata_t *cd)
+{
+	calldata_set_int(cd, "triggers", (long long)stats->triggers);
+	calldata_set_float(cd, "active_time", stats->active_time);
+	calldata_set_int(cd, "setter_calls", (long long)stats->setter_calls);
+	calldata_set_int(cd, "setter_avoided",
+		(long long)stats->setter_avoided);
+	motion_cost_to_calldata(&stats->cost, cd, "");
+}
+
+void motion_stats_log(obs_source_t *source, const struct motion_stats *stats)
+{
+	const struct motion_cost *cost = &stats->cost;
+
+	blog(LOG_INFO, "[%s] %llu triggers, %.2f s active, %llu setter calls "
+		"(%llu avoided), %llu samples, avg %.3f ms, max %.3f ms",
+		obs_source_get_name(source),
+		(unsigned long long)stats->triggers, stats->active_time,
+		(unsigned long long)stats->setter_calls,
+		(unsigned long long)stats->setter_avoided,
+		(unsigned long long)cost->samples,
+		cost->samples ? cost->total_ns / cost->samples / 1000000.0 : 0.0,
+		cost->max_ns / 1000000.0);
+}
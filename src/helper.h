@@ -22,9 +22,24 @@
 
 #include <obs-module.h>
 
+struct motion_cost {
+	uint64_t            samples;
+	uint64_t            total_ns;
+	uint64_t            max_ns;
+};
+
+/* Per source counters, returned by the get_stats proc of every source. */
+
+struct motion_stats {
+	uint64_t            triggers;
+	double              active_time;
+	uint64_t            setter_calls;
+	uint64_t            setter_avoided;
+	struct motion_cost  cost;
+};
+
 obs_sceneitem_t* get_item(obs_source_t *context,const char *name);
 obs_sceneitem_t* get_item_by_id(obs_source_t *context,int64_t id);
-int64_t get_item_id(obs_source_t *context, const char *name);
 
 bool cal_size(obs_sceneitem_t* item, float sx, float sy, int *width,
 	int *height);
@@ -38,6 +53,10 @@ void set_item_scale(obs_sceneitem_t *item, int width, int height);
 
 bool is_program_scene(obs_source_t *scene);
 
+bool is_private_scene(obs_source_t *scene);
+
+bool is_output_scene(obs_source_t *scene);
+
 obs_hotkey_id register_hotkey(obs_source_t *context, obs_source_t *scene,
 	const char *name, const char *text, obs_hotkey_func func, void *data);
 
@@ -57,4 +76,43 @@ void vec_bezier(struct vec2 a, struct vec2 b, struct vec2 c,
 	struct vec2 *result, float t);
 
 void crop_linear(struct obs_sceneitem_crop a, struct obs_sceneitem_crop b,
-	struct obs_sceneitem_crop* result, float t);
\ No newline at end of file
+	struct obs_sceneitem_crop* result, float t);
+
+static inline bool vec2_changed(const struct vec2 *a, const struct vec2 *b,
+	float epsilon)
+{
+	return fabsf(a->x - b->x) > epsilon || fabsf(a->y - b->y) > epsilon;
+}
+
+/*
+ * Scale is compared by how many pixels it moves the item's edge, so one
+ * epsilon covers position, scale and bounds.
+ */
+
+static inline bool scale_changed(const struct vec2 *a, const struct vec2 *b,
+	const struct vec2 *base_size, float epsilon)
+{
+	return fabsf(a->x - b->x) * base_size->x > epsilon ||
+		fabsf(a->y - b->y) * base_size->y > epsilon;
+}
+
+/*
+ * Rotation is in degrees, so it is compared by how far it swings the
+ * farthest corner, which is at most the diagonal from the pivot.
+ */
+
+static inline bool rotation_changed(float a, float b,
+	const struct vec2 *size, float epsilon)
+{
+	return RAD(fabsf(a - b)) * hypotf(size->x, size->y) > epsilon;
+}
+
+void motion_cost_add(struct motion_cost *cost, uint64_t ns);
+
+void motion_cost_to_calldata(const struct motion_cost *cost, calldata_t *cd,
+	const char *prefix);
+
+void motion_stats_to_calldata(const struct motion_stats *stats,
+	calldata_t *cd);
+
+void motion_stats_log(obs_source_t *source, const struct motion_stats *stats);
\ No newline at end of file
@@ -0,0 +1,196 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-bake.h"
+#include <math.h>
+#include <util/threading.h>
+
+struct motion_bake {
+	uint8_t             *key;
+	size_t              key_size;
+	uint32_t            hash;
+	DARRAY(struct vec4) samples;
+	long                refs;
+};
+
+static struct {
+	DARRAY(struct motion_bake *) tables;
+	pthread_mutex_t     mutex;
+	uint64_t            hits;
+	uint64_t            misses;
+} cache;
+
+static uint32_t hash_key(const struct bake_key *key)
+{
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < key->data.num; i++) {
+		hash ^= key->data.array[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static inline bool same_key(const struct motion_bake *bake,
+	const struct bake_key *key, uint32_t hash)
+{
+	return bake->hash == hash && bake->key_size == key->data.num &&
+		memcmp(bake->key, key->data.array, key->data.num) == 0;
+}
+
+size_t bake_sample_count(float duration, uint32_t *fps_num,
+	uint32_t *fps_den)
+{
+	struct obs_video_info ovi;
+	double frames;
+
+	if (duration <= 0.0f || !obs_get_video_info(&ovi) || !ovi.fps_den)
+		return 0;
+
+	frames = ceil((double)duration * ovi.fps_num / ovi.fps_den);
+	if (frames + 1.0 > BAKE_MAX_SAMPLES)
+		return 0;
+
+	*fps_num = ovi.fps_num;
+	*fps_den = ovi.fps_den;
+	return (size_t)frames + 1;
+}
+
+bool bake_matches(const struct motion_bake *bake, const struct bake_key *key)
+{
+	return bake && same_key(bake, key, hash_key(key));
+}
+
+static struct motion_bake *create_bake(const struct bake_key *key,
+	uint32_t hash, size_t count, bake_fill_t fill, void *param)
+{
+	struct motion_bake *bake = bzalloc(sizeof(*bake));
+	size_t i;
+
+	bake->key = bmemdup(key->data.array, key->data.num);
+	bake->key_size = key->data.num;
+	bake->hash = hash;
+	bake->refs = 1;
+
+	da_resize(bake->samples, count);
+	for (i = 0; i < count; i++)
+		fill(param, (float)i / (float)(count - 1), &bake->samples.array[i]);
+
+	return bake;
+}
+
+struct motion_bake *bake_acquire(const struct bake_key *key, size_t count,
+	bake_fill_t fill, void *param)
+{
+	uint32_t hash = hash_key(key);
+	struct motion_bake *bake = NULL;
+	size_t i;
+
+	if (count < 2)
+		return NULL;
+
+	pthread_mutex_lock(&cache.mutex);
+
+	for (i = 0; i < cache.tables.num; i++) {
+		if (same_key(cache.tables.array[i], key, hash)) {
+			bake = cache.tables.array[i];
+			bake->refs++;
+			cache.hits++;
+			break;
+		}
+	}
+
+	if (!bake) {
+		bake = create_bake(key, hash, count, fill, param);
+		da_push_back(cache.tables, &bake);
+		cache.misses++;
+	}
+
+	pthread_mutex_unlock(&cache.mutex);
+	return bake;
+}
+
+static void free_bake(struct motion_bake *bake)
+{
+	da_free(bake->samples);
+	bfree(bake->key);
+	bfree(bake);
+}
+
+void bake_release(struct motion_bake *bake)
+{
+	if (!bake)
+		return;
+
+	pthread_mutex_lock(&cache.mutex);
+	if (--bake->refs == 0)
+		da_erase_item(cache.tables, &bake);
+	else
+		bake = NULL;
+	pthread_mutex_unlock(&cache.mutex);
+
+	if (bake)
+		free_bake(bake);
+}
+
+void bake_sample(const struct motion_bake *bake, float coeff,
+	struct vec4 *result)
+{
+	const struct vec4 *samples = bake->samples.array;
+	size_t last = bake->samples.num - 1;
+	float pos = coeff * (float)last;
+	struct vec4 diff;
+	size_t i;
+
+	if (pos <= 0.0f) {
+		vec4_copy(result, &samples[0]);
+		return;
+	} else if (pos >= (float)last) {
+		vec4_copy(result, &samples[last]);
+		return;
+	}
+
+	i = (size_t)pos;
+	vec4_sub(&diff, &samples[i + 1], &samples[i]);
+	vec4_mulf(&diff, &diff, pos - (float)i);
+	vec4_add(result, &samples[i], &diff);
+}
+
+bool bake_cache_init(void)
+{
+	return pthread_mutex_init(&cache.mutex, NULL) == 0;
+}
+
+void bake_cache_free(void)
+{
+	size_t i;
+
+	if (cache.hits || cache.misses)
+		blog(LOG_DEBUG, "motion-filter: baked tables %llu shared, "
+			"%llu built", (unsigned long long)cache.hits,
+			(unsigned long long)cache.misses);
+
+	for (i = 0; i < cache.tables.num; i++)
+		free_bake(cache.tables.array[i]);
+
+	da_free(cache.tables);
+	pthread_mutex_destroy(&cache.mutex);
+}
@@ -0,0 +1,70 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <util/darray.h>
+#include <graphics/vec4.h>
+
+/*
+ * A motion sampled once per video frame. Tables are shared between
+ * filters whose parameters produce the same key and freed with the last
+ * reference. The key is the raw bytes of everything the samples depend
+ * on, the frame rate included, so changing any of it bakes a new table.
+ */
+
+#define BAKE_MAX_SAMPLES    65536
+
+struct bake_key {
+	DARRAY(uint8_t)     data;
+};
+
+struct motion_bake;
+
+typedef void (*bake_fill_t)(void *param, float coeff, struct vec4 *sample);
+
+static inline void bake_key_add(struct bake_key *key, const void *data,
+	size_t size)
+{
+	da_push_back_array(key->data, (const uint8_t *)data, size);
+}
+
+static inline void bake_key_free(struct bake_key *key)
+{
+	da_free(key->data);
+}
+
+/* Samples covering duration seconds at the video frame rate, 0 if none. */
+size_t bake_sample_count(float duration, uint32_t *fps_num,
+	uint32_t *fps_den);
+
+bool bake_matches(const struct motion_bake *bake, const struct bake_key *key);
+
+struct motion_bake *bake_acquire(const struct bake_key *key, size_t count,
+	bake_fill_t fill, void *param);
+void bake_release(struct motion_bake *bake);
+
+/* coeff is the linear time fraction, samples are lerped in between */
+void bake_sample(const struct motion_bake *bake, float coeff,
+	struct vec4 *result);
+
+bool bake_cache_init(void);
+void bake_cache_free(void);
@@ -0,0 +1,682 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-expr.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define EXPR_MAX_ARGS       3
+#define EXPR_MAX_CONSTS     256
+#define EXPR_MAX_DEPTH      64
+
+enum expr_code {
+	OP_CONST,
+	OP_VAR,
+	OP_ADD,
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_MOD,
+	OP_POW,
+	OP_NEG,
+	OP_CALL,
+	OP_STORE
+};
+
+enum expr_function {
+	FN_SIN,
+	FN_COS,
+	FN_TAN,
+	FN_ABS,
+	FN_SQRT,
+	FN_FLOOR,
+	FN_NOISE,
+	FN_POW,
+	FN_MIN,
+	FN_MAX,
+	FN_LERP,
+	FN_CLAMP
+};
+
+static const struct {
+	const char          *name;
+	int                 args;
+} functions[] = {
+	[FN_SIN]   = {"sin", 1},
+	[FN_COS]   = {"cos", 1},
+	[FN_TAN]   = {"tan", 1},
+	[FN_ABS]   = {"abs", 1},
+	[FN_SQRT]  = {"sqrt", 1},
+	[FN_FLOOR] = {"floor", 1},
+	[FN_NOISE] = {"noise", 1},
+	[FN_POW]   = {"pow", 2},
+	[FN_MIN]   = {"min", 2},
+	[FN_MAX]   = {"max", 2},
+	[FN_LERP]  = {"lerp", 3},
+	[FN_CLAMP] = {"clamp", 3},
+};
+
+static const char *variables[EXPR_VAR_COUNT] = {
+	[EXPR_T]        = "t",
+	[EXPR_TIME]     = "time",
+	[EXPR_DURATION] = "duration",
+	[EXPR_START_X]  = "start_x",
+	[EXPR_START_Y]  = "start_y",
+	[EXPR_START_W]  = "start_w",
+	[EXPR_START_H]  = "start_h",
+	[EXPR_DST_X]    = "dst_x",
+	[EXPR_DST_Y]    = "dst_y",
+	[EXPR_DST_W]    = "dst_w",
+	[EXPR_DST_H]    = "dst_h",
+	[EXPR_PATH_X]   = "path_x",
+	[EXPR_PATH_Y]   = "path_y",
+	[EXPR_PATH_W]   = "path_w",
+	[EXPR_PATH_H]   = "path_h",
+};
+
+static const char *outputs[EXPR_OUT_COUNT] = {
+	[EXPR_OUT_X] = "x",
+	[EXPR_OUT_Y] = "y",
+	[EXPR_OUT_W] = "w",
+	[EXPR_OUT_H] = "h",
+};
+
+/* Evaluation */
+
+static inline float noise(float x)
+{
+	float cell = floorf(x);
+	float f = x - cell;
+	uint32_t a = (uint32_t)(int32_t)cell * 2654435761u;
+	uint32_t b = a + 2654435761u;
+	float va, vb;
+
+	a ^= a >> 15;
+	b ^= b >> 15;
+	va = (float)(a & 0xffff) / 32767.5f - 1.0f;
+	vb = (float)(b & 0xffff) / 32767.5f - 1.0f;
+
+	f = f * f * (3.0f - 2.0f * f);
+	return va + (vb - va) * f;
+}
+
+static inline float call_function(int function, const float *a)
+{
+	switch (function) {
+	case FN_SIN:   return sinf(a[0]);
+	case FN_COS:   return cosf(a[0]);
+	case FN_TAN:   return tanf(a[0]);
+	case FN_ABS:   return fabsf(a[0]);
+	case FN_SQRT:  return sqrtf(a[0]);
+	case FN_FLOOR: return floorf(a[0]);
+	case FN_NOISE: return noise(a[0]);
+	case FN_POW:   return powf(a[0], a[1]);
+	case FN_MIN:   return a[0] < a[1] ? a[0] : a[1];
+	case FN_MAX:   return a[0] > a[1] ? a[0] : a[1];
+	case FN_LERP:  return a[0] + (a[1] - a[0]) * a[2];
+	case FN_CLAMP: return a[0] < a[1] ? a[1] : (a[0] > a[2] ? a[2] : a[0]);
+	}
+	return 0.0f;
+}
+
+static inline float binary(int code, float a, float b)
+{
+	switch (code) {
+	case OP_ADD: return a + b;
+	case OP_SUB: return a - b;
+	case OP_MUL: return a * b;
+	case OP_DIV: return a / b;
+	case OP_MOD: return fmodf(a, b);
+	case OP_POW: return powf(a, b);
+	}
+	return 0.0f;
+}
+
+void motion_expr_eval(const struct motion_expr *expr, const float *vars,
+	float *out)
+{
+	float stack[EXPR_MAX_STACK];
+	const struct expr_op *op = expr->code.array;
+	const struct expr_op *end = op + expr->code.num;
+	int top = -1;
+
+	for (; op < end; op++) {
+		switch (op->code) {
+		case OP_CONST:
+			stack[++top] = expr->consts.array[op->arg];
+			break;
+		case OP_VAR:
+			stack[++top] = vars[op->arg];
+			break;
+		case OP_NEG:
+			stack[top] = -stack[top];
+			break;
+		case OP_CALL:
+			top -= functions[op->arg].args - 1;
+			stack[top] = call_function(op->arg, &stack[top]);
+			break;
+		case OP_STORE:
+			// Keep the path when the expression blows up
+			if (isfinite(stack[top]))
+				out[op->arg] = stack[top];
+			top--;
+			break;
+		default:
+			top--;
+			stack[top] = binary(op->code, stack[top], stack[top + 1]);
+		}
+	}
+}
+
+/* Parsing */
+
+enum node_type {
+	NODE_CONST,
+	NODE_VAR,
+	NODE_NEG,
+	NODE_BINARY,
+	NODE_CALL
+};
+
+struct expr_node {
+	enum node_type      type;
+	int                 op;
+	float               value;
+	int                 count;
+	struct expr_node    *args[EXPR_MAX_ARGS];
+};
+
+struct expr_parser {
+	const char          *text;
+	const char          *pos;
+	char                *error;
+	size_t              error_size;
+	bool                failed;
+	int                 depth;
+};
+
+static void fail(struct expr_parser *parser, const char *format, ...)
+{
+	char message[128];
+	va_list args;
+
+	if (parser->failed)
+		return;
+
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+
+	snprintf(parser->error, parser->error_size, "%s at offset %d",
+		message, (int)(parser->pos - parser->text));
+	parser->failed = true;
+}
+
+static void free_node(struct expr_node *node)
+{
+	int i;
+
+	if (!node)
+		return;
+	for (i = 0; i < node->count; i++)
+		free_node(node->args[i]);
+	bfree(node);
+}
+
+static struct expr_node *new_node(enum node_type type, int op)
+{
+	struct expr_node *node = bzalloc(sizeof(struct expr_node));
+	node->type = type;
+	node->op = op;
+	return node;
+}
+
+static inline void skip_space(struct expr_parser *parser)
+{
+	while (*parser->pos == ' ' || *parser->pos == '\t' ||
+		*parser->pos == '\r')
+		parser->pos++;
+}
+
+static inline bool accept(struct expr_parser *parser, char c)
+{
+	skip_space(parser);
+	if (*parser->pos != c)
+		return false;
+	parser->pos++;
+	return true;
+}
+
+static size_t read_name(struct expr_parser *parser, char *name, size_t size)
+{
+	size_t len = 0;
+
+	skip_space(parser);
+	while (isalnum((unsigned char)*parser->pos) || *parser->pos == '_') {
+		if (len + 1 < size)
+			name[len] = *parser->pos;
+		len++;
+		parser->pos++;
+	}
+	name[len < size ? len : size - 1] = 0;
+	return len;
+}
+
+static int find_name(const char **names, int count, const char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (strcmp(names[i], name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+static int find_function(const char *name)
+{
+	int i;
+
+	for (i = 0; i < (int)(sizeof(functions) / sizeof(functions[0])); i++) {
+		if (strcmp(functions[i].name, name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+static inline void add_digit(double *mantissa, int *exponent, char c,
+	bool fraction)
+{
+	// Digits past what a double holds only move the decimal point
+	if (*mantissa < 1e17) {
+		*mantissa = *mantissa * 10.0 + (c - '0');
+		if (fraction)
+			(*exponent)--;
+	} else if (!fraction) {
+		(*exponent)++;
+	}
+}
+
+/*
+ * Numbers always use '.' as the decimal point. strtof follows the locale,
+ * which OBS sets from the UI language on some platforms.
+ */
+
+static bool read_number(struct expr_parser *parser, float *value)
+{
+	const char *pos = parser->pos;
+	double mantissa = 0.0;
+	int exponent = 0, digits = 0;
+
+	for (; isdigit((unsigned char)*pos); pos++, digits++)
+		add_digit(&mantissa, &exponent, *pos, false);
+	if (*pos == '.') {
+		for (pos++; isdigit((unsigned char)*pos); pos++, digits++)
+			add_digit(&mantissa, &exponent, *pos, true);
+	}
+	if (!digits)
+		return false;
+
+	// Without digits after it the 'e' is not part of the number
+	if (*pos == 'e' || *pos == 'E') {
+		const char *exp = pos + 1;
+		bool negative = *exp == '-';
+		int power = 0;
+
+		if (*exp == '-' || *exp == '+')
+			exp++;
+		if (isdigit((unsigned char)*exp)) {
+			for (; isdigit((unsigned char)*exp); exp++) {
+				if (power < 10000)
+					power = power * 10 + (*exp - '0');
+			}
+			exponent += negative ? -power : power;
+			pos = exp;
+		}
+	}
+
+	*value = (float)(exponent < 0 ? mantissa / pow(10.0, -exponent) :
+		mantissa * pow(10.0, exponent));
+	parser->pos = pos;
+	return true;
+}
+
+static struct expr_node *parse_sum(struct expr_parser *parser);
+static struct expr_node *parse_unary(struct expr_parser *parser);
+
+static struct expr_node *parse_call(struct expr_parser *parser,
+	const char *name)
+{
+	int function = find_function(name);
+	struct expr_node *node;
+
+	if (function < 0) {
+		fail(parser, "unknown function '%s'", name);
+		return NULL;
+	}
+
+	node = new_node(NODE_CALL, function);
+	do {
+		if (node->count == functions[function].args) {
+			fail(parser, "too many arguments to '%s'", name);
+			break;
+		}
+		node->args[node->count++] = parse_sum(parser);
+	} while (!parser->failed && accept(parser, ','));
+
+	if (!parser->failed && node->count != functions[function].args)
+		fail(parser, "'%s' takes %d arguments", name,
+			functions[function].args);
+	if (!parser->failed && !accept(parser, ')'))
+		fail(parser, "expected ')'");
+	return node;
+}
+
+static struct expr_node *parse_primary(struct expr_parser *parser)
+{
+	struct expr_node *node;
+	char name[32];
+	int var;
+
+	skip_space(parser);
+
+	if (accept(parser, '(')) {
+		node = parse_sum(parser);
+		if (!parser->failed && !accept(parser, ')'))
+			fail(parser, "expected ')'");
+		return node;
+	}
+
+	if (isdigit((unsigned char)*parser->pos) || *parser->pos == '.') {
+		node = new_node(NODE_CONST, 0);
+		if (!read_number(parser, &node->value))
+			fail(parser, "bad number");
+		return node;
+	}
+
+	if (!read_name(parser, name, sizeof(name))) {
+		fail(parser, "expected a value");
+		return NULL;
+	}
+
+	if (accept(parser, '('))
+		return parse_call(parser, name);
+
+	if (strcmp(name, "pi") == 0) {
+		node = new_node(NODE_CONST, 0);
+		node->value = (float)M_PI;
+		return node;
+	}
+
+	var = find_name(variables, EXPR_VAR_COUNT, name);
+	if (var < 0) {
+		fail(parser, "unknown variable '%s'", name);
+		return NULL;
+	}
+	return new_node(NODE_VAR, var);
+}
+
+static struct expr_node *binary_node(int op, struct expr_node *a,
+	struct expr_node *b)
+{
+	struct expr_node *node = new_node(NODE_BINARY, op);
+	node->args[0] = a;
+	node->args[1] = b;
+	node->count = 2;
+	return node;
+}
+
+static struct expr_node *parse_power(struct expr_parser *parser)
+{
+	struct expr_node *node = parse_primary(parser);
+
+	// Right associative, -2^2 is -(2^2) and 2^-1 is allowed
+	if (!parser->failed && accept(parser, '^'))
+		node = binary_node(OP_POW, node, parse_unary(parser));
+	return node;
+}
+
+static struct expr_node *parse_unary(struct expr_parser *parser)
+{
+	struct expr_node *node;
+
+	if (++parser->depth > EXPR_MAX_DEPTH) {
+		fail(parser, "expression too deep");
+		return NULL;
+	}
+
+	if (accept(parser, '-')) {
+		node = new_node(NODE_NEG, 0);
+		node->args[0] = parse_unary(parser);
+		node->count = 1;
+	} else {
+		accept(parser, '+');
+		node = parse_power(parser);
+	}
+
+	parser->depth--;
+	return node;
+}
+
+static struct expr_node *parse_product(struct expr_parser *parser)
+{
+	struct expr_node *node = parse_unary(parser);
+
+	while (!parser->failed) {
+		if (accept(parser, '*'))
+			node = binary_node(OP_MUL, node, parse_unary(parser));
+		else if (accept(parser, '/'))
+			node = binary_node(OP_DIV, node, parse_unary(parser));
+		else if (accept(parser, '%'))
+			node = binary_node(OP_MOD, node, parse_unary(parser));
+		else
+			break;
+	}
+	return node;
+}
+
+static struct expr_node *parse_sum(struct expr_parser *parser)
+{
+	struct expr_node *node = parse_product(parser);
+
+	while (!parser->failed) {
+		if (accept(parser, '+'))
+			node = binary_node(OP_ADD, node, parse_product(parser));
+		else if (accept(parser, '-'))
+			node = binary_node(OP_SUB, node, parse_product(parser));
+		else
+			break;
+	}
+	return node;
+}
+
+/* Constant folding and code generation */
+
+static void fold(struct expr_node *node)
+{
+	float args[EXPR_MAX_ARGS];
+	bool constant = true;
+	int i;
+
+	for (i = 0; i < node->count; i++) {
+		fold(node->args[i]);
+		constant = constant && node->args[i]->type == NODE_CONST;
+		args[i] = node->args[i]->value;
+	}
+
+	if (!constant)
+		return;
+
+	if (node->type == NODE_NEG)
+		node->value = -args[0];
+	else if (node->type == NODE_BINARY)
+		node->value = binary(node->op, args[0], args[1]);
+	else if (node->type == NODE_CALL)
+		node->value = call_function(node->op, args);
+	else
+		return;
+
+	for (i = 0; i < node->count; i++)
+		free_node(node->args[i]);
+	node->count = 0;
+	node->type = NODE_CONST;
+}
+
+static void emit(struct motion_expr *expr, uint8_t code, uint8_t arg)
+{
+	struct expr_op op = {code, arg};
+	da_push_back(expr->code, &op);
+}
+
+static size_t add_const(struct motion_expr *expr, float value)
+{
+	size_t i;
+
+	for (i = 0; i < expr->consts.num; i++) {
+		if (memcmp(&expr->consts.array[i], &value, sizeof(float)) == 0)
+			return i;
+	}
+	da_push_back(expr->consts, &value);
+	return i;
+}
+
+/* Returns the stack depth the node needs, or -1 when it does not fit. */
+static int generate(struct motion_expr *expr, const struct expr_node *node,
+	int depth)
+{
+	int i, max = depth + 1, need;
+	size_t index;
+
+	for (i = 0; i < node->count; i++) {
+		need = generate(expr, node->args[i], depth + i);
+		if (need < 0)
+			return -1;
+		if (need > max)
+			max = need;
+	}
+
+	switch (node->type) {
+	case NODE_CONST:
+		index = add_const(expr, node->value);
+		if (index >= EXPR_MAX_CONSTS)
+			return -1;
+		emit(expr, OP_CONST, (uint8_t)index);
+		break;
+	case NODE_VAR:
+		emit(expr, OP_VAR, (uint8_t)node->op);
+		break;
+	case NODE_NEG:
+		emit(expr, OP_NEG, 0);
+		break;
+	case NODE_BINARY:
+		emit(expr, (uint8_t)node->op, 0);
+		break;
+	case NODE_CALL:
+		emit(expr, OP_CALL, (uint8_t)node->op);
+		break;
+	}
+
+	return max <= EXPR_MAX_STACK ? max : -1;
+}
+
+static bool parse_statement(struct expr_parser *parser,
+	struct motion_expr *expr)
+{
+	struct expr_node *node;
+	char name[32];
+	int output;
+
+	if (!read_name(parser, name, sizeof(name))) {
+		fail(parser, "expected x, y, w or h");
+		return false;
+	}
+
+	output = find_name(outputs, EXPR_OUT_COUNT, name);
+	if (output < 0) {
+		fail(parser, "unknown output '%s'", name);
+		return false;
+	}
+	if (!accept(parser, '=')) {
+		fail(parser, "expected '='");
+		return false;
+	}
+
+	node = parse_sum(parser);
+	if (!parser->failed) {
+		fold(node);
+		if (generate(expr, node, 0) < 0)
+			fail(parser, "expression too large");
+	}
+	free_node(node);
+
+	emit(expr, OP_STORE, (uint8_t)output);
+	expr->outputs |= 1 << output;
+	return !parser->failed;
+}
+
+static inline bool at_separator(struct expr_parser *parser)
+{
+	bool found = false;
+
+	for (;;) {
+		skip_space(parser);
+		if (*parser->pos != ';' && *parser->pos != '\n')
+			return found;
+		parser->pos++;
+		found = true;
+	}
+}
+
+struct motion_expr *motion_expr_compile(const char *text, char *error,
+	size_t error_size)
+{
+	struct expr_parser parser = {text, text, error, error_size};
+	struct motion_expr *expr = bzalloc(sizeof(struct motion_expr));
+
+	if (error_size)
+		*error = 0;
+
+	at_separator(&parser);
+	while (*parser.pos) {
+		if (!parse_statement(&parser, expr))
+			break;
+		if (!at_separator(&parser) && *parser.pos) {
+			fail(&parser, "expected ';'");
+			break;
+		}
+	}
+
+	if (parser.failed || !expr->outputs) {
+		motion_expr_destroy(expr);
+		return NULL;
+	}
+	return expr;
+}
+
+void motion_expr_destroy(struct motion_expr *expr)
+{
+	if (!expr)
+		return;
+	da_free(expr->code);
+	da_free(expr->consts);
+	bfree(expr);
+}
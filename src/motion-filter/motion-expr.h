@@ -0,0 +1,96 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <util/darray.h>
+
+/*
+ * Motion expressions. A program is a list of assignments to x, y, w and h
+ * separated by ';' or new lines:
+ *
+ *   x = path_x + 40 * sin(time * 6.28); w = dst_w * (1 + 0.1 * noise(t * 8))
+ *
+ * Numbers, + - * / % ^, parentheses, pi and the functions sin, cos, tan,
+ * abs, sqrt, floor, pow, min, max, lerp, clamp and noise are understood.
+ * Outputs that are not assigned keep the value of the regular path.
+ *
+ * Programs are parsed and constant folded once, then run as postfix
+ * bytecode on a fixed size stack, so evaluation never allocates.
+ */
+
+#define EXPR_MAX_STACK      32
+
+enum expr_var {
+	EXPR_T,
+	EXPR_TIME,
+	EXPR_DURATION,
+	EXPR_START_X,
+	EXPR_START_Y,
+	EXPR_START_W,
+	EXPR_START_H,
+	EXPR_DST_X,
+	EXPR_DST_Y,
+	EXPR_DST_W,
+	EXPR_DST_H,
+	EXPR_PATH_X,
+	EXPR_PATH_Y,
+	EXPR_PATH_W,
+	EXPR_PATH_H,
+	EXPR_VAR_COUNT
+};
+
+enum expr_output {
+	EXPR_OUT_X,
+	EXPR_OUT_Y,
+	EXPR_OUT_W,
+	EXPR_OUT_H,
+	EXPR_OUT_COUNT
+};
+
+struct expr_op {
+	uint8_t             code;
+	uint8_t             arg;
+};
+
+struct motion_expr {
+	DARRAY(struct expr_op) code;
+	DARRAY(float)       consts;
+	uint8_t             outputs;
+};
+
+/*
+ * Returns NULL on a syntax error and describes it in error. An empty
+ * program also returns NULL but leaves error empty.
+ */
+struct motion_expr *motion_expr_compile(const char *text, char *error,
+	size_t error_size);
+void motion_expr_destroy(struct motion_expr *expr);
+
+static inline bool motion_expr_sets(const struct motion_expr *expr,
+	enum expr_output output)
+{
+	return (expr->outputs & (1 << output)) != 0;
+}
+
+/* out holds the path values on entry, assigned outputs are replaced. */
+void motion_expr_eval(const struct motion_expr *expr, const float *vars,
+	float *out);
@@ -21,16 +21,28 @@
 #include <obs-module.h>
 #include <obs-hotkey.h>
 #include <obs-scene.h>
-#include <obs-frontend-api.h>
 #include <util/dstr.h>
+#include <util/threading.h>
+#include <util/platform.h>
 #include "../helper.h"
+#include "../curve.h"
+#include "../trace.h"
+#include "motion-scheduler.h"
+#include "scene-dispatcher.h"
+#include "motion-timeline.h"
+#include "motion-spring.h"
+#include "motion-bake.h"
+#include "motion-expr.h"
+#include "motion-preset.h"
+#include "motion-loader.h"
 
 // Define property keys
 
 enum {
 	PATH_LINEAR = 0,
 	PATH_QUADRATIC = 1,
-	PATH_CUBIC = 2
+	PATH_CUBIC = 2,
+	PATH_KEYFRAMES = 3
 };
 
 enum {
@@ -40,6 +52,33 @@ enum {
 	BEHAVIOR_SCENE_SWITCH =3
 };
 
+enum {
+	TRIGGER_IGNORE = 0,
+	TRIGGER_QUEUE = 1,
+	TRIGGER_COALESCE = 2,
+	TRIGGER_RETARGET = 3
+};
+
+enum {
+	TIMING_DURATION = 0,
+	TIMING_SPRING = 1
+};
+
+#define TRIGGER_QUEUE_MAX   16
+#define RETARGET_STEP       (1.0f / 120.0f)
+
+enum {
+	COMMAND_FORWARD,
+	COMMAND_BACKWARD,
+	COMMAND_ACTIVATE,
+	COMMAND_DEACTIVATE,
+	COMMAND_RECOVER,
+	COMMAND_RESOLVE,
+	COMMAND_EXPRESSION,
+	COMMAND_RELEASE,
+	COMMAND_PRESET
+};
+
 #define VARIATION_POSITION  (1<<0)
 #define VARIATION_SIZE      (1<<1)
 
@@ -72,6 +111,21 @@ enum {
 #define S_MOTION_BEHAVIOR   "motion_behavior"
 #define S_VARIATION_TYPE    "variation_type"
 #define S_SCENE_NAME        "scene_name"
+#define S_CONSTANT_SPEED    "constant_speed"
+#define S_KEYFRAMES         "keyframes"
+#define S_FOLLOWERS         "follow_sources"
+#define S_TRIGGER_POLICY    "trigger_policy"
+#define S_TIMING            "timing"
+#define S_STIFFNESS         "stiffness"
+#define S_DAMPING           "damping"
+#define S_BAKED             "baked"
+#define S_EPSILON           "commit_epsilon"
+#define S_PIXEL_SNAP        "pixel_snap"
+#define S_EXPRESSION        "expression"
+#define S_PRESET            "preset_id"
+#define S_PRESET_NAME       "preset_name"
+#define S_PRESET_EXPORT     "preset_export"
+#define S_PRESET_IMPORT     "preset_import"
 
 // Define property localisation tags
 #define T_(v)               obs_module_text(v)
@@ -79,6 +133,7 @@ enum {
 #define T_PATH_LINEAR       T_("PathType.Linear")
 #define T_PATH_QUADRATIC    T_("PathType.Quadratic")
 #define T_PATH_CUBIC        T_("PathType.Cubic")
+#define T_PATH_KEYFRAMES    T_("PathType.Keyframes")
 #define T_START_SETTING     T_("Start.Setting")
 #define T_START_X           T_("Start.X")
 #define T_START_Y           T_("Start.Y")
@@ -107,30 +162,102 @@ enum {
 #define T_HOTKEY_ONE_WAY    T_("Behavior.OneWay")
 #define T_HOTKEY_ROUND_TRIP T_("Behavior.RoundTrip")
 #define T_SCENE_SWITCH      T_("Behavior.SceneSwitch")
+#define T_CONSTANT_SPEED    T_("ConstantSpeed")
+#define T_KEYFRAMES         T_("Keyframes")
+#define T_FOLLOWERS         T_("FollowSources")
+#define T_TRIGGER_POLICY    T_("TriggerPolicy")
+#define T_TRIGGER_IGNORE    T_("TriggerPolicy.Ignore")
+#define T_TRIGGER_QUEUE     T_("TriggerPolicy.Queue")
+#define T_TRIGGER_COALESCE  T_("TriggerPolicy.Coalesce")
+#define T_TRIGGER_RETARGET  T_("TriggerPolicy.Retarget")
+#define T_TIMING            T_("Timing")
+#define T_TIMING_DURATION   T_("Timing.Duration")
+#define T_TIMING_SPRING     T_("Timing.Spring")
+#define T_STIFFNESS         T_("Stiffness")
+#define T_DAMPING           T_("Damping")
+#define T_BAKED             T_("Baked")
+#define T_EPSILON           T_("CommitEpsilon")
+#define T_PIXEL_SNAP        T_("PixelSnap")
+#define T_EXPRESSION        T_("Expression")
+#define T_PRESET            T_("Preset")
+#define T_PRESET_NONE       T_("Preset.None")
+#define T_PRESET_NAME       T_("Preset.Name")
+#define T_PRESET_EXPORT     T_("Preset.Export")
+#define T_PRESET_IMPORT     T_("Preset.Import")
 
 typedef struct variation_data variation_data_t;
 typedef struct motion_filter_data motion_filter_data_t;
 
+/* What was last handed to libobs for one item. */
+
+struct motion_output {
+	struct vec2         pos;
+	struct vec2         scale;
+	bool                valid;
+};
+
+struct motion_follower {
+	obs_sceneitem_t     *item;
+	struct vec2         offset;
+	struct vec2         scale_ratio;
+	struct motion_output output;
+};
+
+struct motion_keyframe {
+	float               time;
+	struct vec2         pos;
+	int                 width;
+	int                 height;
+	float               easing;
+};
+
 struct variation_data {
 	float               point_x[4];
 	float               point_y[4];
 	float               scale_x[2];
 	float               scale_y[2];
 	float               coeff[3];
+	float               coeff_poly[CURVE_MAX_ORDER + 1];
+	struct curve        curve;
+	struct curve_arc_table arc;
+	struct motion_timeline timeline;
+	struct motion_bake  *bake;
+	float               arc_point_x[4];
+	float               arc_point_y[4];
+	int                 arc_order;
+	bool                arc_valid;
+	struct vec4         from;
+	struct vec4         to;
+	struct vec2         base;
 	struct vec2         scale;
 	struct vec2         position;	
 	float               elapsed_time;
+	float               shown_time;
+	uint64_t            eval_ns;
 	bool                coeff_varaite;
+	bool                retargeted;
+	bool                done;
 };
 
 struct motion_filter_data {
 	obs_source_t        *context;
 	obs_scene_t         *scene;
+	obs_source_t        *dispatch_scene;
 	obs_sceneitem_t     *item;
+	obs_sceneitem_t     *cached_item;
+	DARRAY(obs_sceneitem_t *) cached_followers;
+	DARRAY(obs_source_t *) group_scenes;
+	obs_source_t        *signal_scene;
+	obs_weak_source_t   *signal_weak;
+	volatile bool       item_dirty;
 	obs_hotkey_id       hotkey_id_f;
 	obs_hotkey_id       hotkey_id_b;
 	variation_data_t    variation;
+	struct motion_output output;
+	struct motion_stats stats;
 	bool                initialize;
+	bool                loaded;
+	volatile bool       removed;
 	bool                restart_backward;
 	bool                motion_start;
 	bool                motion_end;
@@ -138,7 +265,13 @@ struct motion_filter_data {
 	bool                use_start_scale;
 	bool                change_position;
 	bool                change_size;
+	bool                constant_speed;
+	bool                baked;
+	bool                pixel_snap;
 	int                 motion_behavior;
+	int                 trigger_policy;
+	int                 timing;
+	int                 spring;
 	int                 path_type;
 	int                 org_width;
 	int                 org_height;
@@ -150,6 +283,20 @@ struct motion_filter_data {
 	struct vec2         dst_pos;
 	float               duration;
 	float               acceleration;
+	float               stiffness;
+	float               damping;
+	float               epsilon;
+	DARRAY(struct motion_keyframe) keyframes;
+	DARRAY(struct motion_follower) followers;
+	DARRAY(char *)      follower_names;
+	DARRAY(bool)        queued;
+	struct motion_expr  *expr;
+	struct motion_expr  *pending_expr;
+	bool                expr_pending;
+	pthread_mutex_t     expr_mutex;
+	char                *expr_text;
+	uint32_t            preset_id;
+	long                preset_generation;
 	char                *item_name;
 	int64_t             item_id;
 };
@@ -160,12 +307,116 @@ static inline bool is_reverse(motion_filter_data_t *filter)
 		filter->motion_behavior == BEHAVIOR_ROUND_TRIP;
 }
 
+/* Fixed per motion, the timing setting may change while it runs. */
+
+static inline bool use_spring(motion_filter_data_t *filter)
+{
+	return filter->spring >= 0;
+}
+
 static inline const char* get_scene_name(motion_filter_data_t *filter)
 {
 	obs_source_t* scene = obs_filter_get_parent(filter->context);
 	return obs_source_get_name(scene);
 }
 
+static inline int get_path_order(motion_filter_data_t *filter)
+{
+	if (!filter->change_position)
+		return 0;
+	else if (filter->path_type == PATH_QUADRATIC)
+		return 2;
+	else if (filter->path_type == PATH_CUBIC)
+		return 3;
+	else
+		return 1;
+}
+
+static void update_variation_curve(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+	int order = get_path_order(filter);
+	int scale_order = filter->change_size ? 1 : 0;
+
+	curve_init(&var->curve);
+	curve_set_channel(&var->curve, CURVE_POS_X, var->point_x, order);
+	curve_set_channel(&var->curve, CURVE_POS_Y, var->point_y, order);
+	curve_set_channel(&var->curve, CURVE_SCALE_X, var->scale_x, scale_order);
+	curve_set_channel(&var->curve, CURVE_SCALE_Y, var->scale_y, scale_order);
+
+	if (var->coeff_varaite)
+		bezier_to_poly(var->coeff, 2, var->coeff_poly);
+}
+
+static inline bool use_arc_length(motion_filter_data_t *filter)
+{
+	return filter->constant_speed && get_path_order(filter) >= 2;
+}
+
+/*
+ * The arc length table only depends on the position control points, so
+ * it is kept until the geometry changes instead of rebuilt every trigger.
+ */
+
+static void update_arc_table(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+	int order = get_path_order(filter);
+	size_t size = sizeof(float) * (order + 1);
+
+	if (!use_arc_length(filter))
+		return;
+
+	if (var->arc_valid && var->arc_order == order &&
+		memcmp(var->arc_point_x, var->point_x, size) == 0 &&
+		memcmp(var->arc_point_y, var->point_y, size) == 0)
+		return;
+
+	curve_build_arc_table(&var->curve, &var->arc);
+	memcpy(var->arc_point_x, var->point_x, size);
+	memcpy(var->arc_point_y, var->point_y, size);
+	var->arc_order = order;
+	var->arc_valid = true;
+}
+
+/*
+ * Keyframe segments start from the item's starting transform, channels
+ * left out by the variation type hold their starting value.
+ */
+
+static void update_timeline(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+	struct motion_keyframe *keys = filter->keyframes.array;
+	struct vec4 from, to;
+	float start = 0.0f;
+	size_t i;
+
+	vec4_set(&from, var->point_x[0], var->point_y[0], var->scale_x[0],
+		var->scale_y[0]);
+	timeline_reset(&var->timeline, &from);
+
+	for (i = 0; i < filter->keyframes.num; i++) {
+		vec4_copy(&to, &from);
+
+		if (filter->change_position) {
+			to.ptr[CURVE_POS_X] = keys[i].pos.x;
+			to.ptr[CURVE_POS_Y] = keys[i].pos.y;
+		}
+
+		if (filter->change_size) {
+			cal_scale(filter->item, &to.ptr[CURVE_SCALE_X],
+				&to.ptr[CURVE_SCALE_Y], keys[i].width,
+				keys[i].height);
+		}
+
+		timeline_add_segment(&var->timeline, start, keys[i].time, &from,
+			&to, keys[i].easing);
+		vec4_copy(&from, &to);
+		start = keys[i].time;
+	}
+}
+
 static void update_variation_data(motion_filter_data_t *filter)
 {
 	variation_data_t *var = &filter->variation;
@@ -202,8 +453,10 @@ static void update_variation_data(motion_filter_data_t *filter)
 		var->point_y[2] = filter->ctrl2_pos.y;
 	}
 		
-	var->point_x[filter->path_type + 1] = filter->dst_pos.x;
-	var->point_y[filter->path_type + 1] = filter->dst_pos.y;
+	if (filter->path_type <= PATH_CUBIC) {
+		var->point_x[filter->path_type + 1] = filter->dst_pos.x;
+		var->point_y[filter->path_type + 1] = filter->dst_pos.y;
+	}
 
 	if(filter->use_start_scale) {
 		cal_scale(filter->item, &var->scale_x[0],
@@ -213,7 +466,7 @@ static void update_variation_data(motion_filter_data_t *filter)
 	cal_scale(filter->item, &var->scale_x[1],
 		&var->scale_y[1], filter->dst_width, filter->dst_height);
 
-	if (filter->acceleration != 0) {
+	if (filter->acceleration != 0 && filter->timing == TIMING_DURATION) {
 		var->coeff_varaite = true;
 		var->coeff[0] = 0.0f;
 		var->coeff[1] = (-(filter->acceleration) + 1.0f) / 2;
@@ -221,7 +474,13 @@ static void update_variation_data(motion_filter_data_t *filter)
 	} else
 		var->coeff_varaite = false;
 
+	if (filter->path_type == PATH_KEYFRAMES)
+		update_timeline(filter);
+
+	update_variation_curve(filter);
+	update_arc_table(filter);
 	var->elapsed_time = 0.0f;
+	var->retargeted = false;
 	return ;
 }
 
@@ -239,6 +498,318 @@ static void reset_source_name(void *data, obs_sceneitem_t *item)
 	}
 }
 
+/*
+ * The target item is resolved once and kept until the parent scene, the
+ * group holding the item or a source name changes, so triggers do not
+ * scan the scene.
+ */
+
+static void item_cache_dirty(void *data, calldata_t *cd)
+{
+	motion_filter_data_t *filter = data;
+	os_atomic_set_bool(&filter->item_dirty, true);
+	UNUSED_PARAMETER(cd);
+}
+
+/* A removed item is not kept alive until the next trigger. */
+
+static void item_cache_removed(void *data, calldata_t *cd)
+{
+	motion_filter_data_t *filter = data;
+
+	item_cache_dirty(data, cd);
+	motion_scheduler_post(filter->context, filter, &filter->removed,
+		COMMAND_RELEASE);
+}
+
+static const struct {
+	const char          *signal;
+	signal_callback_t   callback;
+} item_signals[] = {
+	{ "item_add",       item_cache_dirty },
+	{ "item_remove",    item_cache_removed },
+	{ "reorder",        item_cache_dirty },
+	{ NULL,             NULL }
+};
+
+static void item_cache_connect(motion_filter_data_t *filter,
+	obs_source_t *scene, bool connect)
+{
+	signal_handler_t *sh = obs_source_get_signal_handler(scene);
+	size_t i;
+
+	for (i = 0; item_signals[i].signal; i++) {
+		if (connect)
+			signal_handler_connect(sh, item_signals[i].signal,
+				item_signals[i].callback, filter);
+		else
+			signal_handler_disconnect(sh, item_signals[i].signal,
+				item_signals[i].callback, filter);
+	}
+}
+
+static void watch_item_scene(motion_filter_data_t *filter,
+	obs_sceneitem_t *item)
+{
+	obs_source_t *scene = obs_scene_get_source(obs_sceneitem_get_scene(item));
+
+	if (scene == filter->signal_scene ||
+		da_find(filter->group_scenes, &scene, 0) != DARRAY_INVALID)
+		return;
+
+	obs_source_addref(scene);
+	item_cache_connect(filter, scene, true);
+	da_push_back(filter->group_scenes, &scene);
+}
+
+static void release_item_cache(motion_filter_data_t *filter)
+{
+	size_t i;
+
+	for (i = 0; i < filter->group_scenes.num; i++) {
+		obs_source_t *scene = filter->group_scenes.array[i];
+		item_cache_connect(filter, scene, false);
+		obs_source_release(scene);
+	}
+
+	for (i = 0; i < filter->cached_followers.num; i++)
+		obs_sceneitem_release(filter->cached_followers.array[i]);
+
+	obs_sceneitem_release(filter->cached_item);
+	filter->cached_item = NULL;
+	da_resize(filter->group_scenes, 0);
+	da_resize(filter->cached_followers, 0);
+}
+
+static void cache_item(motion_filter_data_t *filter, obs_sceneitem_t *item)
+{
+	obs_sceneitem_addref(item);
+	watch_item_scene(filter, item);
+
+	if (!filter->cached_item) {
+		filter->cached_item = item;
+		filter->item_id = obs_sceneitem_get_id(item);
+	} else if (item != filter->cached_item &&
+		da_find(filter->cached_followers, &item, 0) == DARRAY_INVALID) {
+		da_push_back(filter->cached_followers, &item);
+	} else {
+		obs_sceneitem_release(item);
+	}
+}
+
+/*
+ * Resolves the target and its followers together. The cache is only
+ * trusted once the signals that invalidate it are connected.
+ */
+
+static obs_sceneitem_t *resolve_item(motion_filter_data_t *filter)
+{
+	obs_sceneitem_t *item;
+	size_t i;
+
+	if (filter->cached_item && filter->signal_scene &&
+		!os_atomic_load_bool(&filter->item_dirty))
+		return filter->cached_item;
+
+	os_atomic_set_bool(&filter->item_dirty, false);
+	release_item_cache(filter);
+
+	item = get_item(filter->context, filter->item_name);
+	if (!item) {
+		item = get_item_by_id(filter->context, filter->item_id);
+		reset_source_name(filter, item);
+	}
+
+	if (!item)
+		return NULL;
+
+	cache_item(filter, item);
+
+	for (i = 0; i < filter->follower_names.num; i++) {
+		const char *name = filter->follower_names.array[i];
+		obs_sceneitem_t *follower = get_item(filter->context, name);
+		if (follower)
+			cache_item(filter, follower);
+	}
+
+	return item;
+}
+
+static void item_cache_attach(motion_filter_data_t *filter,
+	obs_source_t *scene)
+{
+	if (!obs_scene_from_source(scene))
+		return;
+
+	filter->signal_scene = scene;
+	filter->signal_weak = obs_source_get_weak_source(scene);
+	item_cache_connect(filter, scene, true);
+	signal_handler_connect(obs_get_signal_handler(), "source_rename",
+		item_cache_dirty, filter);
+	os_atomic_set_bool(&filter->item_dirty, true);
+}
+
+/* A scene destroyed along with its filters took its signals with it. */
+
+static void item_cache_detach(motion_filter_data_t *filter)
+{
+	if (filter->signal_scene) {
+		obs_source_t *scene =
+			obs_weak_source_get_source(filter->signal_weak);
+
+		if (scene)
+			item_cache_connect(filter, scene, false);
+		signal_handler_disconnect(obs_get_signal_handler(),
+			"source_rename", item_cache_dirty, filter);
+		obs_source_release(scene);
+		obs_weak_source_release(filter->signal_weak);
+		filter->signal_weak = NULL;
+		filter->signal_scene = NULL;
+	}
+
+	release_item_cache(filter);
+}
+
+static void release_followers(motion_filter_data_t *filter)
+{
+	size_t i;
+
+	for (i = 0; i < filter->followers.num; i++)
+		obs_sceneitem_release(filter->followers.array[i].item);
+
+	da_resize(filter->followers, 0);
+}
+
+/*
+ * Followers keep their offset and scale ratio to the target as they are
+ * when the motion starts, so the formation is kept both ways.
+ */
+
+static void capture_followers(motion_filter_data_t *filter)
+{
+	struct vec2 pos, scale;
+	size_t i;
+
+	release_followers(filter);
+	obs_sceneitem_get_pos(filter->item, &pos);
+	obs_sceneitem_get_scale(filter->item, &scale);
+
+	for (i = 0; i < filter->cached_followers.num; i++) {
+		struct motion_follower *follower = da_push_back_new(
+			filter->followers);
+		struct vec2 item_pos, item_scale;
+
+		follower->item = filter->cached_followers.array[i];
+		obs_sceneitem_addref(follower->item);
+		obs_sceneitem_get_pos(follower->item, &item_pos);
+		obs_sceneitem_get_scale(follower->item, &item_scale);
+
+		vec2_sub(&follower->offset, &item_pos, &pos);
+		follower->scale_ratio.x = scale.x != 0.0f ?
+			item_scale.x / scale.x : 1.0f;
+		follower->scale_ratio.y = scale.y != 0.0f ?
+			item_scale.y / scale.y : 1.0f;
+	}
+}
+
+/*
+ * Drops the references to items removed from their scene. A running
+ * motion keeps its own until it is done.
+ */
+
+static void release_removed_items(motion_filter_data_t *filter)
+{
+	size_t i;
+	bool removed = filter->cached_item &&
+		!obs_sceneitem_get_scene(filter->cached_item);
+
+	for (i = 0; i < filter->cached_followers.num; i++) {
+		obs_sceneitem_t *item = filter->cached_followers.array[i];
+		removed = removed || !obs_sceneitem_get_scene(item);
+	}
+
+	if (removed)
+		release_item_cache(filter);
+
+	if (filter->motion_start)
+		return;
+
+	for (i = filter->followers.num; i > 0; i--) {
+		obs_sceneitem_t *item = filter->followers.array[i - 1].item;
+
+		if (!obs_sceneitem_get_scene(item)) {
+			obs_sceneitem_release(item);
+			da_erase(filter->followers, i - 1);
+		}
+	}
+}
+
+/*
+ * Output stage. A channel is only set when it moved further than the
+ * commit epsilon since the last commit, scale measured in pixels of the
+ * item's edge. Snapping rounds the position and the scaled size to
+ * whole pixels first. Forced commits land the exact end of a motion.
+ */
+
+static void commit_transform(motion_filter_data_t *filter,
+	obs_sceneitem_t *item, struct motion_output *output,
+	const struct vec2 *pos, const struct vec2 *scale, bool force)
+{
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	struct vec2 base, item_pos = *pos, item_scale = *scale;
+	bool set_pos, set_scale;
+
+	vec2_set(&base, (float)obs_source_get_width(source),
+		(float)obs_source_get_height(source));
+
+	if (filter->pixel_snap) {
+		item_pos.x = roundf(item_pos.x);
+		item_pos.y = roundf(item_pos.y);
+		if (base.x > 0.0f)
+			item_scale.x = roundf(item_scale.x * base.x) / base.x;
+		if (base.y > 0.0f)
+			item_scale.y = roundf(item_scale.y * base.y) / base.y;
+	}
+
+	force = force || !output->valid;
+	set_pos = force || vec2_changed(&item_pos, &output->pos,
+		filter->epsilon);
+	set_scale = force || scale_changed(&item_scale, &output->scale, &base,
+		filter->epsilon);
+
+	if (set_pos) {
+		trace_set_pos(item, &item_pos);
+		output->pos = item_pos;
+	}
+	if (set_scale) {
+		trace_set_scale(item, &item_scale);
+		output->scale = item_scale;
+	}
+
+	output->valid = true;
+	filter->stats.setter_calls += set_pos + set_scale;
+	filter->stats.setter_avoided += !set_pos + !set_scale;
+}
+
+static void set_motion_transform(motion_filter_data_t *filter,
+	const struct vec2 *pos, const struct vec2 *scale, bool force)
+{
+	struct motion_follower *followers = filter->followers.array;
+	size_t i, num = filter->followers.num;
+
+	commit_transform(filter, filter->item, &filter->output, pos, scale,
+		force);
+
+	for (i = 0; i < num; i++) {
+		struct vec2 item_pos, item_scale;
+
+		vec2_add(&item_pos, pos, &followers[i].offset);
+		vec2_mul(&item_scale, scale, &followers[i].scale_ratio);
+		commit_transform(filter, followers[i].item,
+			&followers[i].output, &item_pos, &item_scale, force);
+	}
+}
+
 static void recover_source(motion_filter_data_t *filter)
 {
 	struct vec2 pos;
@@ -246,43 +817,568 @@ static void recover_source(motion_filter_data_t *filter)
 	obs_data_t *settings;
 	variation_data_t *var = &filter->variation;
 
-	if (!filter->motion_end)
+	if (!filter->motion_end)
+		return;
+
+	pos.x = var->point_x[0];
+	pos.y = var->point_y[0];
+	scale.x = var->scale_x[0];
+	scale.y = var->scale_y[0];
+
+	// Restored after a restart, the offsets are still in place
+	if (!filter->followers.num && filter->item)
+		capture_followers(filter);
+
+	set_motion_transform(filter, &pos, &scale, true);
+	filter->motion_end = false;
+	settings = obs_source_get_settings(filter->context);
+	obs_data_set_bool(settings, S_MOTION_END, false);
+	obs_data_release(settings);
+}
+
+/* A retargeted path always runs from the current transform to its end. */
+
+static float time_coeff(motion_filter_data_t *filter, float elapsed_time)
+{
+	if (filter->duration <= 0)
+		return 1.0f;
+	else if (is_reverse(filter) && !filter->variation.retargeted)
+		return 1.0f - (elapsed_time / filter->duration);
+	else 
+		return elapsed_time / filter->duration;
+}
+
+static void eval_variation(motion_filter_data_t *filter, float coeff,
+	struct vec4 *result)
+{
+	variation_data_t *var = &filter->variation;
+
+	if (filter->path_type == PATH_KEYFRAMES) {
+		timeline_eval(&var->timeline, coeff * filter->duration, result);
+		return;
+	}
+
+	if (var->coeff_varaite)
+		coeff = poly_eval(var->coeff_poly, 2, coeff);
+
+	curve_eval(&var->curve, coeff, result);
+
+	// A spring may overshoot the path, the table only covers 0 to 1
+	if (use_arc_length(filter) && var->arc_valid && !var->retargeted &&
+		coeff >= 0.0f && coeff <= 1.0f) {
+		struct vec4 arc_result;
+		float t = curve_arc_param(&var->arc, coeff);
+		curve_eval(&var->curve, t, &arc_result);
+		result->ptr[CURVE_POS_X] = arc_result.ptr[CURVE_POS_X];
+		result->ptr[CURVE_POS_Y] = arc_result.ptr[CURVE_POS_Y];
+	}
+}
+
+/*
+ * The expression sees the configured ends of the path and sizes in
+ * pixels, a retarget only changes the path it runs on top of.
+ */
+
+static void update_expression_ends(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+	obs_source_t *source = obs_sceneitem_get_source(filter->item);
+
+	vec2_set(&var->base, (float)obs_source_get_width(source),
+		(float)obs_source_get_height(source));
+	eval_variation(filter, 0.0f, &var->from);
+	eval_variation(filter, 1.0f, &var->to);
+}
+
+static void apply_expression(motion_filter_data_t *filter, float coeff,
+	float time, struct vec4 *result)
+{
+	variation_data_t *var = &filter->variation;
+	const struct vec2 *base = &var->base;
+	float vars[EXPR_VAR_COUNT];
+	float out[EXPR_OUT_COUNT];
+
+	vars[EXPR_T] = coeff;
+	vars[EXPR_TIME] = time;
+	vars[EXPR_DURATION] = filter->duration;
+	vars[EXPR_START_X] = var->from.ptr[CURVE_POS_X];
+	vars[EXPR_START_Y] = var->from.ptr[CURVE_POS_Y];
+	vars[EXPR_START_W] = var->from.ptr[CURVE_SCALE_X] * base->x;
+	vars[EXPR_START_H] = var->from.ptr[CURVE_SCALE_Y] * base->y;
+	vars[EXPR_DST_X] = var->to.ptr[CURVE_POS_X];
+	vars[EXPR_DST_Y] = var->to.ptr[CURVE_POS_Y];
+	vars[EXPR_DST_W] = var->to.ptr[CURVE_SCALE_X] * base->x;
+	vars[EXPR_DST_H] = var->to.ptr[CURVE_SCALE_Y] * base->y;
+	vars[EXPR_PATH_X] = out[EXPR_OUT_X] = result->ptr[CURVE_POS_X];
+	vars[EXPR_PATH_Y] = out[EXPR_OUT_Y] = result->ptr[CURVE_POS_Y];
+	vars[EXPR_PATH_W] = out[EXPR_OUT_W] =
+		result->ptr[CURVE_SCALE_X] * base->x;
+	vars[EXPR_PATH_H] = out[EXPR_OUT_H] =
+		result->ptr[CURVE_SCALE_Y] * base->y;
+
+	motion_expr_eval(filter->expr, vars, out);
+
+	result->ptr[CURVE_POS_X] = out[EXPR_OUT_X];
+	result->ptr[CURVE_POS_Y] = out[EXPR_OUT_Y];
+	if (base->x > 0.0f)
+		result->ptr[CURVE_SCALE_X] = out[EXPR_OUT_W] / base->x;
+	if (base->y > 0.0f)
+		result->ptr[CURVE_SCALE_Y] = out[EXPR_OUT_H] / base->y;
+}
+
+/*
+ * What the item shows at a progress. A retargeted path already starts
+ * from the shown transform, so the expression is not applied twice.
+ */
+
+static void eval_shown(motion_filter_data_t *filter, float coeff, float time,
+	struct vec4 *result)
+{
+	eval_variation(filter, coeff, result);
+	if (filter->expr && !filter->variation.retargeted)
+		apply_expression(filter, coeff, time, result);
+}
+
+static void fill_bake(void *param, float coeff, struct vec4 *sample)
+{
+	eval_variation(param, coeff, sample);
+}
+
+static void add_curve_key(struct bake_key *key, const struct curve *curve)
+{
+	bake_key_add(key, curve->coeff, sizeof(struct vec4) * (curve->order + 1));
+	bake_key_add(key, &curve->order, sizeof(curve->order));
+}
+
+/*
+ * Everything eval_variation reads goes into the key, so a filter whose
+ * path is unchanged since the last trigger keeps its table.
+ */
+
+static void build_bake_key(motion_filter_data_t *filter, struct bake_key *key,
+	size_t count, uint32_t fps_num, uint32_t fps_den)
+{
+	variation_data_t *var = &filter->variation;
+	bool keyframes = filter->path_type == PATH_KEYFRAMES;
+	bool arc = use_arc_length(filter) && var->arc_valid;
+	size_t i;
+
+	bake_key_add(key, &count, sizeof(count));
+	bake_key_add(key, &fps_num, sizeof(fps_num));
+	bake_key_add(key, &fps_den, sizeof(fps_den));
+	bake_key_add(key, &filter->duration, sizeof(filter->duration));
+	bake_key_add(key, &keyframes, sizeof(keyframes));
+
+	if (keyframes) {
+		for (i = 0; i < var->timeline.segments.num; i++) {
+			struct timeline_segment *seg =
+				&var->timeline.segments.array[i];
+			bake_key_add(key, &seg->start, sizeof(float) * 3);
+			bake_key_add(key, seg->ease_poly, sizeof(seg->ease_poly));
+			bake_key_add(key, &seg->eased, sizeof(seg->eased));
+			add_curve_key(key, &seg->curve);
+		}
+		bake_key_add(key, &var->timeline.origin, sizeof(struct vec4));
+		return;
+	}
+
+	add_curve_key(key, &var->curve);
+	bake_key_add(key, &var->coeff_varaite, sizeof(var->coeff_varaite));
+	if (var->coeff_varaite)
+		bake_key_add(key, var->coeff_poly, sizeof(float) * 3);
+	bake_key_add(key, &arc, sizeof(arc));
+}
+
+static void release_bake(motion_filter_data_t *filter)
+{
+	bake_release(filter->variation.bake);
+	filter->variation.bake = NULL;
+}
+
+static void update_bake(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+	struct bake_key key = { 0 };
+	uint32_t fps_num, fps_den;
+	size_t count;
+
+	count = bake_sample_count(filter->duration, &fps_num, &fps_den);
+	if (!count) {
+		release_bake(filter);
+		return;
+	}
+
+	build_bake_key(filter, &key, count, fps_num, fps_den);
+
+	if (!bake_matches(var->bake, &key)) {
+		struct motion_bake *bake = bake_acquire(&key, count, fill_bake,
+			filter);
+		release_bake(filter);
+		var->bake = bake;
+	}
+
+	bake_key_free(&key);
+}
+
+static bool motion_begin(motion_filter_data_t *filter, bool forward)
+{
+	if (filter->motion_start || is_reverse(filter) == forward)
+		return false;
+
+	filter->item = resolve_item(filter);
+
+	if (filter->item) {
+		capture_followers(filter);
+		update_variation_data(filter);
+		update_expression_ends(filter);
+		obs_sceneitem_addref(filter->item);
+		filter->output.valid = false;
+		filter->motion_start = true;
+		filter->stats.triggers++;
+
+		if (filter->timing == TIMING_SPRING) {
+			float from = forward ? 0.0f : 1.0f;
+			filter->spring = spring_alloc();
+			spring_set(filter->spring, from, 0.0f, 1.0f - from,
+				filter->stiffness, filter->damping);
+		} else if (filter->baked) {
+			update_bake(filter);
+		} else {
+			release_bake(filter);
+		}
+		return true;
+	}
+	return false;
+}
+
+static bool motion_init(void *data, bool forward)
+{
+	motion_filter_data_t *filter = data;
+
+	if (!motion_begin(filter, forward))
+		return false;
+
+	motion_scheduler_add(filter->context, filter);
+	return true;
+}
+
+/*
+ * Triggers arriving while a motion runs. The queue policy keeps them in
+ * order, coalesce keeps the latest one only.
+ */
+
+static void queue_trigger(motion_filter_data_t *filter, bool forward)
+{
+	size_t limit = filter->trigger_policy == TRIGGER_QUEUE ?
+		TRIGGER_QUEUE_MAX : 1;
+
+	if (filter->queued.num < limit)
+		da_push_back(filter->queued, &forward);
+	else if (limit == 1)
+		filter->queued.array[0] = forward;
+}
+
+/* Starts the next queued trigger that applies once a motion is done. */
+
+static void release_spring(motion_filter_data_t *filter)
+{
+	spring_free(filter->spring);
+	filter->spring = -1;
+}
+
+static bool start_queued(motion_filter_data_t *filter)
+{
+	while (filter->queued.num) {
+		bool forward = filter->queued.array[0];
+		da_erase(filter->queued, 0);
+		if (motion_begin(filter, forward))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Round trip reversal in the middle of a motion. The path is the same
+ * both ways, so mirroring the elapsed time continues from the current
+ * coefficient.
+ */
+
+static void motion_reverse(motion_filter_data_t *filter)
+{
+	variation_data_t *var = &filter->variation;
+
+	var->elapsed_time = fmaxf(filter->duration - var->shown_time, 0.0f);
+	filter->motion_end = !filter->motion_end;
+
+	// A spring keeps its velocity and heads for the other end
+	if (use_spring(filter))
+		spring_set_target(filter->spring, is_reverse(filter) ? 0.0f : 1.0f);
+}
+
+/*
+ * Restarts a running motion from where the item is now toward the target
+ * of the given direction. The new path is a cubic whose first control
+ * point continues the current velocity, so the item neither jumps nor
+ * stops. The origin is left alone for the way back.
+ */
+
+static void motion_retarget(motion_filter_data_t *filter, bool forward)
+{
+	variation_data_t *var = &filter->variation;
+	bool spring = use_spring(filter);
+	float step = spring ? RETARGET_STEP :
+		fminf(RETARGET_STEP, var->shown_time);
+	float span = spring ? 1.0f : filter->duration;
+	struct vec4 now, before, target;
+	int channel;
+
+	if (spring) {
+		float x = spring_position(filter->spring);
+		eval_shown(filter, x, var->elapsed_time, &now);
+		eval_shown(filter, x - spring_velocity(filter->spring) * step,
+			var->elapsed_time - step, &before);
+	} else {
+		eval_shown(filter, time_coeff(filter, var->shown_time),
+			var->shown_time, &now);
+		eval_shown(filter, time_coeff(filter, var->shown_time - step),
+			var->shown_time - step, &before);
+	}
+
+	if (forward) {
+		vec4_set(&target, filter->dst_pos.x, filter->dst_pos.y, 0.0f,
+			0.0f);
+		cal_scale(filter->item, &target.ptr[CURVE_SCALE_X],
+			&target.ptr[CURVE_SCALE_Y], filter->dst_width,
+			filter->dst_height);
+	} else {
+		vec4_set(&target, var->point_x[0], var->point_y[0],
+			var->scale_x[0], var->scale_y[0]);
+	}
+
+	curve_init(&var->curve);
+
+	for (channel = 0; channel < 4; channel++) {
+		bool pos = channel == CURVE_POS_X || channel == CURVE_POS_Y;
+		bool change = pos ? filter->change_position :
+			filter->change_size;
+		float velocity = step > 0.0f ?
+			(now.ptr[channel] - before.ptr[channel]) / step : 0.0f;
+		float point[4];
+
+		point[0] = now.ptr[channel];
+		point[1] = point[0] + velocity * span / 3.0f;
+		point[2] = target.ptr[channel];
+		point[3] = target.ptr[channel];
+		curve_set_channel(&var->curve, channel, point, change ? 3 : 0);
+	}
+
+	var->coeff_varaite = false;
+	var->retargeted = true;
+	var->elapsed_time = 0.0f;
+
+	// The new path is progress 0 to 1 at a rate of one per span
+	if (spring)
+		spring_set(filter->spring, 0.0f, 1.0f / span, 1.0f,
+			filter->stiffness, filter->damping);
+
+	if (filter->motion_behavior == BEHAVIOR_ROUND_TRIP)
+		filter->motion_end = !forward;
+}
+
+static void motion_trigger(motion_filter_data_t *filter, bool forward)
+{
+	bool round_trip = filter->motion_behavior == BEHAVIOR_ROUND_TRIP;
+	bool reverse = round_trip && is_reverse(filter) == forward;
+
+	trace_trigger(obs_filter_get_parent(filter->context), filter->context,
+		forward);
+
+	// A one way motion has no way back, as in motion_begin
+	if (!round_trip && !forward)
+		return;
+
+	if (!filter->motion_start) {
+		motion_init(filter, forward);
+		return;
+	}
+
+	switch (filter->trigger_policy) {
+	case TRIGGER_QUEUE:
+	case TRIGGER_COALESCE:
+		queue_trigger(filter, forward);
+		break;
+	case TRIGGER_RETARGET:
+		if (reverse && !filter->variation.retargeted)
+			motion_reverse(filter);
+		else if (filter->path_type != PATH_KEYFRAMES)
+			motion_retarget(filter, forward);
+		else
+			queue_trigger(filter, forward);
+		break;
+	}
+}
+
+/* Leaving the scene in the middle of a motion jumps back to the start. */
+
+static void motion_deactivate(motion_filter_data_t *filter)
+{
+	trace_deactivate(obs_filter_get_parent(filter->context),
+		filter->context);
+
+	if (filter->motion_start) {
+		filter->motion_start = false;
+		filter->variation.elapsed_time = 0.0f;
+		obs_sceneitem_release(filter->item);
+		release_spring(filter);
+	}
+
+	da_resize(filter->queued, 0);
+	filter->motion_end = true;
+	recover_source(filter);
+}
+
+/* The motion keys, from the filter's settings or a preset. */
+
+static void apply_preset_values(motion_filter_data_t *filter,
+	const struct preset_values *v)
+{
+	bool change_pos, change_size, scene_switch;
+	int path_type;
+
+	filter->trigger_policy = v->trigger_policy;
+	filter->timing = v->timing;
+	filter->stiffness = v->stiffness;
+	filter->damping = v->damping;
+	path_type = v->path_type;
+	filter->org_pos.x = (float)v->start_x;
+	filter->org_pos.y = (float)v->start_y;
+	filter->org_width = v->start_w;
+	filter->org_height = v->start_h;
+	filter->ctrl_pos.x = (float)v->ctrl_x;
+	filter->ctrl_pos.y = (float)v->ctrl_y;
+	filter->ctrl2_pos.x = (float)v->ctrl2_x;
+	filter->ctrl2_pos.y = (float)v->ctrl2_y;
+	filter->duration = v->duration;
+	filter->dst_pos.x = (float)v->dst_x;
+	filter->dst_pos.y = (float)v->dst_y;
+	filter->dst_width = v->dst_w;
+	filter->dst_height = v->dst_h;
+	filter->acceleration = v->acceleration;
+
+	change_pos = (v->variation_type & VARIATION_POSITION) != 0;
+	change_size = (v->variation_type & VARIATION_SIZE) != 0;
+	scene_switch = filter->motion_behavior == BEHAVIOR_SCENE_SWITCH;
+
+
+	filter->use_start_position = (scene_switch || v->use_start) &&
+		change_pos;
+	filter->use_start_scale = (scene_switch || v->use_start) && change_size;
+	filter->change_position = change_pos;
+	filter->change_size = change_size;
+	filter->constant_speed = v->constant_speed != 0;
+	filter->baked = v->baked != 0;
+	filter->epsilon = v->epsilon;
+	filter->pixel_snap = v->pixel_snap != 0;
+
+	if (path_type != filter->path_type || !change_pos)
+		filter->variation.arc_valid = false;
+
+	filter->path_type = path_type;
+
+	if (path_type == PATH_KEYFRAMES) {
+		size_t num = filter->keyframes.num;
+		filter->duration = num ? filter->keyframes.array[num - 1].time : 0.0f;
+	}
+}
+
+/*
+ * Posted when the preset this filter references was stored again, maybe
+ * by another filter. Only the preset keys are applied, the rest of the
+ * settings did not change.
+ */
+
+static void reload_preset(motion_filter_data_t *filter)
+{
+	struct motion_preset preset;
+	long generation = preset_generation(filter->preset_id);
+
+	if (!filter->preset_id || generation == filter->preset_generation)
 		return;
 
-	pos.x = var->point_x[0];
-	pos.y = var->point_y[0];
-	scale.x = var->scale_x[0];
-	scale.y = var->scale_y[0];
+	filter->preset_generation = generation;
+	if (preset_get(filter->preset_id, &preset))
+		apply_preset_values(filter, &preset.values);
+}
 
-	obs_sceneitem_set_pos(filter->item, &pos);
-	obs_sceneitem_set_scale(filter->item, &scale);
-	filter->motion_end = false;
-	settings = obs_source_get_settings(filter->context);
-	obs_data_set_bool(settings, S_MOTION_END, false);
-	obs_data_release(settings);
+/* Between ticks, so no worker is evaluating the old program. */
+
+static void install_expression(motion_filter_data_t *filter)
+{
+	pthread_mutex_lock(&filter->expr_mutex);
+	if (filter->expr_pending) {
+		motion_expr_destroy(filter->expr);
+		filter->expr = filter->pending_expr;
+		filter->pending_expr = NULL;
+		filter->expr_pending = false;
+	}
+	pthread_mutex_unlock(&filter->expr_mutex);
 }
 
-static bool motion_init(void *data, bool forward)
+/* Runs on the graphics thread, see motion_scheduler_post. */
+
+static void motion_filter_execute(void *data, int command)
 {
 	motion_filter_data_t *filter = data;
 
-	if (filter->motion_start || is_reverse(filter) == forward)
-		return false;
+	switch (command) {
+	case COMMAND_FORWARD:
+		motion_trigger(filter, true);
+		break;
+	case COMMAND_BACKWARD:
+		motion_trigger(filter, false);
+		break;
+	case COMMAND_ACTIVATE:
+		// Nested scenes go live with their parent, only a switch to
+		// the scene itself starts the motion. A transition has picked
+		// its sources up by the time the command runs.
+		if (is_output_scene(filter->dispatch_scene))
+			motion_trigger(filter, true);
+		break;
+	case COMMAND_DEACTIVATE:
+		motion_deactivate(filter);
+		break;
+	case COMMAND_RECOVER:
+		recover_source(filter);
+		break;
+	case COMMAND_RESOLVE:
+		resolve_item(filter);
+		break;
+	case COMMAND_EXPRESSION:
+		install_expression(filter);
+		break;
+	case COMMAND_RELEASE:
+		release_removed_items(filter);
+		break;
+	case COMMAND_PRESET:
+		reload_preset(filter);
+		break;
+	}
+}
 
-	filter->item = get_item(filter->context, filter->item_name);
+static inline bool post_command(motion_filter_data_t *filter, int command)
+{
+	return motion_scheduler_post(filter->context, filter, &filter->removed,
+		command);
+}
 
-	if (!filter->item) {
-		filter->item = get_item_by_id(filter->context, filter->item_id);
-		reset_source_name(data, filter->item);
-	}
+/*
+ * Whether a trigger posted now will start a motion, for the buttons.
+ * Only a hint, the motion state belongs to the graphics thread.
+ */
 
-	if (filter->item) {
-		update_variation_data(filter);
-		obs_sceneitem_addref(filter->item);
-		filter->motion_start = true;
-		return true;
-	}
-	return false;
+static inline bool can_trigger(motion_filter_data_t *filter, bool forward)
+{
+	return !filter->motion_start && is_reverse(filter) != forward;
 }
 
 static void hotkey_forward(void *data, obs_hotkey_pair_id id,
@@ -291,7 +1387,7 @@ static void hotkey_forward(void *data, obs_hotkey_pair_id id,
 	UNUSED_PARAMETER(id);
 	UNUSED_PARAMETER(hotkey);
 	UNUSED_PARAMETER(pressed);
-	motion_init(data, true);
+	post_command(data, COMMAND_FORWARD);
 }
 
 static void hotkey_backward(void *data, obs_hotkey_pair_id id,
@@ -300,40 +1396,25 @@ static void hotkey_backward(void *data, obs_hotkey_pair_id id,
 	UNUSED_PARAMETER(id);
 	UNUSED_PARAMETER(hotkey);
 	UNUSED_PARAMETER(pressed);
-	motion_init(data, false);
+	post_command(data, COMMAND_BACKWARD);
 }
 
-static void scene_change(enum obs_frontend_event event, void *data)
+static void get_stats_proc(void *data, calldata_t *cd)
 {
 	motion_filter_data_t *filter = data;
-	obs_data_t *settings;
-	obs_source_t *cur_scene;
-	obs_source_t *self_scene;
-	const char* cur_name;
-	const char* self_name;
+	motion_stats_to_calldata(&filter->stats, cd);
+}
 
-	if (event != OBS_FRONTEND_EVENT_SCENE_CHANGED)
-		return;
+static void log_stats_proc(void *data, calldata_t *cd)
+{
+	motion_filter_data_t *filter = data;
+	motion_stats_log(filter->context, &filter->stats);
+	UNUSED_PARAMETER(cd);
+}
 
-	cur_scene = obs_frontend_get_current_scene();
-	self_scene = obs_filter_get_parent(filter->context);
-
-	if (cur_scene == self_scene) {
-		motion_init(data, true);
-	} else if (is_program_scene(self_scene)) {
-		settings = obs_source_get_settings(filter->context);
-		self_name = obs_data_get_string(settings, S_SCENE_NAME);
-		cur_name = obs_source_get_name(cur_scene);
-		if (self_name && cur_name && strcmp(self_name, cur_name)==0) {
-			motion_init(data, true);
-		}
-		obs_data_release(settings);
-	} else {
-		filter->motion_start = false;
-		filter->motion_end = true;
-		recover_source(filter);
-	}
-	obs_source_release(cur_scene);
+static void scene_switched(void *data, bool active)
+{
+	post_command(data, active ? COMMAND_ACTIVATE : COMMAND_DEACTIVATE);
 }
 
 static void set_reverse_info(struct motion_filter_data *filter)
@@ -372,49 +1453,223 @@ static void motion_filter_save(void *data, obs_data_t *settings)
 	save_hotkey_config(filter->hotkey_id_b, settings, S_BACKWARD);
 }
 
+static int compare_keyframes(const void *a, const void *b)
+{
+	const struct motion_keyframe *key_a = a;
+	const struct motion_keyframe *key_b = b;
+
+	if (key_a->time < key_b->time)
+		return -1;
+	return key_a->time > key_b->time ? 1 : 0;
+}
+
+/*
+ * Each keyframe is one line of "time x y width height [easing]", time in
+ * seconds from the start of the motion and easing in the same -1 to 1
+ * range as the acceleration setting.
+ */
+
+static void update_keyframes(motion_filter_data_t *filter,
+	obs_data_t *settings)
+{
+	obs_data_array_t *array = obs_data_get_array(settings, S_KEYFRAMES);
+	size_t i, count = obs_data_array_count(array);
+
+	da_resize(filter->keyframes, 0);
+
+	for (i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		const char *value = obs_data_get_string(item, "value");
+		struct motion_keyframe key = { 0 };
+		int n = sscanf(value, "%f %f %f %d %d %f", &key.time, &key.pos.x,
+			&key.pos.y, &key.width, &key.height, &key.easing);
+
+		if (n >= 5 && key.time >= 0.0f) {
+			key.easing = fmaxf(-1.0f, fminf(1.0f, key.easing));
+			da_push_back(filter->keyframes, &key);
+		} else {
+			blog(LOG_WARNING, "motion-filter: ignoring keyframe '%s'",
+				value);
+		}
+
+		obs_data_release(item);
+	}
+
+	obs_data_array_release(array);
+
+	if (filter->keyframes.num > 1)
+		qsort(filter->keyframes.array, filter->keyframes.num,
+			sizeof(struct motion_keyframe), compare_keyframes);
+}
+
+static void free_follower_names(motion_filter_data_t *filter)
+{
+	size_t i;
+
+	for (i = 0; i < filter->follower_names.num; i++)
+		bfree(filter->follower_names.array[i]);
+
+	da_resize(filter->follower_names, 0);
+}
+
+/* Returns true if the follower list differs from the current one. */
+
+static bool update_follower_names(motion_filter_data_t *filter,
+	obs_data_t *settings)
+{
+	obs_data_array_t *array = obs_data_get_array(settings, S_FOLLOWERS);
+	size_t i, count = obs_data_array_count(array);
+	bool changed = count != filter->follower_names.num;
+
+	for (i = 0; i < count && !changed; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		const char *name = obs_data_get_string(item, "value");
+		changed = strcmp(name, filter->follower_names.array[i]) != 0;
+		obs_data_release(item);
+	}
+
+	if (changed) {
+		free_follower_names(filter);
+		for (i = 0; i < count; i++) {
+			obs_data_t *item = obs_data_array_item(array, i);
+			char *name = bstrdup(obs_data_get_string(item, "value"));
+			da_push_back(filter->follower_names, &name);
+			obs_data_release(item);
+		}
+	}
+
+	obs_data_array_release(array);
+	return changed;
+}
+
+/*
+ * Compiled once here, the graphics thread picks the program up with
+ * COMMAND_EXPRESSION.
+ */
+
+static void update_expression(motion_filter_data_t *filter, const char *text)
+{
+	struct motion_expr *expr;
+	char error[256] = "";
+
+	if (filter->expr_text && strcmp(filter->expr_text, text) == 0)
+		return;
+
+	bfree(filter->expr_text);
+	filter->expr_text = bstrdup(text);
+
+	expr = motion_expr_compile(text, error, sizeof(error));
+	if (!expr && *error)
+		blog(LOG_WARNING, "motion-filter: expression of '%s' ignored, %s",
+			obs_source_get_name(filter->context), error);
+
+	pthread_mutex_lock(&filter->expr_mutex);
+	motion_expr_destroy(filter->pending_expr);
+	filter->pending_expr = expr;
+	filter->expr_pending = true;
+	pthread_mutex_unlock(&filter->expr_mutex);
+
+	post_command(filter, COMMAND_EXPRESSION);
+}
+
+/* The motion keys a preset carries, see preset_values. */
+
+static void read_preset_settings(obs_data_t *settings,
+	struct preset_values *values)
+{
+	values->path_type = (int32_t)obs_data_get_int(settings, S_PATH_TYPE);
+	values->variation_type = (int32_t)obs_data_get_int(settings,
+		S_VARIATION_TYPE);
+	values->trigger_policy = (int32_t)obs_data_get_int(settings,
+		S_TRIGGER_POLICY);
+	values->timing = (int32_t)obs_data_get_int(settings, S_TIMING);
+	values->start_x = (int32_t)obs_data_get_int(settings, S_START_X);
+	values->start_y = (int32_t)obs_data_get_int(settings, S_START_Y);
+	values->start_w = (int32_t)obs_data_get_int(settings, S_START_W);
+	values->start_h = (int32_t)obs_data_get_int(settings, S_START_H);
+	values->ctrl_x = (int32_t)obs_data_get_int(settings, S_CTRL_X);
+	values->ctrl_y = (int32_t)obs_data_get_int(settings, S_CTRL_Y);
+	values->ctrl2_x = (int32_t)obs_data_get_int(settings, S_CTRL2_X);
+	values->ctrl2_y = (int32_t)obs_data_get_int(settings, S_CTRL2_Y);
+	values->dst_x = (int32_t)obs_data_get_int(settings, S_DST_X);
+	values->dst_y = (int32_t)obs_data_get_int(settings, S_DST_Y);
+	values->dst_w = (int32_t)obs_data_get_int(settings, S_DST_W);
+	values->dst_h = (int32_t)obs_data_get_int(settings, S_DST_H);
+	values->duration = (float)obs_data_get_double(settings, S_DURATION);
+	values->acceleration = (float)obs_data_get_double(settings,
+		S_ACCELERATION);
+	values->stiffness = (float)obs_data_get_double(settings, S_STIFFNESS);
+	values->damping = (float)obs_data_get_double(settings, S_DAMPING);
+	values->epsilon = (float)obs_data_get_double(settings, S_EPSILON);
+	values->use_start = obs_data_get_bool(settings, S_START_SETTING);
+	values->constant_speed = obs_data_get_bool(settings, S_CONSTANT_SPEED);
+	values->baked = obs_data_get_bool(settings, S_BAKED);
+	values->pixel_snap = obs_data_get_bool(settings, S_PIXEL_SNAP);
+}
+
+static void write_preset_settings(obs_data_t *settings,
+	const struct preset_values *values)
+{
+	obs_data_set_int(settings, S_PATH_TYPE, values->path_type);
+	obs_data_set_int(settings, S_VARIATION_TYPE, values->variation_type);
+	obs_data_set_int(settings, S_TRIGGER_POLICY, values->trigger_policy);
+	obs_data_set_int(settings, S_TIMING, values->timing);
+	obs_data_set_int(settings, S_START_X, values->start_x);
+	obs_data_set_int(settings, S_START_Y, values->start_y);
+	obs_data_set_int(settings, S_START_W, values->start_w);
+	obs_data_set_int(settings, S_START_H, values->start_h);
+	obs_data_set_int(settings, S_CTRL_X, values->ctrl_x);
+	obs_data_set_int(settings, S_CTRL_Y, values->ctrl_y);
+	obs_data_set_int(settings, S_CTRL2_X, values->ctrl2_x);
+	obs_data_set_int(settings, S_CTRL2_Y, values->ctrl2_y);
+	obs_data_set_int(settings, S_DST_X, values->dst_x);
+	obs_data_set_int(settings, S_DST_Y, values->dst_y);
+	obs_data_set_int(settings, S_DST_W, values->dst_w);
+	obs_data_set_int(settings, S_DST_H, values->dst_h);
+	obs_data_set_double(settings, S_DURATION, values->duration);
+	obs_data_set_double(settings, S_ACCELERATION, values->acceleration);
+	obs_data_set_double(settings, S_STIFFNESS, values->stiffness);
+	obs_data_set_double(settings, S_DAMPING, values->damping);
+	obs_data_set_double(settings, S_EPSILON, values->epsilon);
+	obs_data_set_bool(settings, S_START_SETTING, values->use_start != 0);
+	obs_data_set_bool(settings, S_CONSTANT_SPEED,
+		values->constant_speed != 0);
+	obs_data_set_bool(settings, S_BAKED, values->baked != 0);
+	obs_data_set_bool(settings, S_PIXEL_SNAP, values->pixel_snap != 0);
+}
+
 static void motion_filter_update(void *data, obs_data_t *settings)
 {
 	motion_filter_data_t *filter = data;
-	bool use_start, change_pos, change_size, scene_switch;
-	int var_type;
-	int64_t item_id;
+	struct motion_preset preset;
 	const char *item_name;
 
+	// A referenced preset replaces the motion keys of this filter
+	filter->preset_id = (uint32_t)obs_data_get_int(settings, S_PRESET);
+	filter->preset_generation = preset_generation(filter->preset_id);
+	if (!filter->preset_id || !preset_get(filter->preset_id, &preset))
+		read_preset_settings(settings, &preset.values);
+
 	filter->motion_behavior = (int)obs_data_get_int(settings, S_MOTION_BEHAVIOR);
-	filter->path_type = (int)obs_data_get_int(settings, S_PATH_TYPE);
-	filter->org_pos.x = (float)obs_data_get_int(settings, S_START_X);
-	filter->org_pos.y = (float)obs_data_get_int(settings, S_START_Y);
-	filter->org_width = (int)obs_data_get_int(settings, S_START_W);
-	filter->org_height = (int)obs_data_get_int(settings, S_START_H);
-	filter->ctrl_pos.x = (float)obs_data_get_int(settings, S_CTRL_X);
-	filter->ctrl_pos.y = (float)obs_data_get_int(settings, S_CTRL_Y);
-	filter->ctrl2_pos.x = (float)obs_data_get_int(settings, S_CTRL2_X);
-	filter->ctrl2_pos.y = (float)obs_data_get_int(settings, S_CTRL2_Y);
-	filter->duration = (float)obs_data_get_double(settings, S_DURATION);
-	filter->dst_pos.x = (float)obs_data_get_int(settings, S_DST_X);
-	filter->dst_pos.y = (float)obs_data_get_int(settings, S_DST_Y);
-	filter->dst_width = (int)obs_data_get_int(settings, S_DST_W);
-	filter->dst_height = (int)obs_data_get_int(settings, S_DST_H);
-	filter->acceleration = (float)obs_data_get_double(settings, S_ACCELERATION);
-	use_start = obs_data_get_bool(settings, S_START_SETTING);
-	var_type = (int)obs_data_get_int(settings, S_VARIATION_TYPE);
+	update_keyframes(filter, settings);
+	apply_preset_values(filter, &preset.values);
+	update_expression(filter, obs_data_get_string(settings, S_EXPRESSION));
 	item_name = obs_data_get_string(settings, S_SOURCE);
-	item_id = get_item_id(filter->context, item_name);
 
-	change_pos = (var_type & VARIATION_POSITION) != 0;
-	change_size = (var_type & VARIATION_SIZE) != 0;
-	scene_switch = filter->motion_behavior == BEHAVIOR_SCENE_SWITCH;
-
-
-	filter->use_start_position = (scene_switch || use_start) && change_pos;
-	filter->use_start_scale = (scene_switch || use_start) && change_size;
-	filter->change_position = change_pos;
-	filter->change_size = change_size;
+	if (update_follower_names(filter, settings))
+		os_atomic_set_bool(&filter->item_dirty, true);
 
+	if (filter->item_name && strcmp(filter->item_name, item_name) == 0)
+		return;
 
 	bfree(filter->item_name);
 	filter->item_name = bstrdup(item_name);
-	filter->item_id = item_id;
+	filter->item_id = -1;
+	os_atomic_set_bool(&filter->item_dirty, true);
+
+	// Remember the id soon so the item is still found after a rename
+	if (filter->signal_scene)
+		post_command(filter, COMMAND_RESOLVE);
 }
 
 static bool register_trigger_event(void *data)
@@ -427,7 +1682,12 @@ static bool register_trigger_event(void *data)
 		return false;
 
 	if (filter->motion_behavior == BEHAVIOR_SCENE_SWITCH) {
-		obs_frontend_add_event_callback(scene_change, data);
+		scene_dispatcher_add(source, data);
+		filter->dispatch_scene = source;
+
+		// A private program scene may go live before its first tick
+		if (is_program_scene(source) && obs_source_active(source))
+			post_command(filter, COMMAND_FORWARD);
 		return true;
 	}
 
@@ -450,7 +1710,8 @@ static void unregister_trigger_event(void *data)
 
 
 	if (filter->motion_behavior == BEHAVIOR_SCENE_SWITCH) {
-		obs_frontend_remove_event_callback(scene_change, data);
+		scene_dispatcher_remove(filter->dispatch_scene, data);
+		filter->dispatch_scene = NULL;
 		return ;
 	}
 
@@ -480,7 +1741,10 @@ static bool forward_clicked(obs_properties_t *props, obs_property_t *p,
 	void *data)
 {
 	motion_filter_data_t *filter = data;
-	if (motion_init(data, true) && filter->motion_behavior == BEHAVIOR_ROUND_TRIP)
+	bool start = can_trigger(filter, true);
+
+	if (post_command(filter, COMMAND_FORWARD) && start &&
+		filter->motion_behavior == BEHAVIOR_ROUND_TRIP)
 		return motion_set_button(props, p, true);
 	else
 		return false;
@@ -489,7 +1753,10 @@ static bool forward_clicked(obs_properties_t *props, obs_property_t *p,
 static bool backward_clicked(obs_properties_t *props, obs_property_t *p,
 	void *data)
 {
-	if (motion_init(data, false))
+	motion_filter_data_t *filter = data;
+	bool start = can_trigger(filter, false);
+
+	if (post_command(filter, COMMAND_BACKWARD) && start)
 		return motion_set_button(props, p, false);
 	else
 		return false;
@@ -506,7 +1773,7 @@ static bool source_changed(void *data, obs_properties_t *props,
 	else if (strcmp(filter->item_name, name) == 0)
 		return false;
 	else 
-		recover_source(filter);
+		post_command(filter, COMMAND_RECOVER);
 
 	return motion_set_button(props, p, false);
 }
@@ -517,6 +1784,11 @@ static bool motion_list_source(obs_scene_t* scene,
 	obs_source_t *source = obs_sceneitem_get_source(item);
 	const char *name = obs_source_get_name(source);
 	obs_property_list_add_string((obs_property_t*)p, name, name);
+
+	// Items inside groups can be targeted too
+	if (obs_sceneitem_is_group(item))
+		obs_sceneitem_group_enum_items(item, motion_list_source, p);
+
 	UNUSED_PARAMETER(scene);
 	return true;
 }
@@ -545,21 +1817,32 @@ static bool properties_set_vis(void *data, obs_properties_t *props,
 	bool change_pos = (var_type & VARIATION_POSITION) != 0;
 	bool change_size = (var_type & VARIATION_SIZE) != 0;
 	bool scene_switch = trigger_type == BEHAVIOR_SCENE_SWITCH;
+	bool keyframes = path_type == PATH_KEYFRAMES;
+	bool curve = change_pos && !keyframes;
+	bool spring = obs_data_get_int(s, S_TIMING) == TIMING_SPRING;
 
 	set_visibility(S_START_SETTING, !scene_switch);
 	set_visibility(S_START_X, change_pos && (use_start || scene_switch));
 	set_visibility(S_START_Y, change_pos && (use_start || scene_switch));
-	set_visibility(S_DST_X, change_pos);
-	set_visibility(S_DST_Y, change_pos);
-	set_visibility(S_PATH_TYPE, change_pos);
-	set_visibility(S_CTRL_X, change_pos && path_type >= PATH_QUADRATIC);
-	set_visibility(S_CTRL_Y, change_pos && path_type >= PATH_QUADRATIC);
-	set_visibility(S_CTRL2_X, change_pos && path_type >= PATH_CUBIC);
-	set_visibility(S_CTRL2_Y, change_pos && path_type >= PATH_CUBIC);
+	set_visibility(S_DST_X, curve);
+	set_visibility(S_DST_Y, curve);
+	set_visibility(S_PATH_TYPE, change_pos || keyframes);
+	set_visibility(S_CTRL_X, curve && path_type >= PATH_QUADRATIC);
+	set_visibility(S_CTRL_Y, curve && path_type >= PATH_QUADRATIC);
+	set_visibility(S_CTRL2_X, curve && path_type >= PATH_CUBIC);
+	set_visibility(S_CTRL2_Y, curve && path_type >= PATH_CUBIC);
+	set_visibility(S_CONSTANT_SPEED, curve && path_type >= PATH_QUADRATIC);
 	set_visibility(S_START_W, change_size && (use_start || scene_switch));
 	set_visibility(S_START_H, change_size && (use_start || scene_switch));
-	set_visibility(S_DST_W, change_size);
-	set_visibility(S_DST_H, change_size);
+	set_visibility(S_DST_W, change_size && !keyframes);
+	set_visibility(S_DST_H, change_size && !keyframes);
+	set_visibility(S_DEST_GRAB_POS, !keyframes);
+	set_visibility(S_DURATION, !keyframes && !spring);
+	set_visibility(S_ACCELERATION, !keyframes && !spring);
+	set_visibility(S_STIFFNESS, spring);
+	set_visibility(S_DAMPING, spring);
+	set_visibility(S_BAKED, !spring);
+	set_visibility(S_KEYFRAMES, keyframes);
 
 	UNUSED_PARAMETER(p);
 	return true;
@@ -571,10 +1854,17 @@ static bool motion_behavior_changed(void *data, obs_properties_t *props,
 	motion_filter_data_t *filter = data;
 	int behavior = (int)obs_data_get_int(s, S_MOTION_BEHAVIOR);
 	if (behavior != filter->motion_behavior) {
-		recover_source(filter);
-		unregister_trigger_event(data);
+		post_command(filter, COMMAND_RECOVER);
+
+		// Not loaded yet, the loader registers the new behavior
+		motion_loader_lock();
+		if (filter->loaded)
+			unregister_trigger_event(data);
 		filter->motion_behavior = behavior;
-		register_trigger_event(data);
+		if (filter->loaded)
+			register_trigger_event(data);
+		motion_loader_unlock();
+
 		properties_set_vis(data, props, p, s);
 		return motion_set_button(props, p, false);
 	}
@@ -585,12 +1875,12 @@ static bool dest_grab_current_position_clicked(obs_properties_t *props,
 	obs_property_t *p, void *data)
 {
 	struct motion_filter_data *filter = data;
+	// Find the targetted source item within the scene, the cache belongs
+	// to the graphics thread
 	obs_sceneitem_t *item = get_item(filter->context, filter->item_name);
-	// Find the targetted source item within the scene
-	if (!filter->item) {
+
+	if (!item)
 		item = get_item_by_id(filter->context, filter->item_id);
-		reset_source_name(data, filter->item);
-	}
 
 	if (item) {
 		struct obs_transform_info info;
@@ -610,6 +1900,115 @@ static bool dest_grab_current_position_clicked(obs_properties_t *props,
 	return false;
 }
 
+static void add_preset_item(void *param, const struct motion_preset *preset)
+{
+	obs_property_list_add_int(param, preset->name, preset->id);
+}
+
+static void fill_preset_list(obs_property_t *p)
+{
+	obs_property_list_clear(p);
+	obs_property_list_add_int(p, T_PRESET_NONE, 0);
+	preset_enum(add_preset_item, p);
+}
+
+static bool preset_changed(void *data, obs_properties_t *props,
+	obs_property_t *p, obs_data_t *s)
+{
+	struct motion_preset preset;
+	uint32_t id = (uint32_t)obs_data_get_int(s, S_PRESET);
+
+	// Show what the preset does, the keys are not read while it is set
+	if (!id || !preset_get(id, &preset))
+		return false;
+
+	write_preset_settings(s, &preset.values);
+	obs_data_set_string(s, S_PRESET_NAME, preset.name);
+	return properties_set_vis(data, props, p, s);
+}
+
+static void post_preset_filter(obs_source_t *parent, obs_source_t *child,
+	void *param)
+{
+	uint32_t id = *(uint32_t *)param;
+	motion_filter_data_t *filter;
+
+	if (strcmp(obs_source_get_id(child), "motion-filter") != 0)
+		return;
+
+	filter = obs_obj_get_data(child);
+	if (filter && filter->preset_id == id)
+		post_command(filter, COMMAND_PRESET);
+	UNUSED_PARAMETER(parent);
+}
+
+static bool post_preset_scene(void *param, obs_source_t *scene)
+{
+	obs_source_enum_filters(scene, post_preset_filter, param);
+	return true;
+}
+
+/*
+ * Stores the keys of this filter as a preset and references it. Other
+ * filters already referencing the preset are told to apply it again.
+ */
+
+static bool preset_export_clicked(obs_properties_t *props, obs_property_t *p,
+	void *data)
+{
+	motion_filter_data_t *filter = data;
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	char name[PRESET_NAME_SIZE];
+	struct preset_values values;
+	uint32_t id;
+
+	strncpy(name, obs_data_get_string(settings, S_PRESET_NAME),
+		sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+	if (!*name)
+		strncpy(name, obs_source_get_name(filter->context),
+			sizeof(name) - 1);
+
+	read_preset_settings(settings, &values);
+	id = preset_store(name, &values);
+	if (id) {
+		obs_data_set_int(settings, S_PRESET, id);
+		obs_data_set_string(settings, S_PRESET_NAME, name);
+		obs_source_update(filter->context, NULL);
+		obs_enum_scenes(post_preset_scene, &id);
+	} else {
+		blog(LOG_WARNING, "preset: could not store '%s'", name);
+	}
+	obs_data_release(settings);
+
+	fill_preset_list(obs_properties_get(props, S_PRESET));
+	UNUSED_PARAMETER(p);
+	return id != 0;
+}
+
+/* Copies the referenced preset into the keys and drops the reference. */
+
+static bool preset_import_clicked(obs_properties_t *props, obs_property_t *p,
+	void *data)
+{
+	motion_filter_data_t *filter = data;
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	uint32_t id = (uint32_t)obs_data_get_int(settings, S_PRESET);
+	struct motion_preset preset;
+	bool found = id && preset_get(id, &preset);
+
+	if (found) {
+		write_preset_settings(settings, &preset.values);
+		obs_data_set_int(settings, S_PRESET, 0);
+		obs_source_update(filter->context, NULL);
+	}
+	obs_data_release(settings);
+
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(p);
+	return found;
+}
+
 #undef set_visibility
 #undef set_visibility_bool
 
@@ -651,6 +2050,25 @@ static obs_properties_t *motion_filter_properties(void *data)
 	// Using modified_callback2 enables us to send along data into the callback
 	obs_property_set_modified_callback2(p, motion_behavior_changed, filter);
 
+	// What a trigger does while the motion is still running
+	p = obs_properties_add_list(props, S_TRIGGER_POLICY, T_TRIGGER_POLICY,
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(p, T_TRIGGER_IGNORE, TRIGGER_IGNORE);
+	obs_property_list_add_int(p, T_TRIGGER_QUEUE, TRIGGER_QUEUE);
+	obs_property_list_add_int(p, T_TRIGGER_COALESCE, TRIGGER_COALESCE);
+	obs_property_list_add_int(p, T_TRIGGER_RETARGET, TRIGGER_RETARGET);
+
+	// Shared presets, see motion-preset.h
+	p = obs_properties_add_list(props, S_PRESET, T_PRESET,
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	fill_preset_list(p);
+	obs_property_set_modified_callback2(p, preset_changed, filter);
+	obs_properties_add_text(props, S_PRESET_NAME, T_PRESET_NAME,
+		OBS_TEXT_DEFAULT);
+	obs_properties_add_button(props, S_PRESET_EXPORT, T_PRESET_EXPORT,
+		preset_export_clicked);
+	obs_properties_add_button(props, S_PRESET_IMPORT, T_PRESET_IMPORT,
+		preset_import_clicked);
 
 	//Variation of position or size
 	p = obs_properties_add_list(props, S_VARIATION_TYPE, T_VARIATION_TYPE,
@@ -679,8 +2097,17 @@ static obs_properties_t *motion_filter_properties(void *data)
 	obs_property_list_add_int(p, T_PATH_LINEAR, PATH_LINEAR);
 	obs_property_list_add_int(p, T_PATH_QUADRATIC, PATH_QUADRATIC);
 	obs_property_list_add_int(p, T_PATH_CUBIC, PATH_CUBIC);
+	obs_property_list_add_int(p, T_PATH_KEYFRAMES, PATH_KEYFRAMES);
 	obs_property_set_modified_callback2(p, properties_set_vis,filter);
 
+	// Keyframe lines, "time x y width height [easing]"
+	obs_properties_add_editable_list(props, S_KEYFRAMES, T_KEYFRAMES,
+		OBS_EDITABLE_LIST_TYPE_STRINGS, NULL, NULL);
+
+	// Other sources moved along with the target, keeping their offsets
+	obs_properties_add_editable_list(props, S_FOLLOWERS, T_FOLLOWERS,
+		OBS_EDITABLE_LIST_TYPE_STRINGS, NULL, NULL);
+
 	// Button that pre-populates destination position with the source's current position
 	obs_properties_add_button(props, S_DEST_GRAB_POS, T_DEST_GRAB_POS,
 		dest_grab_current_position_clicked);
@@ -696,6 +2123,9 @@ static obs_properties_t *motion_filter_properties(void *data)
 	obs_properties_add_int(props, S_CTRL2_X, T_CTRL2_X, -8192, 8192, 1);
 	obs_properties_add_int(props, S_CTRL2_Y, T_CTRL2_Y, -8192, 8192, 1);
 
+	// Move along the curve at constant speed
+	obs_properties_add_bool(props, S_CONSTANT_SPEED, T_CONSTANT_SPEED);
+
 	// Custom width and height
 	obs_properties_add_int(props, S_DST_W, T_DST_W, 0, 8192, 1);
 	obs_properties_add_int(props, S_DST_H, T_DST_H, 0, 8192, 1);
@@ -708,6 +2138,30 @@ static obs_properties_t *motion_filter_properties(void *data)
 	obs_properties_add_float_slider(props, S_ACCELERATION, T_ACCELERATION, -1, 
 		1, 0.01);
 
+	// Fixed duration or a spring toward the destination
+	p = obs_properties_add_list(props, S_TIMING, T_TIMING,
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(p, T_TIMING_DURATION, TIMING_DURATION);
+	obs_property_list_add_int(p, T_TIMING_SPRING, TIMING_SPRING);
+	obs_property_set_modified_callback2(p, properties_set_vis, filter);
+
+	obs_properties_add_float_slider(props, S_STIFFNESS, T_STIFFNESS, 1, 1000,
+		1);
+	obs_properties_add_float_slider(props, S_DAMPING, T_DAMPING, 0.05, 2,
+		0.01);
+
+	// Sample the motion per frame when it starts
+	obs_properties_add_bool(props, S_BAKED, T_BAKED);
+
+	// Evaluated every tick on top of the path
+	obs_properties_add_text(props, S_EXPRESSION, T_EXPRESSION,
+		OBS_TEXT_MULTILINE);
+
+	// Output stage
+	obs_properties_add_float_slider(props, S_EPSILON, T_EPSILON, 0.0, 5.0,
+		0.05);
+	obs_properties_add_bool(props, S_PIXEL_SNAP, T_PIXEL_SNAP);
+
 	// Forwards / Backwards button(s)
 	p = obs_properties_add_button(props, S_FORWARD, T_FORWARD, forward_clicked);
 	obs_property_set_visible(p, !is_reverse(filter));
@@ -720,75 +2174,141 @@ static obs_properties_t *motion_filter_properties(void *data)
 static void cal_variation(motion_filter_data_t *filter)
 {
 	variation_data_t *var = &filter->variation;
+	struct vec4 result;
+	float coeff, time;
 
-	float elapsed_time = fmin(filter->duration, var->elapsed_time);
-	float coeff;
-	int order;
+	if (use_spring(filter)) {
+		coeff = spring_position(filter->spring);
+		time = var->elapsed_time;
+	} else {
+		var->shown_time = fminf(filter->duration, var->elapsed_time);
+		coeff = time_coeff(filter, var->shown_time);
+		time = var->shown_time;
+	}
 
-	if (filter->duration <= 0)
-		coeff = 1.0f;
-	else if (is_reverse(filter)) 
-		coeff = 1.0f - (elapsed_time / filter->duration);
-	else 
-		coeff = elapsed_time / filter->duration;
+	if (var->bake && !var->retargeted && !use_spring(filter))
+		bake_sample(var->bake, coeff, &result);
+	else
+		eval_variation(filter, coeff, &result);
 
-	if (var->coeff_varaite)
-		coeff = bezier(var->coeff, coeff, 2);
+	if (filter->expr && !var->retargeted)
+		apply_expression(filter, coeff, time, &result);
 
-	order = filter->change_size ? 1 : 0;
-	
-	var->scale.x = bezier(var->scale_x, coeff, order);
-	var->scale.y = bezier(var->scale_y, coeff, order);
+	var->position.x = result.ptr[CURVE_POS_X];
+	var->position.y = result.ptr[CURVE_POS_Y];
+	var->scale.x = result.ptr[CURVE_SCALE_X];
+	var->scale.y = result.ptr[CURVE_SCALE_Y];
+}
 
+/*
+ * Runs on the scheduler's worker pool, so it only computes this frame's
+ * transform and leaves committing it to motion_filter_advance.
+ */
 
-	if (!filter->change_position)
-		order = 0;
-	else if (filter->path_type == PATH_QUADRATIC)
-		order = 2;
-	else if (filter->path_type == PATH_CUBIC)
-		order = 3;
-	else 
-		order = 1;
+static void motion_filter_evaluate(void *data, float seconds)
+{
+	motion_filter_data_t *filter = data;
+	variation_data_t *var = &filter->variation;
+	uint64_t start;
+
+	if (!filter->motion_start)
+		return;
+
+	start = os_gettime_ns();
+
+	// A spring ends once it settles, on the exact end of the path
+	if (use_spring(filter)) {
+		var->done = spring_settled(filter->spring);
+		if (var->done)
+			spring_snap(filter->spring);
+	}
+
+	cal_variation(filter);
 
-	var->position.x = bezier(var->point_x, coeff, order);
-	var->position.y = bezier(var->point_y, coeff, order);
+	if (!use_spring(filter))
+		var->done = var->elapsed_time >= filter->duration;
+
+	var->eval_ns = os_gettime_ns() - start;
+	UNUSED_PARAMETER(seconds);
 }
 
-static void motion_filter_tick(void *data, float seconds)
+/*
+ * Called by the scheduler on the graphics thread for running motions
+ * only. Returns false once the motion is done so the scheduler drops it
+ * from the active set.
+ */
+
+static bool motion_filter_advance(void *data, float seconds)
 {
 	motion_filter_data_t *filter = data;
 	variation_data_t *var = &filter->variation;
+	uint64_t start;
+	bool running = true;
 
-	if (filter->motion_start) {
+	if (!filter->motion_start)
+		return false;
 
-		cal_variation(filter);
-		obs_sceneitem_set_pos(filter->item, &var->position);
-		obs_sceneitem_set_scale(filter->item, &var->scale);
+	start = os_gettime_ns();
+	set_motion_transform(filter, &var->position, &var->scale, var->done);
 
-		if (var->elapsed_time >= filter->duration) {
-			filter->motion_start = false;
-			var->elapsed_time = 0.0f;
-			obs_sceneitem_release(filter->item);
-			filter->motion_end = !filter->motion_end;
-			set_reverse_info(filter);
-		} else
-			var->elapsed_time += seconds;
+	if (var->done) {
+		filter->motion_start = false;
+		var->elapsed_time = 0.0f;
+		obs_sceneitem_release(filter->item);
+		release_spring(filter);
+		filter->motion_end = !filter->motion_end;
+		set_reverse_info(filter);
+		running = start_queued(filter);
+	} else {
+		var->elapsed_time += seconds;
+		filter->stats.active_time += seconds;
 	}
 
+	motion_cost_add(&filter->stats.cost,
+		var->eval_ns + os_gettime_ns() - start);
+	return running;
+}
+
+/*
+ * Runs on the loader thread, see motion-loader.h. Hotkeys and signal
+ * handlers can be registered from any thread, the item is resolved on
+ * the graphics thread.
+ */
+
+static void motion_filter_load(void *data)
+{
+	motion_filter_data_t *filter = data;
+	obs_data_t *settings;
+
+	item_cache_attach(filter, obs_filter_get_parent(filter->context));
+	register_trigger_event(data);
+	settings = obs_source_get_settings(filter->context);
+	motion_filter_save(data, settings);
+	obs_data_release(settings);
+	filter->loaded = true;
+	post_command(filter, COMMAND_RESOLVE);
+}
+
+static void motion_filter_tick(void *data, float seconds)
+{
+	motion_filter_data_t *filter = data;
+
+	// Removed filters still tick, they are loaded again once re-added
+	// and torn down
+	if (filter->initialize || os_atomic_load_bool(&filter->removed) ||
+		!obs_filter_get_parent(filter->context))
+		return;
 
 	//Some APIs are not valid during creation , do initlize in tick loop
-	if (!filter->initialize) {
-		register_trigger_event(data);
-		obs_data_t* settings = obs_source_get_settings(filter->context);
-		motion_filter_save(data, settings);
-		obs_data_release(settings);
-		filter->initialize = true;
-	}
+	motion_loader_add(filter->context, filter);
+	filter->initialize = true;
+	UNUSED_PARAMETER(seconds);
 }
 
 static void *motion_filter_create(obs_data_t *settings, obs_source_t *context)
 {
 	motion_filter_data_t *filter = bzalloc(sizeof(*filter));
+	proc_handler_t *ph = obs_source_get_proc_handler(context);
 	
 	filter->context = context;
 	filter->motion_start = false;
@@ -797,22 +2317,81 @@ static void *motion_filter_create(obs_data_t *settings, obs_source_t *context)
 	filter->path_type = PATH_LINEAR;
 	filter->hotkey_id_f = OBS_INVALID_HOTKEY_ID;
 	filter->hotkey_id_b = OBS_INVALID_HOTKEY_ID;
+	filter->item_id = -1;
+	filter->spring = -1;
+	pthread_mutex_init(&filter->expr_mutex, NULL);
 	get_reverse_info(filter);
 	obs_source_update(context, settings);
+	proc_handler_add(ph, "void get_stats(out int triggers, "
+		"out float active_time, out int setter_calls, "
+		"out int setter_avoided, out int samples, out int avg_ns, "
+		"out int max_ns)", get_stats_proc, filter);
+	proc_handler_add(ph, "void log_stats()", log_stats_proc, filter);
 	return filter;
 }
 
+/*
+ * Runs on the graphics thread once the scheduler dropped the removed
+ * filter. The items are only recovered if the scene the filter was
+ * removed from still exists.
+ */
+
+static void motion_filter_teardown(void *data)
+{
+	motion_filter_data_t *filter = data;
+	obs_source_t *scene = obs_weak_source_get_source(filter->signal_weak);
+
+	if (filter->motion_start) {
+		filter->motion_start = false;
+		filter->variation.elapsed_time = 0.0f;
+		obs_sceneitem_release(filter->item);
+		release_spring(filter);
+	}
+
+	da_resize(filter->queued, 0);
+	if (scene)
+		recover_source(filter);
+	item_cache_detach(filter);
+	release_followers(filter);
+	obs_source_release(scene);
+}
+
 static void motion_filter_remove(void *data, obs_source_t *source)
 {
 	motion_filter_data_t *filter = data;
-	unregister_trigger_event(data);
-	recover_source(filter);
+	motion_scheduler_remove(filter->context, filter, &filter->removed);
+	motion_loader_remove(filter);
+	if (filter->loaded)
+		unregister_trigger_event(data);
+	filter->loaded = false;
+	filter->initialize = false;
 	UNUSED_PARAMETER(source);
 }
 
 static void motion_filter_destroy(void *data)
 {
 	motion_filter_data_t *filter = data;
+
+	// Removed from the scheduler in the middle of a motion
+	if (filter->motion_start)
+		obs_sceneitem_release(filter->item);
+
+	release_spring(filter);
+	release_bake(filter);
+	item_cache_detach(filter);
+	release_followers(filter);
+	free_follower_names(filter);
+	timeline_free(&filter->variation.timeline);
+	da_free(filter->keyframes);
+	da_free(filter->followers);
+	da_free(filter->follower_names);
+	da_free(filter->queued);
+	da_free(filter->cached_followers);
+	da_free(filter->group_scenes);
+	motion_expr_destroy(filter->expr);
+	motion_expr_destroy(filter->pending_expr);
+	pthread_mutex_destroy(&filter->expr_mutex);
+	bfree(filter->expr_text);
 	bfree(filter->item_name);
 	bfree(filter);
 }
@@ -821,6 +2400,10 @@ static void motion_filter_defaults(obs_data_t *settings)
 {
 	obs_data_set_default_bool(settings, S_MOTION_END, false);
 	obs_data_set_default_int(settings, S_MOTION_BEHAVIOR, BEHAVIOR_ROUND_TRIP);
+	obs_data_set_default_int(settings, S_TRIGGER_POLICY, TRIGGER_IGNORE);
+	obs_data_set_default_int(settings, S_TIMING, TIMING_DURATION);
+	obs_data_set_default_double(settings, S_STIFFNESS, 170.0);
+	obs_data_set_default_double(settings, S_DAMPING, 1.0);
 	obs_data_set_default_double(settings, S_DURATION, 1.0);
 }
 
@@ -849,7 +2432,34 @@ struct obs_source_info motion_filter = {
 };
 
 bool obs_module_load(void) {
+	char *preset_path = obs_module_config_path("motion-presets.bin");
+	bool presets = preset_library_init(preset_path);
+
+	bfree(preset_path);
+	if (!presets || !spring_system_init() || !bake_cache_init())
+		return false;
+	if (!motion_scheduler_init(motion_filter_evaluate,
+		motion_filter_advance, motion_filter_execute,
+		motion_filter_teardown))
+		return false;
+	if (!scene_dispatcher_init(scene_switched))
+		return false;
+	if (!motion_loader_init(motion_filter_load))
+		return false;
+
 	obs_register_source(&motion_filter);
+	trace_start("motion-filter");
 	return true;
 }
 
+void obs_module_unload(void)
+{
+	motion_loader_free();
+	scene_dispatcher_free();
+	motion_scheduler_free();
+	spring_system_free();
+	bake_cache_free();
+	preset_library_free();
+	trace_stop();
+}
+
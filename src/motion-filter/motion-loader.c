@@ -0,0 +1,244 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-loader.h"
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+struct load_entry {
+	obs_weak_source_t   *weak;
+	void                *data;
+};
+
+static struct {
+	pthread_t           thread;
+	bool                thread_created;
+	os_sem_t            *wake;
+	pthread_mutex_t     queue_mutex;
+	pthread_mutex_t     work_mutex;
+	DARRAY(struct load_entry) queue;
+	motion_load_t       load;
+	volatile bool       exit;
+	uint64_t            burst_start;
+	uint64_t            burst_end;
+	uint64_t            work_ns;
+	uint64_t            max_batch_ns;
+	size_t              loaded;
+	size_t              batches;
+} loader;
+
+static bool pop_entry(struct load_entry *entry)
+{
+	bool found;
+
+	pthread_mutex_lock(&loader.queue_mutex);
+	found = loader.queue.num > 0;
+	if (found) {
+		*entry = loader.queue.array[0];
+		da_erase(loader.queue, 0);
+	}
+	pthread_mutex_unlock(&loader.queue_mutex);
+	return found;
+}
+
+static void load_entry(struct load_entry *entry)
+{
+	// Destroyed while it was queued
+	obs_source_t *source = obs_weak_source_get_source(entry->weak);
+
+	obs_weak_source_release(entry->weak);
+	if (!source)
+		return;
+
+	loader.load(entry->data);
+	loader.loaded++;
+	obs_source_release(source);
+}
+
+static void report_burst(void)
+{
+	double total, work, longest;
+
+	pthread_mutex_lock(&loader.queue_mutex);
+	if (loader.queue.num || !loader.burst_start) {
+		pthread_mutex_unlock(&loader.queue_mutex);
+		return;
+	}
+
+	total = (double)(loader.burst_end - loader.burst_start) / 1000000.0;
+	loader.burst_start = 0;
+	pthread_mutex_unlock(&loader.queue_mutex);
+
+	work = (double)loader.work_ns / 1000000.0;
+	longest = (double)loader.max_batch_ns / 1000000.0;
+	blog(LOG_INFO, "motion-filter: initialized %u filters in %.2f ms, "
+		"%.2f ms of work in %u batches, longest batch %.2f ms",
+		(unsigned)loader.loaded, total, work, (unsigned)loader.batches,
+		longest);
+
+	loader.work_ns = 0;
+	loader.max_batch_ns = 0;
+	loader.loaded = 0;
+	loader.batches = 0;
+}
+
+/* Returns false once the queue is empty. */
+
+static bool run_batch(void)
+{
+	uint64_t start = os_gettime_ns(), elapsed = 0;
+	struct load_entry entry;
+	bool more = true;
+
+	pthread_mutex_lock(&loader.work_mutex);
+	while (elapsed < LOADER_BUDGET_NS) {
+		more = pop_entry(&entry);
+		if (!more)
+			break;
+
+		load_entry(&entry);
+		elapsed = os_gettime_ns() - start;
+	}
+	pthread_mutex_unlock(&loader.work_mutex);
+
+	if (elapsed) {
+		loader.burst_end = start + elapsed;
+		loader.batches++;
+		loader.work_ns += elapsed;
+		if (elapsed > loader.max_batch_ns)
+			loader.max_batch_ns = elapsed;
+	}
+	return more;
+}
+
+static void *loader_thread(void *data)
+{
+	os_set_thread_name("motion-filter: loader");
+
+	while (os_sem_wait(loader.wake) == 0) {
+		if (os_atomic_load_bool(&loader.exit))
+			break;
+
+		// Let the other threads have the locks between batches
+		while (run_batch() && !os_atomic_load_bool(&loader.exit))
+			os_sleep_ms(LOADER_PAUSE_MS);
+
+		// The filters of a collection start over several ticks
+		if (loader.loaded) {
+			os_sleep_ms(LOADER_SETTLE_MS);
+			report_burst();
+		}
+	}
+
+	UNUSED_PARAMETER(data);
+	return NULL;
+}
+
+/* Without a thread filters are loaded on their first tick as before. */
+
+bool motion_loader_init(motion_load_t load)
+{
+	loader.load = load;
+
+	if (pthread_mutex_init(&loader.queue_mutex, NULL) != 0 ||
+		pthread_mutex_init(&loader.work_mutex, NULL) != 0)
+		return false;
+
+	if (os_sem_init(&loader.wake, 0) == 0 &&
+		pthread_create(&loader.thread, NULL, loader_thread, NULL) == 0) {
+		loader.thread_created = true;
+	} else {
+		blog(LOG_WARNING, "motion-filter: failed to create loader thread");
+		os_sem_destroy(loader.wake);
+		loader.wake = NULL;
+	}
+	return true;
+}
+
+void motion_loader_free(void)
+{
+	size_t i;
+
+	if (loader.thread_created) {
+		os_atomic_set_bool(&loader.exit, true);
+		os_sem_post(loader.wake);
+		pthread_join(loader.thread, NULL);
+		os_sem_destroy(loader.wake);
+	}
+
+	for (i = 0; i < loader.queue.num; i++)
+		obs_weak_source_release(loader.queue.array[i].weak);
+
+	da_free(loader.queue);
+	pthread_mutex_destroy(&loader.queue_mutex);
+	pthread_mutex_destroy(&loader.work_mutex);
+	memset(&loader, 0, sizeof(loader));
+}
+
+void motion_loader_add(obs_source_t *context, void *data)
+{
+	struct load_entry entry;
+
+	if (!loader.thread_created) {
+		pthread_mutex_lock(&loader.work_mutex);
+		loader.load(data);
+		pthread_mutex_unlock(&loader.work_mutex);
+		return;
+	}
+
+	entry.weak = obs_source_get_weak_source(context);
+	entry.data = data;
+
+	pthread_mutex_lock(&loader.queue_mutex);
+	if (!loader.burst_start)
+		loader.burst_start = os_gettime_ns();
+	da_push_back(loader.queue, &entry);
+	pthread_mutex_unlock(&loader.queue_mutex);
+
+	os_sem_post(loader.wake);
+}
+
+void motion_loader_remove(void *data)
+{
+	size_t i;
+
+	pthread_mutex_lock(&loader.work_mutex);
+	pthread_mutex_lock(&loader.queue_mutex);
+	for (i = 0; i < loader.queue.num; i++) {
+		if (loader.queue.array[i].data == data) {
+			obs_weak_source_release(loader.queue.array[i].weak);
+			da_erase(loader.queue, i);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&loader.queue_mutex);
+	pthread_mutex_unlock(&loader.work_mutex);
+}
+
+void motion_loader_lock(void)
+{
+	pthread_mutex_lock(&loader.work_mutex);
+}
+
+void motion_loader_unlock(void)
+{
+	pthread_mutex_unlock(&loader.work_mutex);
+}
@@ -0,0 +1,50 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Deferred filter initialization. Filters queue themselves on their first
+ * tick and a single loader thread registers their hotkeys and signal
+ * handlers in batches, each batch bounded by LOADER_BUDGET_NS so the
+ * libobs hotkey and signal locks are never held for long. Once the queue
+ * stays empty for LOADER_SETTLE_MS the cost of the whole burst, usually
+ * one scene collection, is written to the log.
+ */
+
+#define LOADER_BUDGET_NS    2000000ULL
+#define LOADER_PAUSE_MS     4
+#define LOADER_SETTLE_MS    200
+
+typedef void (*motion_load_t)(void *data);
+
+bool motion_loader_init(motion_load_t load);
+void motion_loader_free(void);
+
+void motion_loader_add(obs_source_t *context, void *data);
+
+/* Drops a queued filter, waits if it is being loaded right now. */
+void motion_loader_remove(void *data);
+
+/* Held while a filter is loaded, for changes racing with the loader. */
+void motion_loader_lock(void);
+void motion_loader_unlock(void);
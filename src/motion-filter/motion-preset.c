@@ -0,0 +1,397 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-preset.h"
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define PRESET_MAGIC        "MPRS"
+
+struct preset_header {
+	char                magic[4];
+	uint32_t            version;
+	uint32_t            record_size;
+	uint32_t            count;
+};
+
+struct preset_stamp {
+	uint32_t            id;
+	long                generation;
+};
+
+struct preset_map {
+	void                *data;
+	size_t              size;
+#ifdef _WIN32
+	HANDLE              mapping;
+#endif
+};
+
+static struct {
+	pthread_mutex_t     mutex;
+	char                *path;
+	struct preset_map   map;
+	DARRAY(struct motion_preset) fallback;
+	DARRAY(struct preset_stamp) stamps;
+	const struct motion_preset *presets;
+	size_t              count;
+	bool                foreign;
+	long                generation;
+} library;
+
+/* Mapping */
+
+#ifdef _WIN32
+
+static bool map_file(struct preset_map *map, const char *path)
+{
+	wchar_t *wpath = NULL;
+	LARGE_INTEGER size;
+	HANDLE file;
+
+	if (!os_utf8_to_wcs_ptr(path, 0, &wpath))
+		return false;
+
+	file = CreateFileW(wpath, GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	bfree(wpath);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	map->mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0,
+		NULL);
+	CloseHandle(file);
+	if (!map->mapping)
+		return false;
+
+	map->data = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!map->data) {
+		CloseHandle(map->mapping);
+		map->mapping = NULL;
+		return false;
+	}
+
+	map->size = (size_t)size.QuadPart;
+	return true;
+}
+
+static void unmap_file(struct preset_map *map)
+{
+	if (map->data)
+		UnmapViewOfFile(map->data);
+	if (map->mapping)
+		CloseHandle(map->mapping);
+	memset(map, 0, sizeof(*map));
+}
+
+#else
+
+static bool map_file(struct preset_map *map, const char *path)
+{
+	struct stat st;
+	void *data;
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+
+	map->data = data;
+	map->size = (size_t)st.st_size;
+	return true;
+}
+
+static void unmap_file(struct preset_map *map)
+{
+	if (map->data)
+		munmap(map->data, map->size);
+	memset(map, 0, sizeof(*map));
+}
+
+#endif
+
+/* Loading */
+
+static bool valid_library(const struct preset_map *map)
+{
+	const struct preset_header *header = map->data;
+	const struct motion_preset *presets;
+	size_t i;
+
+	if (map->size < sizeof(*header) ||
+		memcmp(header->magic, PRESET_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != PRESET_VERSION ||
+		header->record_size != sizeof(struct motion_preset) ||
+		(map->size - sizeof(*header)) / sizeof(struct motion_preset) <
+		header->count)
+		return false;
+
+	// Lookups are binary searches, so ids have to be ascending, and
+	// names go straight into the property list
+	presets = (const struct motion_preset *)(header + 1);
+	for (i = 0; i < header->count; i++) {
+		if (!presets[i].id ||
+			!memchr(presets[i].name, 0, PRESET_NAME_SIZE))
+			return false;
+		if (i && presets[i].id <= presets[i - 1].id)
+			return false;
+	}
+	return true;
+}
+
+static bool load_presets(void)
+{
+	const struct preset_header *header;
+
+	if (!map_file(&library.map, library.path))
+		return false;
+
+	if (!valid_library(&library.map)) {
+		blog(LOG_WARNING, "preset: %s is not a version %d preset library, "
+			"presets stored now are kept for this session only",
+			library.path, PRESET_VERSION);
+		unmap_file(&library.map);
+		library.foreign = true;
+		return false;
+	}
+
+	header = library.map.data;
+	library.presets = (const struct motion_preset *)(header + 1);
+	library.count = header->count;
+	da_free(library.fallback);
+	return true;
+}
+
+static bool write_presets(const struct motion_preset *presets, size_t count)
+{
+	struct preset_header header = { { 0 }, PRESET_VERSION,
+		sizeof(struct motion_preset), (uint32_t)count };
+	struct dstr path = { 0 };
+	const char *slash = strrchr(library.path, '/');
+	FILE *file;
+	bool success;
+
+	if (slash) {
+		dstr_ncopy(&path, library.path, slash - library.path);
+		os_mkdirs(path.array);
+	}
+
+	memcpy(header.magic, PRESET_MAGIC, sizeof(header.magic));
+	dstr_printf(&path, "%s.tmp", library.path);
+
+	file = os_fopen(path.array, "wb");
+	if (!file) {
+		dstr_free(&path);
+		return false;
+	}
+
+	success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(presets, sizeof(*presets), count, file) == count;
+	success = fclose(file) == 0 && success;
+
+	// Windows can not replace a file that is still mapped
+	if (success) {
+		unmap_file(&library.map);
+		success = os_rename(path.array, library.path) == 0;
+	}
+	if (!success)
+		os_unlink(path.array);
+
+	dstr_free(&path);
+	return success;
+}
+
+static const struct motion_preset *find_preset(uint32_t id)
+{
+	size_t low = 0, high = library.count;
+
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		uint32_t mid_id = library.presets[mid].id;
+
+		if (mid_id == id)
+			return &library.presets[mid];
+		if (mid_id < id)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return NULL;
+}
+
+static struct preset_stamp *find_stamp(uint32_t id)
+{
+	size_t i;
+
+	for (i = 0; i < library.stamps.num; i++) {
+		if (library.stamps.array[i].id == id)
+			return &library.stamps.array[i];
+	}
+	return NULL;
+}
+
+static void stamp_preset(uint32_t id)
+{
+	struct preset_stamp *stamp = find_stamp(id);
+
+	if (!stamp) {
+		stamp = da_push_back_new(library.stamps);
+		stamp->id = id;
+	}
+	stamp->generation = ++library.generation;
+}
+
+bool preset_library_init(const char *path)
+{
+	if (pthread_mutex_init(&library.mutex, NULL) != 0)
+		return false;
+
+	// Without a config directory presets only last for the session
+	library.foreign = !path;
+	library.path = bstrdup(path);
+	if (path && load_presets())
+		blog(LOG_INFO, "preset: %u presets mapped from %s",
+			(unsigned)library.count, path);
+	return true;
+}
+
+void preset_library_free(void)
+{
+	unmap_file(&library.map);
+	da_free(library.fallback);
+	da_free(library.stamps);
+	bfree(library.path);
+	pthread_mutex_destroy(&library.mutex);
+	memset(&library, 0, sizeof(library));
+}
+
+bool preset_get(uint32_t id, struct motion_preset *preset)
+{
+	const struct motion_preset *found;
+
+	pthread_mutex_lock(&library.mutex);
+	found = find_preset(id);
+	if (found)
+		*preset = *found;
+	pthread_mutex_unlock(&library.mutex);
+	return found != NULL;
+}
+
+uint32_t preset_store(const char *name, const struct preset_values *values)
+{
+	DARRAY(struct motion_preset) presets = { 0 };
+	struct motion_preset preset = { 0 };
+	size_t i;
+
+	if (!name || !*name || !values)
+		return 0;
+
+	strncpy(preset.name, name, PRESET_NAME_SIZE - 1);
+	preset.values = *values;
+
+	pthread_mutex_lock(&library.mutex);
+	da_push_back_array(presets, library.presets, library.count);
+
+	for (i = 0; i < presets.num; i++) {
+		if (strcmp(presets.array[i].name, preset.name) == 0)
+			break;
+	}
+
+	if (i < presets.num) {
+		preset.id = presets.array[i].id;
+		presets.array[i] = preset;
+	} else {
+		preset.id = presets.num ? presets.array[presets.num - 1].id + 1 : 1;
+		if (!preset.id) {
+			// Ids are ascending and 0 means none, the range is used up
+			pthread_mutex_unlock(&library.mutex);
+			da_free(presets);
+			return 0;
+		}
+		da_push_back(presets, &preset);
+	}
+
+	// Still usable for this session when the file can not be written,
+	// a library of another version is never overwritten
+	if (library.foreign || !write_presets(presets.array, presets.num) ||
+		!load_presets()) {
+		if (!library.foreign)
+			blog(LOG_WARNING, "preset: failed to write %s",
+				library.path);
+		unmap_file(&library.map);
+		da_move(library.fallback, presets);
+		library.presets = library.fallback.array;
+		library.count = library.fallback.num;
+	}
+
+	da_free(presets);
+	stamp_preset(preset.id);
+	pthread_mutex_unlock(&library.mutex);
+	return preset.id;
+}
+
+void preset_enum(preset_enum_t callback, void *param)
+{
+	size_t i;
+
+	pthread_mutex_lock(&library.mutex);
+	for (i = 0; i < library.count; i++)
+		callback(param, &library.presets[i]);
+	pthread_mutex_unlock(&library.mutex);
+}
+
+long preset_generation(uint32_t id)
+{
+	struct preset_stamp *stamp;
+	long generation;
+
+	pthread_mutex_lock(&library.mutex);
+	stamp = find_stamp(id);
+	generation = stamp ? stamp->generation : 0;
+	pthread_mutex_unlock(&library.mutex);
+	return generation;
+}
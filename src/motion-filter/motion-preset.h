@@ -0,0 +1,96 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Shared motion presets. The library is one binary file in the module
+ * config directory, mapped read only at load:
+ *
+ *   header   "MPRS" u32 version, u32 record size, u32 count
+ *   record   u32 id, char name[64], struct preset_values
+ *
+ * Records are fixed size and sorted by id, a lookup is a binary search
+ * on the mapping and nothing is parsed. Storing a preset rewrites the
+ * file and maps it again, then bumps the generation of that preset so
+ * the filters referencing it apply it once more. Generations only live
+ * for the session.
+ */
+
+#define PRESET_VERSION      1
+#define PRESET_NAME_SIZE    64
+
+/* The motion settings a preset carries, see read_preset_settings. */
+
+struct preset_values {
+	int32_t             path_type;
+	int32_t             variation_type;
+	int32_t             trigger_policy;
+	int32_t             timing;
+	int32_t             start_x;
+	int32_t             start_y;
+	int32_t             start_w;
+	int32_t             start_h;
+	int32_t             ctrl_x;
+	int32_t             ctrl_y;
+	int32_t             ctrl2_x;
+	int32_t             ctrl2_y;
+	int32_t             dst_x;
+	int32_t             dst_y;
+	int32_t             dst_w;
+	int32_t             dst_h;
+	float               duration;
+	float               acceleration;
+	float               stiffness;
+	float               damping;
+	float               epsilon;
+	uint8_t             use_start;
+	uint8_t             constant_speed;
+	uint8_t             baked;
+	uint8_t             pixel_snap;
+};
+
+struct motion_preset {
+	uint32_t            id;
+	char                name[PRESET_NAME_SIZE];
+	struct preset_values values;
+};
+
+typedef void (*preset_enum_t)(void *param, const struct motion_preset *preset);
+
+bool preset_library_init(const char *path);
+void preset_library_free(void);
+
+/* Copies the preset out, the mapping may change after the call. */
+bool preset_get(uint32_t id, struct motion_preset *preset);
+
+/*
+ * Adds or replaces the preset with this name, returns its id, or 0 for an
+ * empty name or when no id is left. A library that can not be written
+ * keeps the preset in memory for the session and still returns the id.
+ */
+uint32_t preset_store(const char *name, const struct preset_values *values);
+
+void preset_enum(preset_enum_t callback, void *param);
+
+/* When the preset was last stored this session, 0 if it was not. */
+long preset_generation(uint32_t id);
@@ -0,0 +1,442 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-scheduler.h"
+#include <util/darray.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include "../trace.h"
+#include "../worker-pool.h"
+#include "motion-spring.h"
+
+#define COMMAND_RING_SIZE   1024
+#define COMMAND_RING_MASK   (COMMAND_RING_SIZE - 1)
+#define EVALUATE_CHUNK      16
+
+struct motion_entry {
+	obs_source_t        *context;
+	void                *data;
+};
+
+struct motion_removal {
+	obs_source_t        *context;
+	void                *data;
+	volatile bool       *removed;
+};
+
+struct motion_command {
+	obs_weak_source_t   *context;
+	void                *data;
+	volatile bool       *removed;
+	int                 command;
+};
+
+/*
+ * Bounded multi producer ring. A cell is free for the producer holding
+ * position pos when its sequence equals pos, and ready for the consumer
+ * when it equals pos + 1.
+ */
+
+struct command_cell {
+	volatile long       sequence;
+	struct motion_command command;
+};
+
+struct motion_scheduler {
+	DARRAY(struct motion_entry) active;
+	DARRAY(struct motion_entry) pending;
+	DARRAY(struct motion_removal) removed;
+	DARRAY(struct motion_removal) teardown;
+	DARRAY(obs_source_t *) released;
+	pthread_mutex_t     mutex;
+	motion_evaluate_t   evaluate;
+	motion_advance_t    advance;
+	motion_execute_t    execute;
+	motion_remove_t     remove;
+	struct worker_pool  *pool;
+	float               seconds;
+	struct command_cell commands[COMMAND_RING_SIZE];
+	volatile long       post_pos;
+	long                drain_pos;
+	struct motion_scheduler_stats stats;
+	bool                initialized;
+};
+
+static struct motion_scheduler scheduler;
+
+static const char *tick_name = "motion_scheduler_tick";
+
+static size_t find_entry(struct motion_entry *array, size_t num, void *data)
+{
+	size_t i;
+	for (i = 0; i < num; i++) {
+		if (array[i].data == data)
+			return i;
+	}
+	return DARRAY_INVALID;
+}
+
+/*
+ * Dropping the last filter reference destroys the filter, which calls
+ * back into the scheduler, so references are only released unlocked.
+ */
+
+static void remove_active(size_t idx)
+{
+	da_push_back(scheduler.released, &scheduler.active.array[idx].context);
+	scheduler.active.array[idx] =
+		scheduler.active.array[scheduler.active.num - 1];
+	da_pop_back(scheduler.active);
+}
+
+static void release_removed(void)
+{
+	size_t i;
+
+	for (i = 0; i < scheduler.released.num; i++)
+		obs_source_release(scheduler.released.array[i]);
+
+	da_resize(scheduler.released, 0);
+}
+
+/*
+ * Removed filters are torn down unlocked as well, the remove callback
+ * goes through libobs.
+ */
+
+static void teardown_removed(void)
+{
+	size_t i;
+
+	for (i = 0; i < scheduler.teardown.num; i++) {
+		struct motion_removal *removal = &scheduler.teardown.array[i];
+
+		scheduler.remove(removal->data);
+		os_atomic_set_bool(removal->removed, false);
+		da_push_back(scheduler.released, &removal->context);
+	}
+
+	da_resize(scheduler.teardown, 0);
+}
+
+/* Pick up entries posted by the hotkey, UI and frontend threads. */
+
+static void merge_pending(void)
+{
+	size_t i, idx;
+
+	pthread_mutex_lock(&scheduler.mutex);
+
+	for (i = 0; i < scheduler.removed.num; i++) {
+		struct motion_removal *removal = &scheduler.removed.array[i];
+		idx = find_entry(scheduler.active.array, scheduler.active.num,
+			removal->data);
+		if (idx != DARRAY_INVALID)
+			remove_active(idx);
+	}
+	da_move(scheduler.teardown, scheduler.removed);
+
+	for (i = 0; i < scheduler.pending.num; i++) {
+		struct motion_entry *entry = &scheduler.pending.array[i];
+		idx = find_entry(scheduler.active.array, scheduler.active.num,
+			entry->data);
+		if (idx == DARRAY_INVALID)
+			da_push_back(scheduler.active, entry);
+		else
+			da_push_back(scheduler.released, &entry->context);
+	}
+
+	da_resize(scheduler.pending, 0);
+
+	pthread_mutex_unlock(&scheduler.mutex);
+
+	teardown_removed();
+	release_removed();
+}
+
+/* Positions wrap around, only their difference is meaningful. */
+
+static inline long seq_diff(long a, long b)
+{
+	return (long)((unsigned long)a - (unsigned long)b);
+}
+
+static inline long seq_next(long pos, long n)
+{
+	return (long)((unsigned long)pos + (unsigned long)n);
+}
+
+static bool take_command(struct motion_command *command)
+{
+	struct command_cell *cell =
+		&scheduler.commands[scheduler.drain_pos & COMMAND_RING_MASK];
+	long sequence = os_atomic_load_long(&cell->sequence);
+
+	if (seq_diff(sequence, seq_next(scheduler.drain_pos, 1)) != 0)
+		return false;
+
+	*command = cell->command;
+	os_atomic_set_long(&cell->sequence,
+		seq_next(scheduler.drain_pos, COMMAND_RING_SIZE));
+	scheduler.drain_pos = seq_next(scheduler.drain_pos, 1);
+	return true;
+}
+
+static void drain_commands(void)
+{
+	struct motion_command command;
+
+	while (take_command(&command)) {
+		obs_source_t *context =
+			obs_weak_source_get_source(command.context);
+
+		obs_weak_source_release(command.context);
+		if (!context)
+			continue;
+
+		// Posted before the filter was removed, the remove wins
+		if (os_atomic_load_bool(command.removed)) {
+			da_push_back(scheduler.released, &context);
+			continue;
+		}
+
+		scheduler.execute(command.data, command.command);
+		da_push_back(scheduler.released, &context);
+	}
+
+	release_removed();
+}
+
+static void log_idle_stats(void)
+{
+	struct motion_scheduler_stats *stats = &scheduler.stats;
+
+	if (!stats->passes)
+		return;
+
+	blog(LOG_DEBUG, "motion-filter: scheduler idle, peak %d active, "
+		"avg pass %.3f ms, max pass %.3f ms",
+		(int)stats->peak_active,
+		(double)stats->total_pass_ns / stats->passes / 1000000.0,
+		(double)stats->max_pass_ns / 1000000.0);
+}
+
+static void evaluate_range(void *param, size_t begin, size_t end)
+{
+	struct motion_entry *entries = scheduler.active.array;
+	size_t i;
+
+	for (i = begin; i < end; i++)
+		scheduler.evaluate(entries[i].data, scheduler.seconds);
+
+	UNUSED_PARAMETER(param);
+}
+
+static void motion_scheduler_tick(void *param, float seconds)
+{
+	struct motion_scheduler_stats *stats = &scheduler.stats;
+	uint64_t start, elapsed;
+	size_t count, i = 0;
+
+	drain_commands();
+	merge_pending();
+	trace_frame(seconds);
+
+	count = scheduler.active.num;
+	if (!count)
+		return;
+
+	profile_start(tick_name);
+	start = os_gettime_ns();
+
+	// Springs move in one pass before the motions read them
+	spring_step(seconds);
+
+	scheduler.seconds = seconds;
+	worker_pool_run(scheduler.pool, evaluate_range, NULL,
+		scheduler.active.num, EVALUATE_CHUNK);
+
+	while (i < scheduler.active.num) {
+		struct motion_entry *entry = &scheduler.active.array[i];
+		if (scheduler.advance(entry->data, seconds))
+			i++;
+		else
+			remove_active(i);
+	}
+
+	elapsed = os_gettime_ns() - start;
+	profile_end(tick_name);
+	release_removed();
+
+	pthread_mutex_lock(&scheduler.mutex);
+	stats->active = scheduler.active.num;
+	if (count > stats->peak_active)
+		stats->peak_active = count;
+	stats->passes++;
+	stats->last_pass_ns = elapsed;
+	stats->total_pass_ns += elapsed;
+	if (elapsed > stats->max_pass_ns)
+		stats->max_pass_ns = elapsed;
+	pthread_mutex_unlock(&scheduler.mutex);
+
+	if (!scheduler.active.num)
+		log_idle_stats();
+
+	UNUSED_PARAMETER(param);
+}
+
+bool motion_scheduler_init(motion_evaluate_t evaluate,
+	motion_advance_t advance, motion_execute_t execute,
+	motion_remove_t remove)
+{
+	long i;
+
+	if (pthread_mutex_init(&scheduler.mutex, NULL) != 0)
+		return false;
+
+	for (i = 0; i < COMMAND_RING_SIZE; i++)
+		scheduler.commands[i].sequence = i;
+
+	scheduler.post_pos = 0;
+	scheduler.drain_pos = 0;
+	scheduler.evaluate = evaluate;
+	scheduler.advance = advance;
+	scheduler.execute = execute;
+	scheduler.remove = remove;
+	scheduler.pool = worker_pool_create("motion-filter");
+	scheduler.initialized = true;
+	obs_add_tick_callback(motion_scheduler_tick, NULL);
+	return true;
+}
+
+void motion_scheduler_free(void)
+{
+	struct motion_command command;
+	size_t i;
+
+	if (!scheduler.initialized)
+		return;
+
+	obs_remove_tick_callback(motion_scheduler_tick, NULL);
+	worker_pool_destroy(scheduler.pool);
+	scheduler.pool = NULL;
+
+	while (take_command(&command))
+		obs_weak_source_release(command.context);
+
+	for (i = 0; i < scheduler.active.num; i++)
+		obs_source_release(scheduler.active.array[i].context);
+	for (i = 0; i < scheduler.pending.num; i++)
+		obs_source_release(scheduler.pending.array[i].context);
+	// No tick runs anymore, filters removed since the last one are
+	// torn down here
+	for (i = 0; i < scheduler.removed.num; i++) {
+		scheduler.remove(scheduler.removed.array[i].data);
+		obs_source_release(scheduler.removed.array[i].context);
+	}
+
+	da_free(scheduler.active);
+	da_free(scheduler.pending);
+	da_free(scheduler.removed);
+	da_free(scheduler.teardown);
+	da_free(scheduler.released);
+	pthread_mutex_destroy(&scheduler.mutex);
+	scheduler.initialized = false;
+}
+
+void motion_scheduler_add(obs_source_t *context, void *data)
+{
+	struct motion_entry entry = { context, data };
+	size_t idx;
+
+	obs_source_addref(context);
+
+	pthread_mutex_lock(&scheduler.mutex);
+	idx = find_entry(scheduler.pending.array, scheduler.pending.num, data);
+	if (idx == DARRAY_INVALID)
+		da_push_back(scheduler.pending, &entry);
+	pthread_mutex_unlock(&scheduler.mutex);
+
+	if (idx != DARRAY_INVALID)
+		obs_source_release(context);
+}
+
+bool motion_scheduler_post(obs_source_t *context, void *data,
+	volatile bool *removed, int command)
+{
+	long pos = os_atomic_load_long(&scheduler.post_pos);
+	struct command_cell *cell;
+
+	for (;;) {
+		long diff;
+
+		cell = &scheduler.commands[pos & COMMAND_RING_MASK];
+		diff = seq_diff(os_atomic_load_long(&cell->sequence), pos);
+
+		if (diff == 0 && os_atomic_compare_swap_long(
+			&scheduler.post_pos, pos, seq_next(pos, 1)))
+			break;
+
+		if (diff < 0) {
+			blog(LOG_WARNING, "motion-filter: command queue full, "
+				"dropping command %d", command);
+			return false;
+		}
+
+		pos = os_atomic_load_long(&scheduler.post_pos);
+	}
+
+	cell->command.context = obs_source_get_weak_source(context);
+	cell->command.data = data;
+	cell->command.removed = removed;
+	cell->command.command = command;
+	os_atomic_set_long(&cell->sequence, seq_next(pos, 1));
+	return true;
+}
+
+void motion_scheduler_remove(obs_source_t *context, void *data,
+	volatile bool *removed)
+{
+	struct motion_removal removal = { context, data, removed };
+	obs_source_t *pending = NULL;
+	size_t idx;
+
+	obs_source_addref(context);
+	os_atomic_set_bool(removed, true);
+
+	pthread_mutex_lock(&scheduler.mutex);
+	idx = find_entry(scheduler.pending.array, scheduler.pending.num, data);
+	if (idx != DARRAY_INVALID) {
+		pending = scheduler.pending.array[idx].context;
+		da_erase(scheduler.pending, idx);
+	}
+	da_push_back(scheduler.removed, &removal);
+	pthread_mutex_unlock(&scheduler.mutex);
+
+	obs_source_release(pending);
+}
+
+void motion_scheduler_get_stats(struct motion_scheduler_stats *stats)
+{
+	pthread_mutex_lock(&scheduler.mutex);
+	*stats = scheduler.stats;
+	pthread_mutex_unlock(&scheduler.mutex);
+}
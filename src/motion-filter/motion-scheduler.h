@@ -0,0 +1,77 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Module wide scheduler that advances every running motion in one pass
+ * per video tick. A motion stays in the active set until its advance
+ * callback returns false, and holds a reference to its filter until then.
+ *
+ * Every pass first runs the evaluate callback of all active motions on a
+ * worker pool, then advance on the graphics thread one by one. Evaluate
+ * must only touch the motion's own state, everything that goes through
+ * libobs belongs in advance.
+ */
+
+typedef void (*motion_evaluate_t)(void *data, float seconds);
+typedef bool (*motion_advance_t)(void *data, float seconds);
+typedef void (*motion_execute_t)(void *data, int command);
+typedef void (*motion_remove_t)(void *data);
+
+struct motion_scheduler_stats {
+	size_t              active;
+	size_t              peak_active;
+	uint64_t            passes;
+	uint64_t            last_pass_ns;
+	uint64_t            max_pass_ns;
+	uint64_t            total_pass_ns;
+};
+
+bool motion_scheduler_init(motion_evaluate_t evaluate,
+	motion_advance_t advance, motion_execute_t execute,
+	motion_remove_t remove);
+void motion_scheduler_free(void);
+
+void motion_scheduler_add(obs_source_t *context, void *data);
+
+/*
+ * Takes a filter out of the scheduler from any thread. *removed is set
+ * at once, and the filter leaves the active set at the start of the next
+ * tick, where the remove callback tears it down on the graphics thread
+ * with a reference held. *removed is cleared after that.
+ */
+void motion_scheduler_remove(obs_source_t *context, void *data,
+	volatile bool *removed);
+
+/*
+ * Hotkey, UI and frontend threads never touch a filter's motion state,
+ * they post a command instead. Commands go through a lock-free ring and
+ * are executed on the graphics thread at the start of the next tick, in
+ * the order they were posted. A command for a filter destroyed before
+ * then, or whose *removed flag is set when it runs, is dropped. Returns
+ * false if the ring is full.
+ */
+bool motion_scheduler_post(obs_source_t *context, void *data,
+	volatile bool *removed, int command);
+
+void motion_scheduler_get_stats(struct motion_scheduler_stats *stats);
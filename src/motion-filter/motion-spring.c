@@ -0,0 +1,182 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-spring.h"
+#include <math.h>
+#include <util/darray.h>
+#include <util/threading.h>
+
+static struct {
+	DARRAY(float)       x;
+	DARRAY(float)       v;
+	DARRAY(float)       target;
+	DARRAY(float)       stiffness;
+	DARRAY(float)       damping;
+	DARRAY(int)         free_slots;
+	size_t              live;
+	float               accumulator;
+	pthread_mutex_t     mutex;
+} springs;
+
+bool spring_system_init(void)
+{
+	return pthread_mutex_init(&springs.mutex, NULL) == 0;
+}
+
+void spring_system_free(void)
+{
+	da_free(springs.x);
+	da_free(springs.v);
+	da_free(springs.target);
+	da_free(springs.stiffness);
+	da_free(springs.damping);
+	da_free(springs.free_slots);
+	pthread_mutex_destroy(&springs.mutex);
+}
+
+int spring_alloc(void)
+{
+	int slot;
+
+	pthread_mutex_lock(&springs.mutex);
+
+	if (springs.free_slots.num) {
+		slot = springs.free_slots.array[springs.free_slots.num - 1];
+		da_pop_back(springs.free_slots);
+	} else {
+		slot = (int)springs.x.num;
+		da_push_back_new(springs.x);
+		da_push_back_new(springs.v);
+		da_push_back_new(springs.target);
+		da_push_back_new(springs.stiffness);
+		da_push_back_new(springs.damping);
+	}
+
+	springs.live++;
+	pthread_mutex_unlock(&springs.mutex);
+	return slot;
+}
+
+void spring_free(int slot)
+{
+	if (slot < 0)
+		return;
+
+	pthread_mutex_lock(&springs.mutex);
+	springs.v.array[slot] = 0.0f;
+	springs.stiffness.array[slot] = 0.0f;
+	springs.damping.array[slot] = 0.0f;
+	da_push_back(springs.free_slots, &slot);
+	springs.live--;
+	pthread_mutex_unlock(&springs.mutex);
+}
+
+void spring_set(int slot, float x, float v, float target, float stiffness,
+	float damping)
+{
+	pthread_mutex_lock(&springs.mutex);
+	springs.x.array[slot] = x;
+	springs.v.array[slot] = v;
+	springs.target.array[slot] = target;
+	springs.stiffness.array[slot] = stiffness;
+	// Stored as the damping coefficient the integration uses
+	springs.damping.array[slot] = 2.0f * damping * sqrtf(stiffness);
+	pthread_mutex_unlock(&springs.mutex);
+}
+
+void spring_set_target(int slot, float target)
+{
+	pthread_mutex_lock(&springs.mutex);
+	springs.target.array[slot] = target;
+	pthread_mutex_unlock(&springs.mutex);
+}
+
+float spring_position(int slot)
+{
+	return springs.x.array[slot];
+}
+
+float spring_velocity(int slot)
+{
+	return springs.v.array[slot];
+}
+
+bool spring_settled(int slot)
+{
+	return fabsf(springs.x.array[slot] - springs.target.array[slot]) <
+		SPRING_EPSILON && fabsf(springs.v.array[slot]) < SPRING_EPSILON;
+}
+
+void spring_snap(int slot)
+{
+	pthread_mutex_lock(&springs.mutex);
+	springs.x.array[slot] = springs.target.array[slot];
+	springs.v.array[slot] = 0.0f;
+	pthread_mutex_unlock(&springs.mutex);
+}
+
+/*
+ * Semi-implicit Euler, stable as long as the substep times the square
+ * root of the stiffness stays well below 2.
+ */
+
+static void integrate(size_t num, int steps)
+{
+	float *x = springs.x.array;
+	float *v = springs.v.array;
+	float *target = springs.target.array;
+	float *stiffness = springs.stiffness.array;
+	float *damping = springs.damping.array;
+	const float h = SPRING_SUBSTEP;
+	size_t i;
+
+	while (steps--) {
+		for (i = 0; i < num; i++) {
+			float a = stiffness[i] * (target[i] - x[i]) -
+				damping[i] * v[i];
+			v[i] += a * h;
+			x[i] += v[i] * h;
+		}
+	}
+}
+
+void spring_step(float seconds)
+{
+	int steps;
+
+	pthread_mutex_lock(&springs.mutex);
+
+	if (!springs.live) {
+		springs.accumulator = 0.0f;
+		pthread_mutex_unlock(&springs.mutex);
+		return;
+	}
+
+	springs.accumulator += seconds;
+	steps = (int)(springs.accumulator / SPRING_SUBSTEP);
+	springs.accumulator -= (float)steps * SPRING_SUBSTEP;
+
+	// A long stall is not worth catching up on
+	if (steps > SPRING_MAX_STEPS)
+		steps = SPRING_MAX_STEPS;
+
+	integrate(springs.x.num, steps);
+	pthread_mutex_unlock(&springs.mutex);
+}
@@ -0,0 +1,52 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Damped springs on path progress. All springs are integrated together
+ * on a fixed substep, so the result does not depend on the tick rate and
+ * the pass runs over plain float arrays. A slot keeps its index while in
+ * use, free slots have no stiffness and stay where they are.
+ */
+
+#define SPRING_SUBSTEP      (1.0f / 240.0f)
+#define SPRING_MAX_STEPS    240
+#define SPRING_EPSILON      0.0005f
+
+bool spring_system_init(void);
+void spring_system_free(void);
+
+int spring_alloc(void);
+void spring_free(int slot);
+
+/* damping is the damping ratio, 1 is critically damped */
+void spring_set(int slot, float x, float v, float target, float stiffness,
+	float damping);
+void spring_set_target(int slot, float target);
+
+float spring_position(int slot);
+float spring_velocity(int slot);
+bool spring_settled(int slot);
+void spring_snap(int slot);
+
+void spring_step(float seconds);
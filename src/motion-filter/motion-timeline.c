@@ -0,0 +1,118 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "motion-timeline.h"
+
+void timeline_free(struct motion_timeline *timeline)
+{
+	da_free(timeline->segments);
+}
+
+void timeline_reset(struct motion_timeline *timeline, const struct vec4 *origin)
+{
+	da_resize(timeline->segments, 0);
+	vec4_copy(&timeline->origin, origin);
+	timeline->cursor = 0;
+	timeline->duration = 0.0f;
+}
+
+void timeline_add_segment(struct motion_timeline *timeline, float start,
+	float end, const struct vec4 *from, const struct vec4 *to,
+	float easing)
+{
+	struct timeline_segment *seg = da_push_back_new(timeline->segments);
+	int i;
+
+	seg->start = start;
+	seg->end = end;
+	seg->inv_length = end > start ? 1.0f / (end - start) : 0.0f;
+
+	curve_init(&seg->curve);
+	for (i = 0; i < 4; i++) {
+		float point[2] = { from->ptr[i], to->ptr[i] };
+		curve_set_channel(&seg->curve, i, point, 1);
+	}
+
+	// Same easing control point as the acceleration setting
+	seg->eased = easing != 0.0f;
+	if (seg->eased) {
+		float point[3] = { 0.0f, (1.0f - easing) / 2.0f, 1.0f };
+		bezier_to_poly(point, 2, seg->ease_poly);
+	}
+
+	if (end > timeline->duration)
+		timeline->duration = end;
+}
+
+/* Last segment starting at or before time. */
+
+static size_t find_segment(struct motion_timeline *timeline, float time)
+{
+	struct timeline_segment *array = timeline->segments.array;
+	size_t num = timeline->segments.num;
+	size_t cur = timeline->cursor;
+	size_t low = 0, high = num;
+
+	// Playback moves forward, so the cached segment or the next one
+	// almost always matches
+	if (cur < num && array[cur].start <= time) {
+		if (cur + 1 == num || time < array[cur + 1].start)
+			return cur;
+		if (cur + 2 == num || time < array[cur + 2].start)
+			return cur + 1;
+	}
+
+	while (high - low > 1) {
+		size_t mid = (low + high) / 2;
+		if (array[mid].start <= time)
+			low = mid;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+void timeline_eval(struct motion_timeline *timeline, float time,
+	struct vec4 *result)
+{
+	struct timeline_segment *seg;
+	float t;
+
+	if (!timeline->segments.num) {
+		vec4_copy(result, &timeline->origin);
+		return;
+	}
+
+	timeline->cursor = find_segment(timeline, time);
+	seg = &timeline->segments.array[timeline->cursor];
+
+	if (time >= seg->end)
+		t = 1.0f;
+	else if (time <= seg->start)
+		t = 0.0f;
+	else
+		t = (time - seg->start) * seg->inv_length;
+
+	if (seg->eased)
+		t = poly_eval(seg->ease_poly, 2, t);
+
+	curve_eval(&seg->curve, t, result);
+}
@@ -0,0 +1,57 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <util/darray.h>
+#include "../curve.h"
+
+/*
+ * A chain of keyframe segments sharing the curve lane layout. Segment
+ * coefficients are built when the motion starts, evaluation only finds
+ * the segment and runs one horner pass.
+ */
+
+struct timeline_segment {
+	float               start;
+	float               end;
+	float               inv_length;
+	float               ease_poly[CURVE_MAX_ORDER + 1];
+	bool                eased;
+	struct curve        curve;
+};
+
+struct motion_timeline {
+	DARRAY(struct timeline_segment) segments;
+	struct vec4         origin;
+	size_t              cursor;
+	float               duration;
+};
+
+void timeline_free(struct motion_timeline *timeline);
+
+void timeline_reset(struct motion_timeline *timeline, const struct vec4 *origin);
+
+void timeline_add_segment(struct motion_timeline *timeline, float start,
+	float end, const struct vec4 *from, const struct vec4 *to,
+	float easing);
+
+void timeline_eval(struct motion_timeline *timeline, float time,
+	struct vec4 *result);
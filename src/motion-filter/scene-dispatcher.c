@@ -0,0 +1,173 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "scene-dispatcher.h"
+#include <util/darray.h>
+#include <util/threading.h>
+
+struct scene_entry {
+	obs_source_t        *scene;
+	DARRAY(void *)      filters;
+};
+
+struct scene_dispatcher {
+	DARRAY(struct scene_entry *) scenes;
+	pthread_mutex_t     mutex;
+	scene_switch_t      callback;
+	bool                initialized;
+};
+
+static struct scene_dispatcher dispatcher;
+
+static void dispatch(struct scene_entry *entry, bool active)
+{
+	size_t i;
+
+	pthread_mutex_lock(&dispatcher.mutex);
+	for (i = 0; i < entry->filters.num; i++)
+		dispatcher.callback(entry->filters.array[i], active);
+	pthread_mutex_unlock(&dispatcher.mutex);
+}
+
+static void scene_activate(void *data, calldata_t *cd)
+{
+	dispatch(data, true);
+	UNUSED_PARAMETER(cd);
+}
+
+static void scene_deactivate(void *data, calldata_t *cd)
+{
+	dispatch(data, false);
+	UNUSED_PARAMETER(cd);
+}
+
+static void connect_entry(struct scene_entry *entry, bool connect)
+{
+	signal_handler_t *sh = obs_source_get_signal_handler(entry->scene);
+
+	if (connect) {
+		signal_handler_connect(sh, "activate", scene_activate, entry);
+		signal_handler_connect(sh, "deactivate", scene_deactivate, entry);
+	} else {
+		signal_handler_disconnect(sh, "activate", scene_activate, entry);
+		signal_handler_disconnect(sh, "deactivate", scene_deactivate,
+			entry);
+	}
+}
+
+static size_t find_scene(obs_source_t *scene)
+{
+	size_t i;
+	for (i = 0; i < dispatcher.scenes.num; i++) {
+		if (dispatcher.scenes.array[i]->scene == scene)
+			return i;
+	}
+	return DARRAY_INVALID;
+}
+
+bool scene_dispatcher_init(scene_switch_t callback)
+{
+	if (pthread_mutex_init(&dispatcher.mutex, NULL) != 0)
+		return false;
+
+	dispatcher.callback = callback;
+	dispatcher.initialized = true;
+	return true;
+}
+
+void scene_dispatcher_free(void)
+{
+	size_t i;
+
+	if (!dispatcher.initialized)
+		return;
+
+	for (i = 0; i < dispatcher.scenes.num; i++) {
+		struct scene_entry *entry = dispatcher.scenes.array[i];
+		connect_entry(entry, false);
+		da_free(entry->filters);
+		bfree(entry);
+	}
+
+	da_free(dispatcher.scenes);
+	pthread_mutex_destroy(&dispatcher.mutex);
+	dispatcher.initialized = false;
+}
+
+void scene_dispatcher_add(obs_source_t *scene, void *data)
+{
+	struct scene_entry *entry, *created = NULL;
+	size_t idx;
+
+	if (!scene)
+		return;
+
+	pthread_mutex_lock(&dispatcher.mutex);
+
+	idx = find_scene(scene);
+	if (idx == DARRAY_INVALID) {
+		entry = created = bzalloc(sizeof(*entry));
+		entry->scene = scene;
+		da_push_back(dispatcher.scenes, &entry);
+	} else {
+		entry = dispatcher.scenes.array[idx];
+	}
+
+	if (da_find(entry->filters, &data, 0) == DARRAY_INVALID)
+		da_push_back(entry->filters, &data);
+
+	pthread_mutex_unlock(&dispatcher.mutex);
+
+	if (created)
+		connect_entry(created, true);
+}
+
+/*
+ * The signal handler lock is held while a signal is dispatched, so
+ * signals are only connected and disconnected without the dispatcher lock.
+ */
+
+void scene_dispatcher_remove(obs_source_t *scene, void *data)
+{
+	struct scene_entry *entry = NULL;
+	size_t idx;
+
+	if (!scene)
+		return;
+
+	pthread_mutex_lock(&dispatcher.mutex);
+	idx = find_scene(scene);
+	if (idx != DARRAY_INVALID) {
+		entry = dispatcher.scenes.array[idx];
+		da_erase_item(entry->filters, &data);
+
+		if (entry->filters.num)
+			entry = NULL;
+		else
+			da_erase(dispatcher.scenes, idx);
+	}
+	pthread_mutex_unlock(&dispatcher.mutex);
+
+	if (entry) {
+		connect_entry(entry, false);
+		da_free(entry->filters);
+		bfree(entry);
+	}
+}
@@ -0,0 +1,37 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Routes the activate and deactivate signals of a scene to the filters
+ * that trigger on scene switch, so a switch only touches the filters of
+ * the scenes involved.
+ */
+
+typedef void (*scene_switch_t)(void *data, bool active);
+
+bool scene_dispatcher_init(scene_switch_t callback);
+void scene_dispatcher_free(void);
+
+void scene_dispatcher_add(obs_source_t *scene, void *data);
+void scene_dispatcher_remove(obs_source_t *scene, void *data);
@@ -20,89 +20,419 @@
 
 #include "obs-module.h"
 #include "../helper.h"
+#include "../trace.h"
+#include "../worker-pool.h"
 #include <obs-scene.h>
+#include <obs-frontend-api.h>
+#include <util/darray.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#include <util/profiler.h>
 
 enum variation_type {
 	VARIATION_MOTION = 0,
 	VARIATION_ZOOMOUT = 1,
-	VARIATION_ZOOMIN = 2
+	VARIATION_ZOOMIN = 2,
+	VARIATION_COUNT = 3
 };
 
+#define CHANNEL_POS       (1<<0)
+#define CHANNEL_SCALE     (1<<1)
+#define CHANNEL_BOUNDS    (1<<2)
+#define CHANNEL_ROT       (1<<3)
+#define CHANNEL_CROP      (1<<4)
+
+#define GROUP_CHUNK       64
+
 
 #define S_BEZIER_X        "bezier_x"
 #define S_BEZIER_Y        "bezier_y"
+#define S_EPSILON         "commit_epsilon"
 
 #define T_(v)             obs_module_text(v)
 #define T_BEZIER_X        T_("Acceleration.X")
 #define T_BEZIER_Y        T_("Acceleration.Y")
+#define T_EPSILON         T_("CommitEpsilon")
 
 
-typedef struct moving_item moving_item_t;
+typedef struct item_group item_group_t;
+typedef struct item_index item_index_t;
 typedef struct list_info list_info_t;
+typedef struct transition_state transition_state_t;
+typedef struct prewarm_scene prewarm_scene_t;
 typedef struct transition_data transition_data_t;
 
-struct moving_item {
-	obs_sceneitem_t           *item;
-	enum variation_type       type;
-	struct obs_transform_info start_info;
-	struct obs_transform_info end_info;
-	struct obs_sceneitem_crop start_crop;
-	struct obs_sceneitem_crop end_crop;
-	struct vec2               control_pos;
-	moving_item_t             *next;
+/*
+ * Items of one variation type, one array per field. The arrays are only
+ * emptied between transitions so their memory is reused. Bounds, rotation,
+ * crop and the control point are only filled for VARIATION_MOTION.
+ * channels marks what actually changes over the transition, and the
+ * committed_* arrays hold what was last handed to libobs.
+ */
+
+struct item_group {
+	DARRAY(obs_sceneitem_t *)         item;
+	DARRAY(struct vec2)               start_pos;
+	DARRAY(struct vec2)               end_pos;
+	DARRAY(struct vec2)               control_pos;
+	DARRAY(struct vec2)               start_scale;
+	DARRAY(struct vec2)               end_scale;
+	DARRAY(struct vec2)               start_bounds;
+	DARRAY(struct vec2)               end_bounds;
+	DARRAY(float)                     start_rot;
+	DARRAY(float)                     end_rot;
+	DARRAY(struct obs_sceneitem_crop) start_crop;
+	DARRAY(struct obs_sceneitem_crop) end_crop;
+	DARRAY(struct vec2)               pos;
+	DARRAY(struct vec2)               scale;
+	DARRAY(struct vec2)               bounds;
+	DARRAY(float)                     rot;
+	DARRAY(struct obs_sceneitem_crop) crop;
+	DARRAY(uint8_t)                   channels;
+	DARRAY(uint8_t)                   dirty;
+	DARRAY(struct vec2)               base_size;
+	DARRAY(struct vec2)               committed_pos;
+	DARRAY(struct vec2)               committed_scale;
+	DARRAY(struct vec2)               committed_bounds;
+	DARRAY(float)                     committed_rot;
+	DARRAY(struct obs_sceneitem_crop) committed_crop;
 };
 
 struct list_info {
 	obs_scene_t        *scene;
 	obs_source_t       *source;
-	moving_item_t      *last_item;
-	moving_item_t      *first_item;
+	item_group_t       groups[VARIATION_COUNT];
+	float              epsilon;
+	uint64_t           setter_calls;
+	uint64_t           setter_avoided;
+	DARRAY(obs_sceneitem_t *) items;
+	DARRAY(size_t)     partner;
 };
 
-struct transition_data {
-	obs_source_t        *context;
+/*
+ * Hash index of the items in one scene. Items sharing a source (or a
+ * name) are chained in scene order and every chain has a cursor that a
+ * match moves forward, so repeated sources pair up by occurrence.
+ */
+
+struct item_chains {
+	DARRAY(size_t)     head;
+	DARRAY(size_t)     cursor;
+	DARRAY(size_t)     next;
+};
+
+struct item_index {
+	struct item_chains source;
+	struct item_chains name;
+	size_t             mask;
+};
+
+/*
+ * Duplicated scenes and item lists of one transition. Two of them are
+ * kept: the prepare thread fills the back one while the render thread
+ * animates the front one.
+ */
+
+struct transition_state {
 	list_info_t         out_list;
 	list_info_t         in_list;
 	float               acc_x;
 	float               acc_y;
-	bool                start_init;
+	float               epsilon;
+	long                generation;
 	bool                scene_transition;
+};
+
+struct prewarm_scene {
+	obs_weak_source_t   *origin;
+	obs_scene_t         *scene;
+	volatile bool       dirty;
+};
+
+struct transition_data {
+	obs_source_t        *context;
+	transition_state_t  states[2];
+	transition_state_t  *front;
+	transition_state_t  *back;
+	prewarm_scene_t     prewarm;
+	volatile bool       prewarm_off;
+	obs_source_t        *pending_a;
+	obs_source_t        *pending_b;
+	obs_source_t        *pending_prewarm;
+	pthread_t           prepare_thread;
+	pthread_mutex_t     prepare_mutex;
+	os_event_t          *prepare_event;
+	bool                prepare_thread_created;
+	volatile bool       prepare_exit;
+	bool                ready;
+	long                generation;
+	float               acc_x;
+	float               acc_y;
+	float               epsilon;
+	struct motion_stats stats;
+	struct motion_cost  prepare_cost;
+	uint64_t            active_start;
+	list_info_t         *applied_list;
+	float               applied_time;
+	uint64_t            applied_frame;
+	uint64_t            reused_renders;
+	bool                start_init;
 	bool                transitioning;
 };
 
-static bool append_item_list(obs_scene_t *scene, obs_sceneitem_t *item_a, void *data)
+#define NO_ITEM ((size_t)-1)
+
+static struct worker_pool *pool;
+
+static inline size_t hash_source(const obs_source_t *source)
+{
+	uint64_t h = (uint64_t)(uintptr_t)source;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return (size_t)h;
+}
+
+static inline size_t hash_name(const char *name)
+{
+	uint32_t h = 2166136261U;
+	while (name && *name) {
+		h ^= (uint8_t)*name++;
+		h *= 16777619U;
+	}
+	return (size_t)h;
+}
+
+static inline const char *item_name(obs_sceneitem_t *item)
+{
+	return obs_source_get_name(obs_sceneitem_get_source(item));
+}
+
+static bool collect_item(obs_scene_t *scene, obs_sceneitem_t *item, void *data)
+{
+	list_info_t *list = data;
+	da_push_back(list->items, &item);
+	UNUSED_PARAMETER(scene);
+	return true;
+}
+
+static void fill_buckets(size_t *array, size_t count)
+{
+	size_t i;
+	for (i = 0; i < count; i++)
+		array[i] = NO_ITEM;
+}
+
+/*
+ * Buckets are open addressed on the hash and hold the index of the first
+ * item of a chain, which is never changed once set so probing stays
+ * valid while chains get consumed.
+ */
+
+static size_t find_bucket(item_index_t *index, list_info_t *list,
+	bool by_name, obs_sceneitem_t *item)
+{
+	size_t *heads = by_name ? index->name.head.array :
+		index->source.head.array;
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	const char *name = obs_source_get_name(source);
+	size_t slot = (by_name ? hash_name(name) : hash_source(source)) &
+		index->mask;
+
+	for (;;) {
+		size_t head = heads[slot];
+		obs_sceneitem_t *other;
+
+		if (head == NO_ITEM)
+			return slot;
+
+		other = list->items.array[head];
+		if (by_name) {
+			const char *other_name = item_name(other);
+			if (name && other_name && strcmp(name, other_name) == 0)
+				return slot;
+		} else if (obs_sceneitem_get_source(other) == source) {
+			return slot;
+		}
+
+		slot = (slot + 1) & index->mask;
+	}
+}
+
+static void init_chains(struct item_chains *chains, size_t buckets,
+	size_t count)
+{
+	da_resize(chains->head, buckets);
+	da_resize(chains->cursor, buckets);
+	da_resize(chains->next, count);
+	fill_buckets(chains->head.array, buckets);
+}
+
+static void push_chain(struct item_chains *chains, size_t slot, size_t idx)
+{
+	chains->next.array[idx] = chains->head.array[slot];
+	chains->head.array[slot] = idx;
+	chains->cursor.array[slot] = idx;
+}
+
+static void build_item_index(item_index_t *index, list_info_t *list)
+{
+	size_t count = list->items.num;
+	size_t buckets = 16;
+	size_t i;
+
+	while (buckets < count * 2)
+		buckets <<= 1;
+
+	index->mask = buckets - 1;
+	init_chains(&index->source, buckets, count);
+	init_chains(&index->name, buckets, count);
+
+	for (i = count; i > 0; i--) {
+		obs_sceneitem_t *item = list->items.array[i - 1];
+
+		push_chain(&index->source,
+			find_bucket(index, list, false, item), i - 1);
+		push_chain(&index->name,
+			find_bucket(index, list, true, item), i - 1);
+	}
+}
+
+static void free_chains(struct item_chains *chains)
+{
+	da_free(chains->head);
+	da_free(chains->cursor);
+	da_free(chains->next);
+}
+
+static size_t take_match(item_index_t *index, list_info_t *list,
+	bool by_name, obs_sceneitem_t *item)
+{
+	struct item_chains *chains = by_name ? &index->name : &index->source;
+	size_t slot = find_bucket(index, list, by_name, item);
+	size_t *cursor = &chains->cursor.array[slot];
+
+	if (chains->head.array[slot] == NO_ITEM)
+		return NO_ITEM;
+
+	while (*cursor != NO_ITEM && list->partner.array[*cursor] != NO_ITEM)
+		*cursor = chains->next.array[*cursor];
+
+	return *cursor;
+}
+
+/*
+ * Pair items of the two scenes in O(N+M): first by source, then by name
+ * for whatever is left over.
+ */
+
+static void match_items(list_info_t *out_list, list_info_t *in_list)
+{
+	item_index_t index = { 0 };
+	size_t i, j;
+	int pass;
+
+	da_resize(out_list->partner, out_list->items.num);
+	da_resize(in_list->partner, in_list->items.num);
+	fill_buckets(out_list->partner.array, out_list->partner.num);
+	fill_buckets(in_list->partner.array, in_list->partner.num);
+
+	build_item_index(&index, in_list);
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < out_list->items.num; i++) {
+			if (out_list->partner.array[i] != NO_ITEM)
+				continue;
+
+			j = take_match(&index, in_list, pass == 1,
+				out_list->items.array[i]);
+			if (j == NO_ITEM)
+				continue;
+
+			out_list->partner.array[i] = j;
+			in_list->partner.array[j] = i;
+		}
+	}
+
+	free_chains(&index.source);
+	free_chains(&index.name);
+}
+
+static inline bool vec2_equal(const struct vec2 *a, const struct vec2 *b)
+{
+	return a->x == b->x && a->y == b->y;
+}
+
+static inline bool crop_equal(const struct obs_sceneitem_crop *a,
+	const struct obs_sceneitem_crop *b)
+{
+	return a->left == b->left && a->top == b->top &&
+		a->right == b->right && a->bottom == b->bottom;
+}
+
+/*
+ * The duplicated scene item already holds its own end of the transition,
+ * so that is the value considered committed before the first frame.
+ */
+
+static void append_item_group(item_group_t *group, obs_sceneitem_t *item,
+	bool transition_out, struct obs_transform_info *start_info,
+	struct obs_transform_info *end_info)
+{
+	struct obs_transform_info *cur = transition_out ? start_info : end_info;
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	struct vec2 base_size;
+	uint8_t channels = 0;
+
+	if (!vec2_equal(&start_info->pos, &end_info->pos))
+		channels |= CHANNEL_POS;
+	if (!vec2_equal(&start_info->scale, &end_info->scale))
+		channels |= CHANNEL_SCALE;
+
+	base_size.x = (float)obs_source_get_base_width(source);
+	base_size.y = (float)obs_source_get_base_height(source);
+
+	da_push_back(group->item, &item);
+	da_push_back(group->start_pos, &start_info->pos);
+	da_push_back(group->end_pos, &end_info->pos);
+	da_push_back(group->start_scale, &start_info->scale);
+	da_push_back(group->end_scale, &end_info->scale);
+	da_push_back(group->channels, &channels);
+	da_push_back(group->base_size, &base_size);
+	da_push_back(group->committed_pos, &cur->pos);
+	da_push_back(group->committed_scale, &cur->scale);
+}
+
+static void append_item_list(transition_state_t *state, bool transition_out,
+	obs_sceneitem_t *item_a, obs_sceneitem_t *item_b)
 {
-	transition_data_t *tr = data;
-	bool transition_out = tr->out_list.scene == scene;
 	bool transform_variation = false;
-	list_info_t *list, *list_cmp;
+	list_info_t *list;
+	item_group_t *group;
+	struct obs_transform_info start_info, end_info;
+	struct obs_sceneitem_crop start_crop, end_crop;
 	struct obs_transform_info *info_a, *info_b;
 	struct obs_sceneitem_crop *crop_a, *crop_b;
 	obs_source_t *source_a = obs_sceneitem_get_source(item_a);
-	obs_sceneitem_t *item_b;
-	moving_item_t *next = bzalloc(sizeof(*next));
+	struct vec2 control_pos;
+	uint8_t *channels;
 
 	if (transition_out) {
-		list = &tr->out_list;
-		list_cmp = &tr->in_list;
-		info_a = &next->start_info;
-		info_b = &next->end_info;
-		crop_a = &next->start_crop;
-		crop_b = &next->end_crop;
+		list = &state->out_list;
+		info_a = &start_info;
+		info_b = &end_info;
+		crop_a = &start_crop;
+		crop_b = &end_crop;
 	} else {
-		list = &tr->in_list;
-		list_cmp = &tr->out_list;
-		info_a = &next->end_info;
-		info_b = &next->start_info;
-		crop_a = &next->end_crop;
-		crop_b = &next->start_crop;
+		list = &state->in_list;
+		info_a = &end_info;
+		info_b = &start_info;
+		crop_a = &end_crop;
+		crop_b = &start_crop;
 	}
 
 	obs_sceneitem_get_info(item_a, info_a);
 	obs_sceneitem_get_crop(item_a, crop_a);
-	item_b = obs_scene_find_source(list_cmp->scene, 
-		obs_source_get_name(source_a));
-
 
 	if (item_b) {
 		obs_sceneitem_get_info(item_b, info_b);
@@ -111,11 +441,32 @@ static bool append_item_list(obs_scene_t *scene, obs_sceneitem_t *item_a, void *
 	}
 
 	if (transform_variation) {
-		float t = transition_out ? tr->acc_x : 1 - tr->acc_x;
-		float f = transition_out ? tr->acc_y : 1 - tr->acc_y;
-		next->control_pos.x = (1 - t) * info_a->pos.x + t * info_b->pos.x;
-		next->control_pos.y = (1 - f) * info_a->pos.y + f * info_b->pos.y;
-		next->type = VARIATION_MOTION;
+		float t = transition_out ? state->acc_x : 1 - state->acc_x;
+		float f = transition_out ? state->acc_y : 1 - state->acc_y;
+		control_pos.x = (1 - t) * info_a->pos.x + t * info_b->pos.x;
+		control_pos.y = (1 - f) * info_a->pos.y + f * info_b->pos.y;
+
+		group = &list->groups[VARIATION_MOTION];
+		append_item_group(group, item_a, transition_out, &start_info,
+			&end_info);
+		da_push_back(group->control_pos, &control_pos);
+		da_push_back(group->start_bounds, &start_info.bounds);
+		da_push_back(group->end_bounds, &end_info.bounds);
+		da_push_back(group->start_rot, &start_info.rot);
+		da_push_back(group->end_rot, &end_info.rot);
+		da_push_back(group->start_crop, &start_crop);
+		da_push_back(group->end_crop, &end_crop);
+		da_push_back(group->committed_bounds, &info_a->bounds);
+		da_push_back(group->committed_rot, &info_a->rot);
+		da_push_back(group->committed_crop, crop_a);
+
+		channels = &group->channels.array[group->channels.num - 1];
+		if (!vec2_equal(&start_info.bounds, &end_info.bounds))
+			*channels |= CHANNEL_BOUNDS;
+		if (start_info.rot != end_info.rot)
+			*channels |= CHANNEL_ROT;
+		if (!crop_equal(&start_crop, &end_crop))
+			*channels |= CHANNEL_CROP;
 	} else {
 		float w = obs_source_get_base_width(source_a) * info_a->scale.x;
 		float h = obs_source_get_base_height(source_a) * info_a->scale.y;
@@ -123,76 +474,342 @@ static bool append_item_list(obs_scene_t *scene, obs_sceneitem_t *item_a, void *
 		info_b->pos.y = info_a->pos.y + h / 2;
 		info_b->scale.x = 0;
 		info_b->scale.y = 0;
-		next->type = transition_out ? VARIATION_ZOOMOUT : VARIATION_ZOOMIN;
-	}
 
-	next->item = item_a;
+		group = &list->groups[transition_out ?
+			VARIATION_ZOOMOUT : VARIATION_ZOOMIN];
+		append_item_group(group, item_a, transition_out, &start_info,
+			&end_info);
+	}
+}
 
-	if (list->last_item)
-		list->last_item->next = next;
-	else
-		list->first_item = next;
+static void append_list(transition_state_t *state, bool transition_out)
+{
+	list_info_t *list = transition_out ? &state->out_list : &state->in_list;
+	list_info_t *list_cmp = transition_out ? &state->in_list :
+		&state->out_list;
+	size_t i;
 
-	list->last_item = next;
+	for (i = 0; i < list->items.num; i++) {
+		size_t j = list->partner.array[i];
+		obs_sceneitem_t *item_b = j != NO_ITEM ?
+			list_cmp->items.array[j] : NULL;
 
-	return true;
+		append_item_list(state, transition_out, list->items.array[i],
+			item_b);
+	}
 }
 
-static void create_item_list(transition_data_t* tr)
+static void create_item_list(transition_state_t *state)
 {
-	obs_scene_enum_items(tr->out_list.scene, append_item_list, tr);
-	obs_scene_enum_items(tr->in_list.scene, append_item_list, tr);
+	obs_scene_enum_items(state->out_list.scene, collect_item,
+		&state->out_list);
+	obs_scene_enum_items(state->in_list.scene, collect_item,
+		&state->in_list);
+
+	match_items(&state->out_list, &state->in_list);
+	append_list(state, true);
+	append_list(state, false);
 }
 
+#define group_fields(group, op) \
+	do { \
+		op(group->item); \
+		op(group->start_pos); \
+		op(group->end_pos); \
+		op(group->control_pos); \
+		op(group->start_scale); \
+		op(group->end_scale); \
+		op(group->start_bounds); \
+		op(group->end_bounds); \
+		op(group->start_rot); \
+		op(group->end_rot); \
+		op(group->start_crop); \
+		op(group->end_crop); \
+		op(group->pos); \
+		op(group->scale); \
+		op(group->bounds); \
+		op(group->rot); \
+		op(group->crop); \
+		op(group->channels); \
+		op(group->dirty); \
+		op(group->base_size); \
+		op(group->committed_pos); \
+		op(group->committed_scale); \
+		op(group->committed_bounds); \
+		op(group->committed_rot); \
+		op(group->committed_crop); \
+	} while (false)
+
+#define group_clear(v) da_resize(v, 0)
+
 static void release_item_list(list_info_t *list)
 {
-	moving_item_t *mv = list->first_item;
-	moving_item_t *next;
-	while (mv) {
-		next = mv->next;
-		bfree(mv);
-		mv = next;
+	int i;
+
+	for (i = 0; i < VARIATION_COUNT; i++) {
+		item_group_t *group = &list->groups[i];
+		group_fields(group, group_clear);
 	}
 
-	memset(list, 0, sizeof(list_info_t));
+	da_resize(list->items, 0);
+	da_resize(list->partner, 0);
+	list->setter_calls = 0;
+	list->setter_avoided = 0;
+	list->scene = NULL;
+	list->source = NULL;
 }
 
-static void update_item_information(moving_item_t *mv, float time)
+static void free_item_list(list_info_t *list)
 {
-	struct vec2 pos;
-	struct vec2 scale;
-	struct vec2 bounds;
-	struct obs_sceneitem_crop crop;
-	float rot;
-	float t;
+	int i;
 
-	while(mv) {
+	for (i = 0; i < VARIATION_COUNT; i++) {
+		item_group_t *group = &list->groups[i];
+		group_fields(group, da_free);
+	}
 
-		if (mv->type == VARIATION_MOTION) {
-			t = time;
-			vec_bezier(mv->start_info.pos, mv->control_pos, mv->end_info.pos, 
-				&pos, t);
-			vec_linear(mv->start_info.bounds, mv->end_info.bounds, &bounds, t);
-			crop_linear(mv->start_crop, mv->end_crop, &crop, t);
-			rot = (1.0f - t) * mv->start_info.rot + t * mv->end_info.rot;
-			obs_sceneitem_set_bounds(mv->item, &bounds);
-			obs_sceneitem_set_crop(mv->item, &crop);
-			obs_sceneitem_set_rot(mv->item, rot);
+	da_free(list->items);
+	da_free(list->partner);
+}
 
-		} else if (mv->type == VARIATION_ZOOMIN) {
-			t = time * 2 - 1.0f;
-			vec_linear(mv->start_info.pos, mv->end_info.pos, &pos, t);
-		} else {
-			t = time * 2;
-			vec_linear(mv->start_info.pos, mv->end_info.pos, &pos, t);
-		}
-		
-		vec_linear(mv->start_info.scale, mv->end_info.scale, &scale, t);
+#undef group_clear
+#undef group_fields
+
+static void lerp_floats(float *dst, const float *a, const float *b,
+	size_t count, float t)
+{
+	float p = 1.0f - t;
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		dst[i] = p * a[i] + t * b[i];
+}
+
+static void lerp_vec2s(struct vec2 *dst, const struct vec2 *a,
+	const struct vec2 *b, size_t count, float t)
+{
+	lerp_floats(dst->ptr, a->ptr, b->ptr, count * 2, t);
+}
+
+static void bezier_vec2s(struct vec2 *dst, const struct vec2 *a,
+	const struct vec2 *c, const struct vec2 *b, size_t count, float t)
+{
+	float w0 = (1.0f - t) * (1.0f - t);
+	float w1 = 2.0f * (1.0f - t) * t;
+	float w2 = t * t;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		dst[i].x = w0 * a[i].x + w1 * c[i].x + w2 * b[i].x;
+		dst[i].y = w0 * a[i].y + w1 * c[i].y + w2 * b[i].y;
+	}
+}
+
+static void lerp_crops(struct obs_sceneitem_crop *dst,
+	const struct obs_sceneitem_crop *a, const struct obs_sceneitem_crop *b,
+	size_t count, float t)
+{
+	size_t i;
+	for (i = 0; i < count; i++)
+		crop_linear(a[i], b[i], &dst[i], t);
+}
+
+/* The larger of the scaled source and the bounds box. */
+
+static void item_extent(item_group_t *group, size_t i, struct vec2 *size)
+{
+	const struct vec2 *base = &group->base_size.array[i];
+	const struct vec2 *scale = &group->scale.array[i];
+	const struct vec2 *bounds = &group->bounds.array[i];
+
+	size->x = fmaxf(fabsf(base->x * scale->x), fabsf(bounds->x));
+	size->y = fmaxf(fabsf(base->y * scale->y), fabsf(bounds->y));
+}
+
+static uint8_t get_dirty_channels(item_group_t *group, size_t i,
+	float epsilon)
+{
+	uint8_t channels = group->channels.array[i];
+	uint8_t dirty = 0;
+
+	if ((channels & CHANNEL_POS) && vec2_changed(&group->pos.array[i],
+		&group->committed_pos.array[i], epsilon))
+		dirty |= CHANNEL_POS;
+
+	if ((channels & CHANNEL_SCALE) && scale_changed(&group->scale.array[i],
+		&group->committed_scale.array[i], &group->base_size.array[i],
+		epsilon))
+		dirty |= CHANNEL_SCALE;
+
+	if ((channels & CHANNEL_BOUNDS) && vec2_changed(
+		&group->bounds.array[i], &group->committed_bounds.array[i],
+		epsilon))
+		dirty |= CHANNEL_BOUNDS;
+
+	if (channels & CHANNEL_ROT) {
+		struct vec2 size;
+		item_extent(group, i, &size);
+		if (rotation_changed(group->rot.array[i],
+			group->committed_rot.array[i], &size, epsilon))
+			dirty |= CHANNEL_ROT;
+	}
+
+	if ((channels & CHANNEL_CROP) && !crop_equal(&group->crop.array[i],
+		&group->committed_crop.array[i]))
+		dirty |= CHANNEL_CROP;
+
+	return dirty;
+}
+
+static inline int channel_count(uint8_t channels)
+{
+	int count = 0;
+	while (channels) {
+		count += channels & 1;
+		channels >>= 1;
+	}
+	return count;
+}
+
+/*
+ * Items are evaluated in ranges on the worker pool. Every range writes
+ * its own slice of the transform and dirty arrays, committing is left
+ * to the graphics thread.
+ */
+
+struct group_job {
+	item_group_t        *group;
+	enum variation_type type;
+	float               t;
+	float               epsilon;
+};
+
+static void cal_group_range(void *param, size_t begin, size_t end)
+{
+	struct group_job *job = param;
+	item_group_t *group = job->group;
+	size_t count = end - begin;
+	float t = job->t;
+	size_t i;
+
+	if (job->type == VARIATION_MOTION) {
+		bezier_vec2s(group->pos.array + begin,
+			group->start_pos.array + begin,
+			group->control_pos.array + begin,
+			group->end_pos.array + begin, count, t);
+		lerp_vec2s(group->bounds.array + begin,
+			group->start_bounds.array + begin,
+			group->end_bounds.array + begin, count, t);
+		lerp_floats(group->rot.array + begin,
+			group->start_rot.array + begin,
+			group->end_rot.array + begin, count, t);
+		lerp_crops(group->crop.array + begin,
+			group->start_crop.array + begin,
+			group->end_crop.array + begin, count, t);
+	} else {
+		lerp_vec2s(group->pos.array + begin,
+			group->start_pos.array + begin,
+			group->end_pos.array + begin, count, t);
+	}
+
+	lerp_vec2s(group->scale.array + begin, group->start_scale.array + begin,
+		group->end_scale.array + begin, count, t);
+
+	for (i = begin; i < end; i++)
+		group->dirty.array[i] = get_dirty_channels(group, i,
+			job->epsilon);
+}
+
+static void cal_group_transform(item_group_t *group, enum variation_type type,
+	float time, float epsilon)
+{
+	struct group_job job = { group, type, time, epsilon };
+	size_t count = group->item.num;
+
+	da_resize(group->pos, count);
+	da_resize(group->scale, count);
+	da_resize(group->dirty, count);
+
+	if (type == VARIATION_MOTION) {
+		da_resize(group->bounds, count);
+		da_resize(group->rot, count);
+		da_resize(group->crop, count);
+	} else {
+		job.t = type == VARIATION_ZOOMIN ? time * 2 - 1.0f : time * 2;
+	}
+
+	worker_pool_run(pool, cal_group_range, &job, count, GROUP_CHUNK);
+}
+
+/*
+ * Apply the whole frame under one scene lock. Each item defers its
+ * transform update so it is recalculated once instead of once per setter,
+ * and only channels that moved further than epsilon are set at all.
+ */
+
+static void commit_item_transforms(void *data, obs_scene_t *scene)
+{
+	list_info_t *list = data;
+	int type;
+	size_t i;
+
+	for (type = 0; type < VARIATION_COUNT; type++) {
+		item_group_t *group = &list->groups[type];
+		int setters = type == VARIATION_MOTION ? 5 : 2;
+
+		for (i = 0; i < group->item.num; i++) {
+			obs_sceneitem_t *item = group->item.array[i];
+			uint8_t dirty = group->dirty.array[i];
+			int calls = channel_count(dirty);
+
+			list->setter_calls += calls;
+			list->setter_avoided += setters - calls;
 
-		obs_sceneitem_set_pos(mv->item, &pos);
-		obs_sceneitem_set_scale(mv->item, &scale);	
-		mv = mv->next;
+			if (!dirty)
+				continue;
+
+			obs_sceneitem_defer_update_begin(item);
+
+			if (dirty & CHANNEL_POS) {
+				group->committed_pos.array[i] = group->pos.array[i];
+				trace_set_pos(item, &group->pos.array[i]);
+			}
+			if (dirty & CHANNEL_SCALE) {
+				group->committed_scale.array[i] =
+					group->scale.array[i];
+				trace_set_scale(item, &group->scale.array[i]);
+			}
+			if (dirty & CHANNEL_BOUNDS) {
+				group->committed_bounds.array[i] =
+					group->bounds.array[i];
+				trace_set_bounds(item, &group->bounds.array[i]);
+			}
+			if (dirty & CHANNEL_CROP) {
+				group->committed_crop.array[i] =
+					group->crop.array[i];
+				trace_set_crop(item, &group->crop.array[i]);
+			}
+			if (dirty & CHANNEL_ROT) {
+				group->committed_rot.array[i] = group->rot.array[i];
+				trace_set_rot(item, group->rot.array[i]);
+			}
+
+			obs_sceneitem_defer_update_end(item);
+		}
 	}
+
+	UNUSED_PARAMETER(scene);
+}
+
+static void update_item_information(list_info_t *list, float time)
+{
+	int type;
+
+	for (type = 0; type < VARIATION_COUNT; type++)
+		cal_group_transform(&list->groups[type], type, time,
+			list->epsilon);
+
+	obs_scene_atomic_update(list->scene, commit_item_transforms, list);
 }
 
 static void motion_transition_update(void *data, obs_data_t *settings)
@@ -200,30 +817,375 @@ static void motion_transition_update(void *data, obs_data_t *settings)
 	transition_data_t *tr = data;
 	float x = (float)obs_data_get_double(settings, S_BEZIER_X);
 	float y = (float)obs_data_get_double(settings, S_BEZIER_Y);
-	
+	float epsilon = (float)obs_data_get_double(settings, S_EPSILON);
+
+	// The prepare thread copies these into the back state
+	pthread_mutex_lock(&tr->prepare_mutex);
 	tr->acc_x = - x + 0.5f;
 	tr->acc_y = - y + 0.5f;
+	tr->epsilon = epsilon;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+}
+
+static void release_state(transition_state_t *state)
+{
+	obs_scene_release(state->in_list.scene);
+	obs_scene_release(state->out_list.scene);
+	release_item_list(&state->in_list);
+	release_item_list(&state->out_list);
+	state->scene_transition = false;
+}
+
+static void prewarm_dirty(void *data, calldata_t *cd)
+{
+	transition_data_t *tr = data;
+	os_atomic_set_bool(&tr->prewarm.dirty, true);
+	UNUSED_PARAMETER(cd);
+}
+
+static const char *prewarm_signals[] = {
+	"item_add",
+	"item_remove",
+	"reorder",
+	"refresh",
+	"item_visible",
+	"item_transform",
+	NULL
+};
+
+static void prewarm_connect(transition_data_t *tr, obs_source_t *origin,
+	bool connect)
+{
+	signal_handler_t *sh = obs_source_get_signal_handler(origin);
+	const char **signal;
+
+	for (signal = prewarm_signals; *signal; signal++) {
+		if (connect)
+			signal_handler_connect(sh, *signal, prewarm_dirty, tr);
+		else
+			signal_handler_disconnect(sh, *signal, prewarm_dirty, tr);
+	}
+}
+
+static void release_prewarm(transition_data_t *tr)
+{
+	prewarm_scene_t *pw = &tr->prewarm;
+	obs_source_t *origin = obs_weak_source_get_source(pw->origin);
+
+	if (origin) {
+		prewarm_connect(tr, origin, false);
+		obs_source_release(origin);
+	}
+
+	obs_weak_source_release(pw->origin);
+	obs_scene_release(pw->scene);
+	pw->origin = NULL;
+	pw->scene = NULL;
+}
+
+/*
+ * Hand over the pre-warmed duplicate if it was made from this scene and
+ * the scene has not been touched since.
+ */
+
+static obs_scene_t *take_prewarm(transition_data_t *tr, obs_source_t *origin)
+{
+	prewarm_scene_t *pw = &tr->prewarm;
+	obs_scene_t *scene = NULL;
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	if (pw->scene && obs_weak_source_references_source(pw->origin, origin)
+		&& !os_atomic_load_bool(&pw->dirty)) {
+		scene = pw->scene;
+		pw->scene = NULL;
+	}
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	return scene;
+}
+
+static obs_scene_t *duplicate_scene(transition_data_t *tr,
+	obs_source_t *origin, const char *name)
+{
+	obs_scene_t *scene = take_prewarm(tr, origin);
+
+	if (!scene)
+		scene = obs_scene_duplicate(obs_scene_from_source(origin), name,
+			OBS_SCENE_DUP_PRIVATE_REFS);
+
+	return scene;
+}
+
+static void prepare_prewarm(transition_data_t *tr, obs_source_t *origin)
+{
+	obs_scene_t *scene = obs_scene_from_source(origin);
+	obs_scene_t *dup;
+
+	if (!scene)
+		return;
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	release_prewarm(tr);
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	dup = obs_scene_duplicate(scene, "motion-transition-prewarm",
+		OBS_SCENE_DUP_PRIVATE_REFS);
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	tr->prewarm.origin = obs_source_get_weak_source(origin);
+	tr->prewarm.scene = dup;
+	os_atomic_set_bool(&tr->prewarm.dirty, false);
+	prewarm_connect(tr, origin, true);
+	pthread_mutex_unlock(&tr->prepare_mutex);
+}
+
+static void prepare_state(transition_data_t *tr, transition_state_t *state,
+	obs_source_t *source_a, obs_source_t *source_b)
+{
+	state->scene_transition = obs_scene_from_source(source_a) &&
+		obs_scene_from_source(source_b);
+
+	if (!state->scene_transition)
+		return;
+
+	state->out_list.epsilon = state->epsilon;
+	state->in_list.epsilon = state->epsilon;
+	state->out_list.scene = duplicate_scene(tr, source_a,
+		"motion-transition-a");
+	state->out_list.source = obs_scene_get_source(state->out_list.scene);
+
+	state->in_list.scene = duplicate_scene(tr, source_b,
+		"motion-transition-b");
+	state->in_list.source = obs_scene_get_source(state->in_list.scene);
+
+	create_item_list(state);
+}
+
+static const char *prepare_name = "motion_transition_prepare";
+static const char *update_name = "motion_transition_update_items";
+
+static void prepare_transition(transition_data_t *tr)
+{
+	obs_source_t *source_a, *source_b;
+	transition_state_t *state;
+	long generation;
+	uint64_t start;
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	source_a = tr->pending_a;
+	source_b = tr->pending_b;
+	generation = tr->generation;
+	tr->pending_a = NULL;
+	tr->pending_b = NULL;
+	tr->ready = false;
+	state = tr->back;
+	state->acc_x = tr->acc_x;
+	state->acc_y = tr->acc_y;
+	state->epsilon = tr->epsilon;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	if (!source_a && !source_b)
+		return;
+
+	profile_start(prepare_name);
+	start = os_gettime_ns();
+	release_state(state);
+	prepare_state(tr, state, source_a, source_b);
+	state->generation = generation;
+	profile_end(prepare_name);
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	motion_cost_add(&tr->prepare_cost, os_gettime_ns() - start);
+	tr->ready = true;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	obs_source_release(source_a);
+	obs_source_release(source_b);
+}
+
+static void *prepare_thread(void *data)
+{
+	transition_data_t *tr = data;
+	obs_source_t *prewarm;
+
+	os_set_thread_name("motion-transition: prepare");
+
+	while (os_event_wait(tr->prepare_event) == 0) {
+		if (os_atomic_load_bool(&tr->prepare_exit))
+			break;
+
+		prepare_transition(tr);
+
+		pthread_mutex_lock(&tr->prepare_mutex);
+		prewarm = tr->pending_prewarm;
+		tr->pending_prewarm = NULL;
+		pthread_mutex_unlock(&tr->prepare_mutex);
+
+		if (prewarm) {
+			prepare_prewarm(tr, prewarm);
+			obs_source_release(prewarm);
+		} else if (os_atomic_load_bool(&tr->prewarm_off)) {
+			pthread_mutex_lock(&tr->prepare_mutex);
+			release_prewarm(tr);
+			pthread_mutex_unlock(&tr->prepare_mutex);
+		}
+	}
+
+	return NULL;
+}
+
+static void request_prewarm(transition_data_t *tr, obs_source_t *source)
+{
+	if (!obs_scene_from_source(source) ||
+		os_atomic_load_bool(&tr->prewarm_off))
+		return;
+
+	obs_source_addref(source);
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	obs_source_release(tr->pending_prewarm);
+	tr->pending_prewarm = source;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	os_event_signal(tr->prepare_event);
+}
+
+static void prewarm_proc(void *data, calldata_t *cd)
+{
+	transition_data_t *tr = data;
+	obs_source_t *source = calldata_ptr(cd, "source");
+
+	if (source)
+		request_prewarm(tr, source);
+}
+
+static void preview_scene_changed(enum obs_frontend_event event, void *data)
+{
+	transition_data_t *tr = data;
+	obs_source_t *transition, *preview;
+
+	if (event != OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED)
+		return;
+
+	if (!obs_frontend_preview_program_mode_active())
+		return;
+
+	transition = obs_frontend_get_current_transition();
+	preview = obs_frontend_get_current_preview_scene();
+
+	if (transition == tr->context && preview)
+		request_prewarm(tr, preview);
+
+	obs_source_release(preview);
+	obs_source_release(transition);
 }
 
 static void motion_transition_start(void *data)
 {
 	transition_data_t *tr = data;
+	obs_source_t *source_a = obs_transition_get_source(tr->context,
+		OBS_TRANSITION_SOURCE_A);
+	obs_source_t *source_b = obs_transition_get_source(tr->context,
+		OBS_TRANSITION_SOURCE_B);
+
+	trace_trigger(source_b, tr->context, true);
+
+	/*
+	 * With "Duplicate Scene" in studio mode the frontend hands over a
+	 * private copy of the preview, which is made on the spot and may
+	 * use copies of its sources. A duplicate of the preview never
+	 * stands in for it, so prewarming stays off until a transition
+	 * receives a public scene again.
+	 */
+	os_atomic_set_bool(&tr->prewarm_off, is_private_scene(source_b));
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	obs_source_release(tr->pending_a);
+	obs_source_release(tr->pending_b);
+	tr->pending_a = source_a;
+	tr->pending_b = source_b;
+	tr->generation++;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	os_event_signal(tr->prepare_event);
+	tr->stats.triggers++;
 	tr->start_init = true;
 }
 
+static void release_front_state(transition_data_t *tr)
+{
+	transition_state_t *state = tr->front;
+
+	if (state->scene_transition) {
+		obs_source_remove_active_child(tr->context,
+			state->in_list.source);
+		obs_source_remove_active_child(tr->context,
+			state->out_list.source);
+
+		tr->stats.setter_calls += state->out_list.setter_calls +
+			state->in_list.setter_calls;
+		tr->stats.setter_avoided += state->out_list.setter_avoided +
+			state->in_list.setter_avoided;
+
+		blog(LOG_DEBUG, "motion-transition: %llu setter calls, "
+			"%llu avoided (total %llu / %llu), %llu renders reused",
+			(unsigned long long)(state->out_list.setter_calls +
+				state->in_list.setter_calls),
+			(unsigned long long)(state->out_list.setter_avoided +
+				state->in_list.setter_avoided),
+			(unsigned long long)tr->stats.setter_calls,
+			(unsigned long long)tr->stats.setter_avoided,
+			(unsigned long long)tr->reused_renders);
+	}
+
+	tr->applied_list = NULL;
+	tr->reused_renders = 0;
+
+	if (tr->active_start) {
+		tr->stats.active_time +=
+			(os_gettime_ns() - tr->active_start) / 1000000000.0;
+		tr->active_start = 0;
+	}
+
+	release_state(state);
+}
+
 static void motion_transition_stop(void *data)
 {
 	transition_data_t *tr = data;
 	
-	obs_source_remove_active_child(tr->context, tr->in_list.source);
-	obs_source_remove_active_child(tr->context, tr->out_list.source);
-	obs_scene_release(tr->in_list.scene);
-	obs_scene_release(tr->out_list.scene);	
-	release_item_list(&tr->in_list);
-	release_item_list(&tr->out_list);
+	release_front_state(tr);
+	tr->start_init = false;
 	tr->transitioning = false;
 }
 
+/*
+ * Swap in the prepared state once the prepare thread is done with it.
+ * Until then the transition renders the plain A/B sources.
+ */
+
+static void swap_prepared_state(transition_data_t *tr)
+{
+	transition_state_t *state = NULL;
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	if (tr->ready && tr->back->generation == tr->generation) {
+		state = tr->back;
+		tr->back = tr->front;
+		tr->front = state;
+		tr->ready = false;
+	}
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	if (state)
+		tr->applied_list = NULL;
+
+	if (state && state->scene_transition) {
+		obs_source_add_active_child(tr->context, state->out_list.source);
+		obs_source_add_active_child(tr->context, state->in_list.source);
+	}
+}
+
 static obs_properties_t *motion_transition_properties(void *data)
 {
 	obs_properties_t *props = obs_properties_create();
@@ -231,57 +1193,58 @@ static obs_properties_t *motion_transition_properties(void *data)
 		0.01);
 	obs_properties_add_float_slider(props, S_BEZIER_Y, T_BEZIER_Y, -0.5, 0.5,
 		0.01);
+	obs_properties_add_float_slider(props, S_EPSILON, T_EPSILON, 0.0, 5.0,
+		0.05);
 	return props;
 }
 
 static void motion_transition_video_render(void *data, gs_effect_t *effect)
 {
 	transition_data_t *tr = data;
+	transition_state_t *state;
 
 	float t = obs_transition_get_time(tr->context);
 
 	if (tr->start_init) {
-
 		if (tr->transitioning)
-			motion_transition_stop(tr);
+			release_front_state(tr);
 
-		obs_source_t *source_a = obs_transition_get_source(tr->context,
-			OBS_TRANSITION_SOURCE_A);
-		obs_scene_t *scene_a = obs_scene_from_source(source_a);
+		tr->transitioning = true;
+		tr->start_init = false;
+		tr->active_start = os_gettime_ns();
+	}
 
-		obs_source_t *source_b = obs_transition_get_source(tr->context,
-			OBS_TRANSITION_SOURCE_B);
-		obs_scene_t *scene_b = obs_scene_from_source(source_b);
-		tr->scene_transition = scene_a && scene_b;
+	if (tr->transitioning)
+		swap_prepared_state(tr);
 
-		if (tr->scene_transition) {
+	state = tr->front;
 
-			tr->out_list.scene = obs_scene_duplicate(scene_a,
-				"motion-transition-a", OBS_SCENE_DUP_PRIVATE_REFS);
-			tr->out_list.source = obs_scene_get_source(tr->out_list.scene);
-			obs_source_add_active_child(tr->context, tr->out_list.source);
+	if (t > 0.0f && t < 1.0f && tr->transitioning && 
+		state->scene_transition) {
+		list_info_t *list = t <= 0.5f ? &state->out_list :
+			&state->in_list;
+		uint64_t frame = obs_get_video_frame_time();
 
-			tr->in_list.scene = obs_scene_duplicate(scene_b,
-				"motion-transition-b", OBS_SCENE_DUP_PRIVATE_REFS);
-			tr->in_list.source = obs_scene_get_source(tr->in_list.scene);
-			obs_source_add_active_child(tr->context, tr->in_list.source);
+		// Studio mode, multiview and projectors render the transition
+		// several times per frame, the items only need updating once
+		if (list != tr->applied_list || t != tr->applied_time ||
+			frame != tr->applied_frame) {
+			uint64_t start = os_gettime_ns();
 
-			create_item_list(tr);
-			tr->transitioning = true;
-		}
-		obs_source_release(source_a);
-		obs_source_release(source_b);
-		tr->start_init = false;
-	}
+			trace_frame(t);
+			profile_start(update_name);
+			update_item_information(list, t);
+			profile_end(update_name);
+			motion_cost_add(&tr->stats.cost, os_gettime_ns() - start);
 
-	if (t > 0.0f && t < 1.0f && tr->scene_transition) {
-		if (t <= 0.5) {
-			update_item_information(tr->out_list.first_item, t);
-			obs_source_video_render(tr->out_list.source);
+			tr->applied_list = list;
+			tr->applied_time = t;
+			tr->applied_frame = frame;
 		} else {
-			update_item_information(tr->in_list.first_item, t);
-			obs_source_video_render(tr->in_list.source);
+			tr->reused_renders++;
 		}
+
+		obs_source_video_render(list->source);
 	} else if (t <= 0.5f ) {
 		obs_transition_video_render_direct(tr->context,
 			OBS_TRANSITION_SOURCE_A);
@@ -318,11 +1281,13 @@ static void motion_enum_all_sources(void *data,
 	obs_source_enum_proc_t enum_callback, void *param)
 {
 	transition_data_t* tr = data;
-	if (tr->out_list.source)
-		enum_callback(tr->context, tr->out_list.source, param);
+	transition_state_t *state = tr->front;
+
+	if (state->out_list.source)
+		enum_callback(tr->context, state->out_list.source, param);
 
-	if (tr->in_list.source)
-		enum_callback(tr->context, tr->in_list.source, param);
+	if (state->in_list.source)
+		enum_callback(tr->context, state->in_list.source, param);
 
 }
 
@@ -331,25 +1296,108 @@ static void motion_enum_active_sources(void *data,
 	obs_source_enum_proc_t enum_callback, void *param)
 {
 	transition_data_t* tr = data;
-	if (tr->out_list.source && tr->transitioning)
-		enum_callback(tr->context, tr->out_list.source, param);
+	transition_state_t *state = tr->front;
+
+	if (state->out_list.source && tr->transitioning)
+		enum_callback(tr->context, state->out_list.source, param);
 
-	if (tr->in_list.source && tr->transitioning)
-		enum_callback(tr->context, tr->in_list.source, param);
+	if (state->in_list.source && tr->transitioning)
+		enum_callback(tr->context, state->in_list.source, param);
+}
+
+static void get_stats_proc(void *data, calldata_t *cd)
+{
+	transition_data_t *tr = data;
+
+	motion_stats_to_calldata(&tr->stats, cd);
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	motion_cost_to_calldata(&tr->prepare_cost, cd, "prepare_");
+	pthread_mutex_unlock(&tr->prepare_mutex);
+}
+
+static void log_stats_proc(void *data, calldata_t *cd)
+{
+	transition_data_t *tr = data;
+	struct motion_cost prepare;
+
+	pthread_mutex_lock(&tr->prepare_mutex);
+	prepare = tr->prepare_cost;
+	pthread_mutex_unlock(&tr->prepare_mutex);
+
+	motion_stats_log(tr->context, &tr->stats);
+	blog(LOG_INFO, "[%s] %llu prepares, avg %.3f ms, max %.3f ms",
+		obs_source_get_name(tr->context),
+		(unsigned long long)prepare.samples,
+		prepare.samples ? prepare.total_ns / prepare.samples / 1000000.0 :
+		0.0, prepare.max_ns / 1000000.0);
+	UNUSED_PARAMETER(cd);
 }
 
 static void *motion_transition_create(obs_data_t *settings, obs_source_t *context)
 {
 	transition_data_t *tr = bzalloc(sizeof(*tr));
+	proc_handler_t *ph = obs_source_get_proc_handler(context);
+
 	tr->context = context;
+	tr->front = &tr->states[0];
+	tr->back = &tr->states[1];
+
+	pthread_mutex_init_value(&tr->prepare_mutex);
+	if (pthread_mutex_init(&tr->prepare_mutex, NULL) != 0)
+		goto fail;
+	if (os_event_init(&tr->prepare_event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail;
+	if (pthread_create(&tr->prepare_thread, NULL, prepare_thread, tr) != 0)
+		goto fail;
+
+	tr->prepare_thread_created = true;
+
+	proc_handler_add(ph, "void prewarm(in ptr source)", prewarm_proc, tr);
+	proc_handler_add(ph, "void get_stats(out int triggers, "
+		"out float active_time, out int setter_calls, "
+		"out int setter_avoided, out int samples, out int avg_ns, "
+		"out int max_ns, out int prepare_samples, "
+		"out int prepare_avg_ns, out int prepare_max_ns)",
+		get_stats_proc, tr);
+	proc_handler_add(ph, "void log_stats()", log_stats_proc, tr);
+	obs_frontend_add_event_callback(preview_scene_changed, tr);
 	UNUSED_PARAMETER(settings);
 	return tr;
+
+fail:
+	blog(LOG_ERROR, "motion-transition: failed to create prepare thread");
+	os_event_destroy(tr->prepare_event);
+	pthread_mutex_destroy(&tr->prepare_mutex);
+	bfree(tr);
+	return NULL;
 }
 
 
 static void motion_transition_destroy(void *data)
 {
 	transition_data_t *tr = data;
+
+	obs_frontend_remove_event_callback(preview_scene_changed, tr);
+
+	if (tr->prepare_thread_created) {
+		os_atomic_set_bool(&tr->prepare_exit, true);
+		os_event_signal(tr->prepare_event);
+		pthread_join(tr->prepare_thread, NULL);
+	}
+
+	release_front_state(tr);
+	release_state(tr->back);
+	free_item_list(&tr->states[0].out_list);
+	free_item_list(&tr->states[0].in_list);
+	free_item_list(&tr->states[1].out_list);
+	free_item_list(&tr->states[1].in_list);
+	release_prewarm(tr);
+	obs_source_release(tr->pending_a);
+	obs_source_release(tr->pending_b);
+	obs_source_release(tr->pending_prewarm);
+	os_event_destroy(tr->prepare_event);
+	pthread_mutex_destroy(&tr->prepare_mutex);
 	bfree(tr);
 }
 
@@ -381,5 +1429,14 @@ struct obs_source_info motion_transition = {
 
 bool obs_module_load(void) {
 	obs_register_source(&motion_transition);
+	trace_start("motion-transition");
+	pool = worker_pool_create("motion-transition");
 	return true;
-}
\ No newline at end of file
+}
+
+void obs_module_unload(void)
+{
+	worker_pool_destroy(pool);
+	pool = NULL;
+	trace_stop();
+}
@@ -0,0 +1,212 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "trace.h"
+#include <stdlib.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#define TRACE_FLUSH_SIZE    (64 * 1024)
+
+static struct {
+	FILE                *file;
+	char                *path;
+	DARRAY(uint8_t)     buffer;
+	pthread_mutex_t     mutex;
+} trace;
+
+bool trace_recording = false;
+
+static inline void put(const void *data, size_t size)
+{
+	da_push_back_array(trace.buffer, (const uint8_t *)data, size);
+}
+
+static inline void put_u8(uint8_t value)
+{
+	put(&value, sizeof(value));
+}
+
+static void put_string(const char *str)
+{
+	size_t len = str ? strlen(str) : 0;
+	uint16_t size = (uint16_t)(len < TRACE_NAME_SIZE ? len :
+		TRACE_NAME_SIZE - 1);
+
+	put(&size, sizeof(size));
+	put(str, size);
+}
+
+static void flush_buffer(void)
+{
+	if (trace.file && trace.buffer.num)
+		fwrite(trace.buffer.array, 1, trace.buffer.num, trace.file);
+	da_resize(trace.buffer, 0);
+}
+
+static inline void end_record(void)
+{
+	if (trace.buffer.num >= TRACE_FLUSH_SIZE)
+		flush_buffer();
+	pthread_mutex_unlock(&trace.mutex);
+}
+
+static inline uint32_t hash_name(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (name && *name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/* Recording */
+
+static bool open_trace(const char *path, const char *module)
+{
+	uint32_t version = TRACE_VERSION;
+
+	trace.file = os_fopen(path, "wb");
+	if (!trace.file)
+		return false;
+
+	put(TRACE_MAGIC, 4);
+	put(&version, sizeof(version));
+	put_string(module);
+	flush_buffer();
+	return true;
+}
+
+bool trace_open(const char *module, const char *path)
+{
+	if (trace.path || pthread_mutex_init(&trace.mutex, NULL) != 0)
+		return false;
+
+	if (!open_trace(path, module)) {
+		blog(LOG_WARNING, "trace: failed to open %s", path);
+		pthread_mutex_destroy(&trace.mutex);
+		return false;
+	}
+
+	blog(LOG_INFO, "trace: recording %s to %s", module, path);
+	trace.path = bstrdup(path);
+	trace_recording = true;
+	return true;
+}
+
+bool trace_start(const char *module)
+{
+	const char *dir = getenv(TRACE_ENV);
+	struct dstr path = { 0 };
+	bool success;
+
+	if (!dir || !*dir)
+		return false;
+
+	dstr_printf(&path, "%s/%s-trace.bin", dir, module);
+	success = trace_open(module, path.array);
+	dstr_free(&path);
+	return success;
+}
+
+void trace_stop(void)
+{
+	if (!trace.path)
+		return;
+
+	pthread_mutex_lock(&trace.mutex);
+	trace_recording = false;
+	flush_buffer();
+	fclose(trace.file);
+	trace.file = NULL;
+	pthread_mutex_unlock(&trace.mutex);
+
+	pthread_mutex_destroy(&trace.mutex);
+	da_free(trace.buffer);
+	bfree(trace.path);
+	trace.path = NULL;
+}
+
+void trace_frame(float seconds)
+{
+	if (!trace_recording)
+		return;
+
+	pthread_mutex_lock(&trace.mutex);
+	put_u8(TRACE_FRAME);
+	put(&seconds, sizeof(seconds));
+	end_record();
+}
+
+void trace_trigger(obs_source_t *scene, obs_source_t *source, bool forward)
+{
+	if (!trace_recording)
+		return;
+
+	pthread_mutex_lock(&trace.mutex);
+	put_u8(TRACE_TRIGGER);
+	put_u8(forward ? 1 : 0);
+	put_string(obs_source_get_name(scene));
+	put_string(obs_source_get_name(source));
+	end_record();
+}
+
+/* A scene switch away from the filter's scene, not a backward trigger. */
+
+void trace_deactivate(obs_source_t *scene, obs_source_t *filter)
+{
+	if (!trace_recording)
+		return;
+
+	pthread_mutex_lock(&trace.mutex);
+	put_u8(TRACE_DEACTIVATE);
+	put_string(obs_source_get_name(scene));
+	put_string(obs_source_get_name(filter));
+	end_record();
+}
+
+void trace_transform(enum trace_record type, obs_sceneitem_t *item,
+	const void *value)
+{
+	obs_source_t *scene = obs_scene_get_source(obs_sceneitem_get_scene(item));
+	uint32_t scene_hash = hash_name(obs_source_get_name(scene));
+	uint32_t id = (uint32_t)obs_sceneitem_get_id(item);
+	size_t size;
+
+	if (type == TRACE_ROT)
+		size = sizeof(float);
+	else if (type == TRACE_CROP)
+		size = sizeof(int32_t) * 4;
+	else
+		size = sizeof(float) * 2;
+
+	pthread_mutex_lock(&trace.mutex);
+	if (trace.file) {
+		put_u8((uint8_t)type);
+		put(&scene_hash, sizeof(scene_hash));
+		put(&id, sizeof(id));
+		put(value, size);
+	}
+	end_record();
+}
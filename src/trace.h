@@ -0,0 +1,113 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * Transform trace. Every trigger, every frame and every transform the
+ * plugin hands to libobs is appended to a binary file:
+ *
+ *   header   "MTRC" u32 version, u16 length, module name
+ *   frame    u8 type, f32 seconds (or transition time)
+ *   trigger  u8 type, u8 forward, u16 length, scene name, u16 length, name
+ *   leave    u8 type, u16 length, scene name, u16 length, filter name
+ *   vec2     u8 type, u32 scene hash, u32 item id, f32 x, f32 y
+ *   rot      u8 type, u32 scene hash, u32 item id, f32 rot
+ *   crop     u8 type, u32 scene hash, u32 item id, 4 x i32
+ *
+ * Numbers are in host byte order. Names, the module name included, are
+ * UTF-8 without a terminator, the u16 length counts bytes and is below
+ * TRACE_NAME_SIZE, longer names are cut. The module name is the one
+ * passed to trace_start or trace_open, "motion-filter" or
+ * "motion-transition". Scene hashes are FNV-1a over the scene name.
+ *
+ * Recording starts when MOTION_EFFECT_TRACE names a directory, the file
+ * is <module>-trace.bin. Traces are replayed offline by motion-replay.
+ */
+
+#define TRACE_ENV           "MOTION_EFFECT_TRACE"
+#define TRACE_MAGIC         "MTRC"
+#define TRACE_VERSION       2
+#define TRACE_NAME_SIZE     256
+
+enum trace_record {
+	TRACE_FRAME = 1,
+	TRACE_TRIGGER = 2,
+	TRACE_POS = 3,
+	TRACE_SCALE = 4,
+	TRACE_BOUNDS = 5,
+	TRACE_ROT = 6,
+	TRACE_CROP = 7,
+	TRACE_DEACTIVATE = 8
+};
+
+extern bool trace_recording;
+
+bool trace_start(const char *module);
+bool trace_open(const char *module, const char *path);
+void trace_stop(void);
+
+void trace_frame(float seconds);
+void trace_trigger(obs_source_t *scene, obs_source_t *source, bool forward);
+void trace_deactivate(obs_source_t *scene, obs_source_t *filter);
+
+void trace_transform(enum trace_record type, obs_sceneitem_t *item,
+	const void *value);
+
+static inline void trace_set_pos(obs_sceneitem_t *item,
+	const struct vec2 *pos)
+{
+	obs_sceneitem_set_pos(item, pos);
+	if (trace_recording)
+		trace_transform(TRACE_POS, item, pos);
+}
+
+static inline void trace_set_scale(obs_sceneitem_t *item,
+	const struct vec2 *scale)
+{
+	obs_sceneitem_set_scale(item, scale);
+	if (trace_recording)
+		trace_transform(TRACE_SCALE, item, scale);
+}
+
+static inline void trace_set_bounds(obs_sceneitem_t *item,
+	const struct vec2 *bounds)
+{
+	obs_sceneitem_set_bounds(item, bounds);
+	if (trace_recording)
+		trace_transform(TRACE_BOUNDS, item, bounds);
+}
+
+static inline void trace_set_rot(obs_sceneitem_t *item, float rot)
+{
+	obs_sceneitem_set_rot(item, rot);
+	if (trace_recording)
+		trace_transform(TRACE_ROT, item, &rot);
+}
+
+static inline void trace_set_crop(obs_sceneitem_t *item,
+	const struct obs_sceneitem_crop *crop)
+{
+	obs_sceneitem_set_crop(item, crop);
+	if (trace_recording)
+		trace_transform(TRACE_CROP, item, crop);
+}
@@ -0,0 +1,162 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "worker-pool.h"
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+struct worker_pool {
+	DARRAY(pthread_t)   threads;
+	char                *name;
+	os_sem_t            *start;
+	os_event_t          *done;
+	pthread_mutex_t     run_mutex;
+	worker_job_t        job;
+	void                *param;
+	size_t              count;
+	size_t              chunk;
+	volatile long       next_chunk;
+	volatile long       running;
+	volatile bool       exit;
+};
+
+static void run_chunks(struct worker_pool *pool)
+{
+	for (;;) {
+		size_t idx = (size_t)(os_atomic_inc_long(&pool->next_chunk) - 1);
+		size_t begin = idx * pool->chunk;
+		size_t end = begin + pool->chunk;
+
+		if (begin >= pool->count)
+			break;
+
+		pool->job(pool->param, begin,
+			end < pool->count ? end : pool->count);
+	}
+}
+
+static void *worker_thread(void *data)
+{
+	struct worker_pool *pool = data;
+
+	os_set_thread_name(pool->name);
+
+	while (os_sem_wait(pool->start) == 0) {
+		if (os_atomic_load_bool(&pool->exit))
+			break;
+
+		run_chunks(pool);
+		if (os_atomic_dec_long(&pool->running) == 0)
+			os_event_signal(pool->done);
+	}
+
+	return NULL;
+}
+
+/* No pool on machines with less than three cores, the caller does it. */
+
+struct worker_pool *worker_pool_create(const char *name)
+{
+	struct worker_pool *pool;
+	int threads = os_get_logical_cores() - 1;
+	int i;
+
+	if (threads < 2)
+		return NULL;
+	if (threads > WORKER_POOL_MAX_THREADS)
+		threads = WORKER_POOL_MAX_THREADS;
+
+	pool = bzalloc(sizeof(*pool));
+	pool->name = bstrdup(name);
+
+	if (os_sem_init(&pool->start, 0) != 0 ||
+		os_event_init(&pool->done, OS_EVENT_TYPE_AUTO) != 0 ||
+		pthread_mutex_init(&pool->run_mutex, NULL) != 0) {
+		blog(LOG_WARNING, "%s: failed to create worker pool", name);
+		os_sem_destroy(pool->start);
+		os_event_destroy(pool->done);
+		bfree(pool->name);
+		bfree(pool);
+		return NULL;
+	}
+
+	for (i = 0; i < threads; i++) {
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, worker_thread, pool) == 0)
+			da_push_back(pool->threads, &thread);
+	}
+
+	blog(LOG_INFO, "%s: %d worker threads", name, (int)pool->threads.num);
+	return pool;
+}
+
+void worker_pool_destroy(struct worker_pool *pool)
+{
+	size_t i;
+
+	if (!pool)
+		return;
+
+	os_atomic_set_bool(&pool->exit, true);
+	for (i = 0; i < pool->threads.num; i++)
+		os_sem_post(pool->start);
+	for (i = 0; i < pool->threads.num; i++)
+		pthread_join(pool->threads.array[i], NULL);
+
+	da_free(pool->threads);
+	os_sem_destroy(pool->start);
+	os_event_destroy(pool->done);
+	pthread_mutex_destroy(&pool->run_mutex);
+	bfree(pool->name);
+	bfree(pool);
+}
+
+void worker_pool_run(struct worker_pool *pool, worker_job_t job, void *param,
+	size_t count, size_t chunk)
+{
+	size_t i;
+
+	if (!count)
+		return;
+
+	if (!pool || !pool->threads.num || count <= chunk) {
+		job(param, 0, count);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->run_mutex);
+
+	pool->job = job;
+	pool->param = param;
+	pool->count = count;
+	pool->chunk = chunk;
+	os_atomic_set_long(&pool->next_chunk, 0);
+	os_atomic_set_long(&pool->running, (long)pool->threads.num);
+
+	for (i = 0; i < pool->threads.num; i++)
+		os_sem_post(pool->start);
+
+	run_chunks(pool);
+	os_event_wait(pool->done);
+
+	pthread_mutex_unlock(&pool->run_mutex);
+}
@@ -0,0 +1,43 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+/*
+ * A few threads that run one range job at a time. The range is cut into
+ * chunks and every thread, the caller included, keeps taking the next
+ * chunk from a shared counter until none is left, so a thread that
+ * finishes early picks up the rest. worker_pool_run returns when the
+ * whole range is done. Jobs smaller than one chunk run on the caller.
+ */
+
+#define WORKER_POOL_MAX_THREADS 4
+
+typedef void (*worker_job_t)(void *param, size_t begin, size_t end);
+
+struct worker_pool;
+
+struct worker_pool *worker_pool_create(const char *name);
+void worker_pool_destroy(struct worker_pool *pool);
+
+void worker_pool_run(struct worker_pool *pool, worker_job_t job, void *param,
+	size_t count, size_t chunk);
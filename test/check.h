@@ -0,0 +1,49 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <stdio.h>
+
+/*
+ * Checks for the test executables. A failed check is reported and counted,
+ * the test keeps going and returns the count from main.
+ */
+
+static int check_failures;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+				__LINE__, #cond); \
+			check_failures++; \
+		} \
+	} while (false)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { \
+		double check_a = (a), check_b = (b); \
+		if (fabs(check_a - check_b) > (tolerance)) { \
+			fprintf(stderr, "%s:%d: %s = %f, expected %f\n", \
+				__FILE__, __LINE__, #a, check_a, check_b); \
+			check_failures++; \
+		} \
+	} while (false)
@@ -0,0 +1,137 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <util/platform.h>
+#include "helper.h"
+#include "curve.h"
+#include "check.h"
+
+/*
+ * curve_eval against the recursive bezier() it replaced, over random
+ * control points of every order, then the cost of both.
+ *
+ * usage: curve-test [--bench]
+ */
+
+#define CURVE_SETS          2000
+#define CURVE_STEPS         64
+#define POINT_RANGE         4000.0f
+#define BENCH_EVALS         1000000
+
+// Relative to the largest control point, a cubic loses a few bits more
+// in the power basis than in de casteljau form
+#define CURVE_TOLERANCE     1e-5
+
+static uint32_t seed = 12345;
+
+static float random_point(void)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return ((float)(seed >> 8) / (1 << 24) - 0.5f) * POINT_RANGE;
+}
+
+static void random_curve(struct curve *curve,
+	float points[4][CURVE_MAX_ORDER + 1], int order)
+{
+	int channel, i;
+
+	curve_init(curve);
+	for (channel = 0; channel < 4; channel++) {
+		for (i = 0; i <= order; i++)
+			points[channel][i] = random_point();
+		curve_set_channel(curve, channel, points[channel], order);
+	}
+}
+
+static void test_order(int order)
+{
+	float points[4][CURVE_MAX_ORDER + 1];
+	double max_error = 0.0;
+	struct curve curve;
+	struct vec4 result;
+	int set, step, channel;
+
+	for (set = 0; set < CURVE_SETS; set++) {
+		random_curve(&curve, points, order);
+
+		for (step = 0; step <= CURVE_STEPS; step++) {
+			float t = (float)step / CURVE_STEPS;
+
+			curve_eval(&curve, t, &result);
+			for (channel = 0; channel < 4; channel++) {
+				double error = fabs(result.ptr[channel] -
+					bezier(points[channel], t, order));
+				if (error > max_error)
+					max_error = error;
+			}
+		}
+	}
+
+	printf("order %d: max error %g\n", order, max_error);
+	CHECK(max_error <= CURVE_TOLERANCE * POINT_RANGE);
+}
+
+static void bench_order(int order)
+{
+	float points[4][CURVE_MAX_ORDER + 1];
+	volatile float sink = 0.0f;
+	struct curve curve;
+	struct vec4 result;
+	uint64_t start, bezier_ns, curve_ns;
+	int i, channel;
+
+	random_curve(&curve, points, order);
+
+	// bezier() is per channel, so one op is all four channels
+	start = os_gettime_ns();
+	for (i = 0; i < BENCH_EVALS; i++) {
+		float t = (float)i / BENCH_EVALS;
+		for (channel = 0; channel < 4; channel++)
+			sink += bezier(points[channel], t, order);
+	}
+	bezier_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	for (i = 0; i < BENCH_EVALS; i++) {
+		curve_eval(&curve, (float)i / BENCH_EVALS, &result);
+		sink += result.x;
+	}
+	curve_ns = os_gettime_ns() - start;
+
+	printf("order %d: bezier %.1f ns, curve_eval %.1f ns per 4 channels\n",
+		order, (double)bezier_ns / BENCH_EVALS,
+		(double)curve_ns / BENCH_EVALS);
+}
+
+int main(int argc, char *argv[])
+{
+	bool bench = argc > 1 && strcmp(argv[1], "--bench") == 0;
+	int order;
+
+	for (order = 1; order <= CURVE_MAX_ORDER; order++)
+		test_order(order);
+
+	for (order = 1; bench && order <= CURVE_MAX_ORDER; order++)
+		bench_order(order);
+
+	return check_failures ? 1 : 0;
+}
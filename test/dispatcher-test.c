@@ -0,0 +1,193 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <math.h>
+#include <obs-stub.h>
+#include <util/platform.h>
+#include "check.h"
+
+/*
+ * Scene switch filters through the scene dispatcher: a switch triggers
+ * the filters of the scene going live, not those of scenes nested in it.
+ */
+
+bool motion_filter_module_load(void);
+void motion_filter_module_unload(void);
+bool motion_transition_module_load(void);
+void motion_transition_module_unload(void);
+
+#define TEST_FRAME          (1.0f / 60.0f)
+#define TEST_LOAD_TIMEOUT   (10 * 60)
+
+static obs_source_t *add_filter(obs_scene_t *scene, const char *name,
+	const char *item)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_source_t *filter;
+
+	obs_data_set_int(settings, "motion_behavior", 3);
+	obs_data_set_int(settings, "variation_type", 1);
+	obs_data_set_int(settings, "path_type", 0);
+	obs_data_set_string(settings, "source_id", item);
+	obs_data_set_int(settings, "start_x", -500);
+	obs_data_set_double(settings, "duration", 0.1);
+
+	filter = obs_source_create_private("motion-filter", name, settings);
+	obs_source_filter_add(obs_scene_get_source(scene), filter);
+	obs_data_release(settings);
+	return filter;
+}
+
+static obs_source_t *add_color(obs_scene_t *scene, const char *name)
+{
+	obs_source_t *source = obs_source_create("color_source", name, NULL,
+		NULL);
+
+	obs_scene_add(scene, source);
+	return source;
+}
+
+static long long triggers(obs_source_t *filter)
+{
+	calldata_t cd = { 0 };
+	long long result;
+
+	proc_handler_call(obs_source_get_proc_handler(filter), "get_stats",
+		&cd);
+	result = calldata_int(&cd, "triggers");
+	calldata_free(&cd);
+	return result;
+}
+
+static void tick_frames(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		obs_stub_tick(TEST_FRAME);
+}
+
+/* Filters connect to their scene on the loader thread after a tick. */
+
+static bool wait_for_dispatcher(obs_scene_t **scenes, size_t count)
+{
+	int frame;
+	size_t i;
+
+	for (frame = 0; frame < TEST_LOAD_TIMEOUT; frame++) {
+		bool ready = true;
+
+		obs_stub_tick(TEST_FRAME);
+		for (i = 0; i < count; i++) {
+			obs_source_t *source = obs_scene_get_source(scenes[i]);
+			ready = ready && obs_stub_signal_connections(
+				obs_source_get_signal_handler(source),
+				"activate");
+		}
+		if (ready)
+			return true;
+		os_sleep_ms(1);
+	}
+	return false;
+}
+
+static void release_filter(obs_scene_t *scene, obs_source_t *filter)
+{
+	obs_source_filter_remove(obs_scene_get_source(scene), filter);
+	obs_source_release(filter);
+}
+
+int main(void)
+{
+	obs_scene_t *inner, *main_scene, *other;
+	obs_source_t *box, *card, *transition;
+	obs_source_t *f_inner, *f_main, *f_other;
+	obs_scene_t *scenes[3];
+
+	obs_stub_startup();
+	CHECK(motion_filter_module_load());
+	CHECK(motion_transition_module_load());
+
+	// Inner is shown by Main, Other shares Main's card
+	inner = obs_scene_create("Inner");
+	main_scene = obs_scene_create("Main");
+	other = obs_scene_create("Other");
+	box = add_color(inner, "Box");
+	card = add_color(main_scene, "Card");
+	obs_scene_add(main_scene, obs_scene_get_source(inner));
+	obs_scene_add(other, card);
+
+	f_inner = add_filter(inner, "Inner motion", "Box");
+	f_main = add_filter(main_scene, "Main motion", "Card");
+	f_other = add_filter(other, "Other motion", "Card");
+
+	scenes[0] = inner;
+	scenes[1] = main_scene;
+	scenes[2] = other;
+	CHECK(wait_for_dispatcher(scenes, 3));
+
+	// Inner goes live with Main but is not switched to
+	obs_stub_set_program(obs_scene_get_source(main_scene));
+	tick_frames(2);
+	CHECK(obs_source_active(obs_scene_get_source(inner)));
+	CHECK(triggers(f_main) == 1);
+	CHECK(triggers(f_inner) == 0);
+	CHECK(triggers(f_other) == 0);
+
+	obs_stub_set_program(obs_scene_get_source(other));
+	tick_frames(2);
+	CHECK(triggers(f_other) == 1);
+	CHECK(triggers(f_main) == 1);
+
+	// A switch to the nested scene itself does trigger it
+	obs_stub_set_program(obs_scene_get_source(inner));
+	tick_frames(2);
+	CHECK(triggers(f_inner) == 1);
+
+	// Through a transition only the destination triggers, the scene it
+	// leaves is activated again as the transition's first source
+	transition = obs_source_create_private("motion-transition", "Motion",
+		NULL);
+	obs_stub_set_program(transition);
+	obs_stub_transition_start(transition, obs_scene_get_source(inner),
+		obs_scene_get_source(main_scene));
+	tick_frames(2);
+	CHECK(triggers(f_main) == 2);
+	CHECK(triggers(f_inner) == 1);
+	CHECK(triggers(f_other) == 1);
+	obs_stub_transition_stop(transition);
+
+	obs_stub_set_program(NULL);
+	obs_source_release(transition);
+	release_filter(inner, f_inner);
+	release_filter(main_scene, f_main);
+	release_filter(other, f_other);
+	obs_scene_release(inner);
+	obs_scene_release(main_scene);
+	obs_scene_release(other);
+	obs_source_release(box);
+	obs_source_release(card);
+
+	motion_transition_module_unload();
+	motion_filter_module_unload();
+	CHECK(obs_stub_source_count() == 0);
+	obs_stub_shutdown();
+	return check_failures ? 1 : 0;
+}
@@ -0,0 +1,290 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <locale.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "motion-expr.h"
+#include "check.h"
+
+static float vars[EXPR_VAR_COUNT] = {
+	[EXPR_T]        = 0.5f,
+	[EXPR_TIME]     = 2.0f,
+	[EXPR_DURATION] = 4.0f,
+	[EXPR_PATH_X]   = 10.0f,
+	[EXPR_PATH_Y]   = 20.0f,
+};
+
+/* Runs "x = <text>" and returns x, or nan when it does not compile. */
+
+static float eval_x(const char *text)
+{
+	struct motion_expr *expr;
+	char program[256], error[128];
+	float out[EXPR_OUT_COUNT] = { 0 };
+
+	snprintf(program, sizeof(program), "x = %s", text);
+	expr = motion_expr_compile(program, error, sizeof(error));
+	if (!expr) {
+		fprintf(stderr, "'%s': %s\n", program, error);
+		return NAN;
+	}
+	motion_expr_eval(expr, vars, out);
+	motion_expr_destroy(expr);
+	return out[EXPR_OUT_X];
+}
+
+static bool compile_fails(const char *text, const char *message)
+{
+	struct motion_expr *expr;
+	char error[128];
+
+	if (!message) {
+		// Statements that do not fit are reported at their end
+		snprintf(error, sizeof(error),
+			"expression too large at offset %d", (int)strlen(text));
+		return compile_fails(text, error);
+	}
+
+	expr = motion_expr_compile(text, error, sizeof(error));
+	motion_expr_destroy(expr);
+	if (!expr && strcmp(error, message) == 0)
+		return true;
+	fprintf(stderr, "'%.40s': got '%s', expected '%s'\n", text,
+		expr ? "no error" : error, message);
+	return false;
+}
+
+static void test_precedence(void)
+{
+	CHECK_NEAR(eval_x("1 + 2 * 3"), 7.0, 0.0001);
+	CHECK_NEAR(eval_x("(1 + 2) * 3"), 9.0, 0.0001);
+	CHECK_NEAR(eval_x("10 - 4 - 3"), 3.0, 0.0001);
+	CHECK_NEAR(eval_x("12 / 3 / 2"), 2.0, 0.0001);
+	CHECK_NEAR(eval_x("7 % 4 * 2"), 6.0, 0.0001);
+	CHECK_NEAR(eval_x("2 ^ 3 ^ 2"), 512.0, 0.0001);
+	CHECK_NEAR(eval_x("2 * t ^ 2"), 0.5, 0.0001);
+	CHECK_NEAR(eval_x("path_x + 40 * t"), 30.0, 0.0001);
+}
+
+static void test_unary_minus(void)
+{
+	CHECK_NEAR(eval_x("-2 ^ 2"), -4.0, 0.0001);
+	CHECK_NEAR(eval_x("2 ^ -1"), 0.5, 0.0001);
+	CHECK_NEAR(eval_x("--t"), 0.5, 0.0001);
+	CHECK_NEAR(eval_x("-(t + 1)"), -1.5, 0.0001);
+	CHECK_NEAR(eval_x("3 - -t"), 3.5, 0.0001);
+	CHECK_NEAR(eval_x("+t"), 0.5, 0.0001);
+}
+
+static void test_constant_folding(void)
+{
+	struct motion_expr *expr;
+	char error[128];
+
+	// A constant subtree ends up as one constant and the store
+	expr = motion_expr_compile("x = 1 + 2 * 3 - min(4, 2) ^ 2", error,
+		sizeof(error));
+	CHECK(expr);
+	if (expr) {
+		CHECK(expr->code.num == 2);
+		CHECK(expr->consts.num == 1);
+		CHECK_NEAR(expr->consts.array[0], 3.0, 0.0001);
+		motion_expr_destroy(expr);
+	}
+
+	// Equal constants share a slot
+	expr = motion_expr_compile("x = t * 2 + 2; y = 2 * pi / pi", error,
+		sizeof(error));
+	CHECK(expr);
+	if (expr) {
+		CHECK(expr->consts.num == 1);
+		CHECK(motion_expr_sets(expr, EXPR_OUT_X));
+		CHECK(motion_expr_sets(expr, EXPR_OUT_Y));
+		CHECK(!motion_expr_sets(expr, EXPR_OUT_W));
+		motion_expr_destroy(expr);
+	}
+}
+
+static void test_function_calls(void)
+{
+	CHECK_NEAR(eval_x("sin(pi / 2)"), 1.0, 0.0001);
+	CHECK_NEAR(eval_x("cos(0)"), 1.0, 0.0001);
+	CHECK_NEAR(eval_x("abs(-3)"), 3.0, 0.0001);
+	CHECK_NEAR(eval_x("sqrt(16)"), 4.0, 0.0001);
+	CHECK_NEAR(eval_x("floor(-t)"), -1.0, 0.0001);
+	CHECK_NEAR(eval_x("pow(2, 10)"), 1024.0, 0.0001);
+	CHECK_NEAR(eval_x("min(t, 0.25)"), 0.25, 0.0001);
+	CHECK_NEAR(eval_x("max(t, 0.25)"), 0.5, 0.0001);
+	CHECK_NEAR(eval_x("lerp(10, 20, t)"), 15.0, 0.0001);
+	CHECK_NEAR(eval_x("clamp(time, 0, 1)"), 1.0, 0.0001);
+	CHECK_NEAR(eval_x("clamp(-time, 0, 1)"), 0.0, 0.0001);
+	CHECK_NEAR(eval_x("max(min(t, 1), lerp(0, 1, t * t))"), 0.5, 0.0001);
+	CHECK(fabsf(eval_x("noise(time)")) <= 1.0f);
+}
+
+static void nest(char *text, size_t size, int count, const char *open,
+	const char *middle, const char *close)
+{
+	int i;
+
+	*text = 0;
+	strncat(text, "x = ", size - strlen(text) - 1);
+	for (i = 0; i < count; i++)
+		strncat(text, open, size - strlen(text) - 1);
+	strncat(text, middle, size - strlen(text) - 1);
+	for (i = 0; i < count; i++)
+		strncat(text, close, size - strlen(text) - 1);
+}
+
+static void test_limits(void)
+{
+	struct motion_expr *expr;
+	char text[4096], error[128];
+	int i;
+
+	// The statement itself takes one level, parentheses one each
+	nest(text, sizeof(text), 63, "(", "t", ")");
+	expr = motion_expr_compile(text, error, sizeof(error));
+	CHECK(expr);
+	motion_expr_destroy(expr);
+	nest(text, sizeof(text), 64, "(", "t", ")");
+	CHECK(compile_fails(text, "expression too deep at offset 68"));
+
+	// Every right nested sum keeps one more value on the stack
+	nest(text, sizeof(text), EXPR_MAX_STACK - 1, "t + (", "t", ")");
+	expr = motion_expr_compile(text, error, sizeof(error));
+	CHECK(expr);
+	if (expr) {
+		float out[EXPR_OUT_COUNT] = { 0 };
+		motion_expr_eval(expr, vars, out);
+		CHECK_NEAR(out[EXPR_OUT_X], EXPR_MAX_STACK * 0.5, 0.0001);
+		motion_expr_destroy(expr);
+	}
+	nest(text, sizeof(text), EXPR_MAX_STACK, "t + (", "t", ")");
+	CHECK(compile_fails(text, NULL));
+
+	// Products with a variable are not folded, each keeps its constant
+	strcpy(text, "x = 0");
+	for (i = 1; i < 256; i++)
+		snprintf(text + strlen(text), sizeof(text) - strlen(text),
+			" + t * %d", i);
+	expr = motion_expr_compile(text, error, sizeof(error));
+	CHECK(expr);
+	if (expr) {
+		CHECK(expr->consts.num == 256);
+		motion_expr_destroy(expr);
+	}
+	snprintf(text + strlen(text), sizeof(text) - strlen(text), " + t * 256");
+	CHECK(compile_fails(text, NULL));
+}
+
+static void test_parse_errors(void)
+{
+	struct motion_expr *expr;
+	char error[128] = "stale";
+
+	CHECK(compile_fails("x = ", "expected a value at offset 4"));
+	CHECK(compile_fails("x = 1 +", "expected a value at offset 7"));
+	CHECK(compile_fails("x = (1", "expected ')' at offset 6"));
+	CHECK(compile_fails("x = foo(1)", "unknown function 'foo' at offset 8"));
+	CHECK(compile_fails("x = bar", "unknown variable 'bar' at offset 7"));
+	CHECK(compile_fails("x = min(1)", "'min' takes 2 arguments at offset 9"));
+	CHECK(compile_fails("x = sin(1, 2)",
+		"too many arguments to 'sin' at offset 10"));
+	CHECK(compile_fails("z = 1", "unknown output 'z' at offset 1"));
+	CHECK(compile_fails("x 1", "expected '=' at offset 2"));
+	CHECK(compile_fails("x = 1 y = 2", "expected ';' at offset 6"));
+	CHECK(compile_fails("= 1", "expected x, y, w or h at offset 0"));
+	CHECK(compile_fails("x = .", "bad number at offset 4"));
+
+	// Nothing to run is not an error
+	expr = motion_expr_compile(" ;\n; ", error, sizeof(error));
+	CHECK(!expr);
+	CHECK(error[0] == 0);
+}
+
+static void test_non_finite_store(void)
+{
+	struct motion_expr *expr;
+	float out[EXPR_OUT_COUNT] = {1.0f, 2.0f, 3.0f, 4.0f};
+	float zero[EXPR_VAR_COUNT] = { 0 };
+	char error[128];
+
+	expr = motion_expr_compile("x = 1 / t; y = sqrt(t - 1); w = t + 5",
+		error, sizeof(error));
+	CHECK(expr);
+	if (!expr)
+		return;
+
+	// Division by zero and nan keep the path values
+	motion_expr_eval(expr, zero, out);
+	CHECK_NEAR(out[EXPR_OUT_X], 1.0, 0.0001);
+	CHECK_NEAR(out[EXPR_OUT_Y], 2.0, 0.0001);
+	CHECK_NEAR(out[EXPR_OUT_W], 5.0, 0.0001);
+	CHECK_NEAR(out[EXPR_OUT_H], 4.0, 0.0001);
+
+	motion_expr_eval(expr, vars, out);
+	CHECK_NEAR(out[EXPR_OUT_X], 2.0, 0.0001);
+	CHECK_NEAR(out[EXPR_OUT_Y], 2.0, 0.0001);
+	motion_expr_destroy(expr);
+}
+
+static void test_numbers(void)
+{
+	static const char *locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE",
+		"fr_FR", "ru_RU.UTF-8"};
+	const char *locale = NULL;
+	size_t i;
+
+	// Numbers use '.' whatever the locale says
+	for (i = 0; i < sizeof(locales) / sizeof(locales[0]) && !locale; i++)
+		locale = setlocale(LC_NUMERIC, locales[i]);
+	if (!locale)
+		printf("no comma locale installed, checking in \"C\"\n");
+
+	CHECK_NEAR(eval_x("40.5"), 40.5, 0.0001);
+	CHECK_NEAR(eval_x(".25 + 1."), 1.25, 0.0001);
+	CHECK_NEAR(eval_x("1.5e2"), 150.0, 0.0001);
+	CHECK_NEAR(eval_x("25E-1"), 2.5, 0.0001);
+	CHECK_NEAR(eval_x("007"), 7.0, 0.0001);
+	CHECK_NEAR(eval_x("0.1 * 3"), 0.3, 0.0001);
+	CHECK_NEAR(eval_x("123456789012345678901234"), 1.2345679e23, 1e17);
+	CHECK_NEAR(eval_x("min(1e400, 5)"), 5.0, 0.0001);
+	CHECK_NEAR(eval_x("1e-400 + 1"), 1.0, 0.0001);
+	CHECK(compile_fails("x = 2e", "expected ';' at offset 5"));
+	CHECK(compile_fails("x = 1,5", "expected ';' at offset 5"));
+
+	setlocale(LC_NUMERIC, "C");
+}
+
+int main(void)
+{
+	test_precedence();
+	test_unary_minus();
+	test_constant_folding();
+	test_function_calls();
+	test_limits();
+	test_parse_errors();
+	test_non_finite_store();
+	test_numbers();
+	return check_failures ? 1 : 0;
+}
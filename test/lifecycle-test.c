@@ -0,0 +1,186 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <obs-stub.h>
+#include <util/platform.h>
+#include "check.h"
+
+/*
+ * Filters removed from their scene, with commands still in flight or in
+ * the middle of a motion, and added back. Items removed from under an
+ * idle filter.
+ */
+
+bool motion_filter_module_load(void);
+void motion_filter_module_unload(void);
+
+#define TEST_FRAME          (1.0f / 60.0f)
+#define TEST_LOAD_TIMEOUT   (10 * 60)
+
+static obs_source_t *create_filter(const char *name, const char *item)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_source_t *filter;
+
+	obs_data_set_int(settings, "motion_behavior", 2);
+	obs_data_set_int(settings, "variation_type", 1);
+	obs_data_set_int(settings, "path_type", 0);
+	obs_data_set_string(settings, "source_id", item);
+	obs_data_set_int(settings, "start_x", -500);
+	obs_data_set_double(settings, "duration", 0.5);
+
+	filter = obs_source_create_private("motion-filter", name, settings);
+	obs_data_release(settings);
+	return filter;
+}
+
+static long long triggers(obs_source_t *filter)
+{
+	calldata_t cd = { 0 };
+	long long result;
+
+	proc_handler_call(obs_source_get_proc_handler(filter), "get_stats",
+		&cd);
+	result = calldata_int(&cd, "triggers");
+	calldata_free(&cd);
+	return result;
+}
+
+static void tick_frames(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		obs_stub_tick(TEST_FRAME);
+}
+
+/* Hotkeys are registered on the loader thread after a tick. */
+
+static obs_hotkey_id wait_for_hotkey(obs_source_t *filter)
+{
+	obs_hotkey_id id = OBS_INVALID_HOTKEY_ID;
+	int frame;
+
+	for (frame = 0; frame < TEST_LOAD_TIMEOUT; frame++) {
+		obs_stub_tick(TEST_FRAME);
+		id = obs_stub_find_hotkey(obs_obj_get_data(filter), 0);
+		if (id != OBS_INVALID_HOTKEY_ID)
+			break;
+		os_sleep_ms(1);
+	}
+	return id;
+}
+
+static float item_x(obs_sceneitem_t *item)
+{
+	struct vec2 pos;
+
+	obs_sceneitem_get_pos(item, &pos);
+	return pos.x;
+}
+
+int main(void)
+{
+	obs_scene_t *scene;
+	obs_source_t *box, *card, *filter, *scene_source;
+	obs_weak_source_t *weak_card;
+	obs_sceneitem_t *item;
+	signal_handler_t *signals;
+	obs_hotkey_id id;
+	float x;
+
+	obs_stub_startup();
+	CHECK(motion_filter_module_load());
+
+	scene = obs_scene_create("Main");
+	scene_source = obs_scene_get_source(scene);
+	signals = obs_source_get_signal_handler(scene_source);
+	box = obs_source_create("color_source", "Box", NULL, NULL);
+	item = obs_scene_add(scene, box);
+	filter = create_filter("Motion", "Box");
+
+	obs_source_filter_add(scene_source, filter);
+	id = wait_for_hotkey(filter);
+	CHECK(id != OBS_INVALID_HOTKEY_ID);
+
+	// A trigger posted before the remove does not start the motion
+	CHECK(obs_stub_press_hotkey(id));
+	obs_source_filter_remove(scene_source, filter);
+	tick_frames(2);
+	CHECK(triggers(filter) == 0);
+	CHECK(item_x(item) == 0.0f);
+	CHECK(obs_stub_signal_connections(signals, "item_remove") == 0);
+
+	obs_source_release(filter);
+
+	// Removed in the middle of a motion, torn down on the next tick and
+	// not moved any further
+	filter = create_filter("Motion 2", "Box");
+	obs_source_filter_add(scene_source, filter);
+	id = wait_for_hotkey(filter);
+	CHECK(obs_stub_press_hotkey(id));
+	tick_frames(5);
+	CHECK(triggers(filter) == 1);
+	obs_source_filter_remove(scene_source, filter);
+	CHECK(obs_stub_signal_connections(signals, "item_remove") == 1);
+	tick_frames(1);
+	CHECK(obs_stub_signal_connections(signals, "item_remove") == 0);
+	x = item_x(item);
+	tick_frames(30);
+	CHECK(item_x(item) == x);
+
+	// Added back, as undo does, the filter registers its hotkeys again
+	obs_source_filter_add(scene_source, filter);
+	id = wait_for_hotkey(filter);
+	CHECK(id != OBS_INVALID_HOTKEY_ID);
+	CHECK(obs_stub_press_hotkey(id));
+	tick_frames(2);
+	CHECK(triggers(filter) == 2);
+	obs_source_filter_remove(scene_source, filter);
+	tick_frames(1);
+	obs_source_release(filter);
+
+	// An idle filter lets go of its item once the item is removed
+	card = obs_source_create("color_source", "Card", NULL, NULL);
+	weak_card = obs_source_get_weak_source(card);
+	item = obs_scene_add(scene, card);
+	obs_source_release(card);
+	filter = create_filter("Motion 3", "Card");
+	obs_source_filter_add(scene_source, filter);
+	CHECK(wait_for_hotkey(filter) != OBS_INVALID_HOTKEY_ID);
+	tick_frames(2);
+	obs_sceneitem_remove(item);
+	tick_frames(1);
+	card = obs_weak_source_get_source(weak_card);
+	CHECK(!card);
+	obs_source_release(card);
+	obs_weak_source_release(weak_card);
+	obs_source_filter_remove(scene_source, filter);
+	tick_frames(1);
+	obs_source_release(filter);
+
+	obs_scene_release(scene);
+	obs_source_release(box);
+
+	motion_filter_module_unload();
+	CHECK(obs_stub_source_count() == 0);
+	obs_stub_shutdown();
+	return check_failures ? 1 : 0;
+}
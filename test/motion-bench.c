@@ -0,0 +1,523 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <obs-stub.h>
+#include <obs-scene.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include "helper.h"
+#include "curve.h"
+#include "motion-expr.h"
+#include "motion-scheduler.h"
+
+/*
+ * Benchmarks of both plugins on top of obs-stub, written as one JSON
+ * report:
+ *
+ * { "module": "motion-bench", "obs_version": ..., "results": [
+ *   { "name": ..., "size": ..., "ops": ..., "total_ns": ...,
+ *     "ns_per_op": ... } ] }
+ *
+ * usage: motion-bench [--quick] [--verbose] [report.json]
+ */
+
+bool motion_filter_module_load(void);
+void motion_filter_module_unload(void);
+bool motion_transition_module_load(void);
+void motion_transition_module_unload(void);
+
+#define BENCH_FRAME         (1.0f / 60.0f)
+#define BENCH_LOAD_TIMEOUT  (10 * 60)
+
+static const int filter_sizes[] = { 1, 10, 100, 1000 };
+static const int item_sizes[] = { 10, 100, 500, 1000, 2000 };
+
+static struct {
+	obs_data_t          *report;
+	obs_data_array_t    *results;
+	bool                quick;
+	int                 curve_evals;
+	int                 frames;
+} bench;
+
+static void report_add(const char *name, int64_t size, uint64_t ops,
+	uint64_t total_ns)
+{
+	obs_data_t *result = obs_data_create();
+	double per_op = ops ? (double)total_ns / ops : 0.0;
+
+	obs_data_set_string(result, "name", name);
+	obs_data_set_int(result, "size", size);
+	obs_data_set_int(result, "ops", (long long)ops);
+	obs_data_set_int(result, "total_ns", (long long)total_ns);
+	obs_data_set_double(result, "ns_per_op", per_op);
+	obs_data_array_push_back(bench.results, result);
+	obs_data_release(result);
+
+	printf("%-24s %6lld %14.1f ns/op\n", name, (long long)size, per_op);
+}
+
+/*
+ * A scene of count small color sources named "<prefix> <index>" on a
+ * grid. Scenes built with the same prefix share their sources.
+ */
+
+static obs_scene_t *create_scene(const char *name, const char *prefix,
+	int count)
+{
+	obs_scene_t *scene = obs_scene_create(name);
+	obs_data_t *settings = obs_data_create();
+	struct dstr item_name = { 0 };
+	int i;
+
+	obs_data_set_int(settings, "width", 32);
+	obs_data_set_int(settings, "height", 32);
+
+	for (i = 0; i < count; i++) {
+		obs_source_t *source;
+		obs_sceneitem_t *item;
+		struct vec2 pos;
+
+		dstr_printf(&item_name, "%s %d", prefix, i);
+		source = obs_get_source_by_name(item_name.array);
+		if (!source)
+			source = obs_source_create("color_source",
+				item_name.array, settings, NULL);
+
+		item = obs_scene_add(scene, source);
+		vec2_set(&pos, (float)(i % 40) * 48.0f, (float)(i / 40) * 48.0f);
+		obs_sceneitem_set_pos(item, &pos);
+		obs_source_release(source);
+	}
+
+	dstr_free(&item_name);
+	obs_data_release(settings);
+	return scene;
+}
+
+static void remove_sources(const char *prefix, int count)
+{
+	struct dstr name = { 0 };
+	int i;
+
+	for (i = 0; i < count; i++) {
+		obs_source_t *source;
+
+		dstr_printf(&name, "%s %d", prefix, i);
+		source = obs_get_source_by_name(name.array);
+		obs_source_remove(source);
+		obs_source_release(source);
+	}
+	dstr_free(&name);
+}
+
+/* Curves */
+
+static void bench_curves(void)
+{
+	float point[4] = { 0.0f, 300.0f, -200.0f, 600.0f };
+	volatile float sink = 0.0f;
+	int evals = bench.curve_evals;
+	struct motion_expr *expr;
+	float vars[EXPR_VAR_COUNT], out[EXPR_OUT_COUNT];
+	struct curve curve;
+	struct vec4 result;
+	char error[256];
+	uint64_t start;
+	int order, i;
+
+	for (order = 1; order <= CURVE_MAX_ORDER; order++) {
+		start = os_gettime_ns();
+		for (i = 0; i < evals; i++)
+			sink += bezier(point, (float)i / evals, order);
+		report_add("bezier", order, evals, os_gettime_ns() - start);
+	}
+
+	curve_init(&curve);
+	for (i = 0; i < 4; i++)
+		curve_set_channel(&curve, i, point, CURVE_MAX_ORDER);
+
+	start = os_gettime_ns();
+	for (i = 0; i < evals; i++) {
+		curve_eval(&curve, (float)i / evals, &result);
+		sink += result.x;
+	}
+	report_add("curve_eval", CURVE_MAX_ORDER, evals,
+		os_gettime_ns() - start);
+
+	// The same cubic as above, run through the expression VM
+	expr = motion_expr_compile("x = 900 * t * (1 - t) ^ 2 - "
+		"600 * t ^ 2 * (1 - t) + 600 * t ^ 3", error, sizeof(error));
+	if (!expr) {
+		fprintf(stderr, "expression: %s\n", error);
+		return;
+	}
+
+	memset(vars, 0, sizeof(vars));
+	start = os_gettime_ns();
+	for (i = 0; i < evals; i++) {
+		vars[EXPR_T] = (float)i / evals;
+		motion_expr_eval(expr, vars, out);
+		sink += out[EXPR_OUT_X];
+	}
+	report_add("expression", CURVE_MAX_ORDER, evals,
+		os_gettime_ns() - start);
+	motion_expr_destroy(expr);
+}
+
+/* Filters */
+
+static bool hotkeys_ready(obs_source_t **filters, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		void *data = obs_obj_get_data(filters[i]);
+		if (obs_stub_find_hotkey(data, 0) == OBS_INVALID_HOTKEY_ID)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * One filter per item, all moving at once. Reports the time to press
+ * every forward hotkey and the cost of a whole tick with count motions
+ * running.
+ */
+
+static void bench_filters(int count)
+{
+	obs_scene_t *scene = create_scene("filter-bench", "filter-bench", count);
+	obs_source_t *scene_source = obs_scene_get_source(scene);
+	obs_data_t *settings = obs_data_create();
+	DARRAY(obs_source_t *) filters = { 0 };
+	struct motion_scheduler_stats before, after;
+	struct dstr name = { 0 };
+	uint64_t start;
+	size_t i;
+	int frame;
+
+	obs_data_set_int(settings, "motion_behavior", 1);
+	obs_data_set_int(settings, "variation_type", 3);
+	obs_data_set_int(settings, "path_type", 2);
+	obs_data_set_int(settings, "ctrl_x", 300);
+	obs_data_set_int(settings, "ctrl2_y", 300);
+	obs_data_set_int(settings, "dst_x", 600);
+	obs_data_set_int(settings, "dst_y", 600);
+	obs_data_set_int(settings, "dst_w", 64);
+	obs_data_set_int(settings, "dst_h", 64);
+	obs_data_set_double(settings, "duration", 60000.0);
+
+	for (i = 0; i < (size_t)count; i++) {
+		obs_source_t *filter;
+
+		dstr_printf(&name, "filter-bench %d", (int)i);
+		obs_data_set_string(settings, "source_id", name.array);
+		filter = obs_source_create_private("motion-filter", name.array,
+			settings);
+		obs_source_filter_add(scene_source, filter);
+		da_push_back(filters, &filter);
+	}
+
+	// Hotkeys are registered by the loader thread after the first tick
+	for (frame = 0; frame < BENCH_LOAD_TIMEOUT; frame++) {
+		obs_stub_tick(BENCH_FRAME);
+		if (hotkeys_ready(filters.array, filters.num))
+			break;
+		os_sleep_ms(1);
+	}
+
+	if (frame == BENCH_LOAD_TIMEOUT) {
+		fprintf(stderr, "filters: hotkeys of %d filters not registered\n",
+			count);
+	} else {
+		start = os_gettime_ns();
+		for (i = 0; i < filters.num; i++) {
+			void *data = obs_obj_get_data(filters.array[i]);
+			obs_stub_press_hotkey(obs_stub_find_hotkey(data, 0));
+		}
+		report_add("filter_trigger", count, filters.num,
+			os_gettime_ns() - start);
+
+		motion_scheduler_get_stats(&before);
+		start = os_gettime_ns();
+		for (frame = 0; frame < bench.frames; frame++)
+			obs_stub_tick(BENCH_FRAME);
+		report_add("filter_tick", count, bench.frames,
+			os_gettime_ns() - start);
+
+		// The scheduler's own share of the tick
+		motion_scheduler_get_stats(&after);
+		report_add("filter_pass", count, after.passes - before.passes,
+			after.total_pass_ns - before.total_pass_ns);
+		if (after.active != (size_t)count)
+			fprintf(stderr, "filters: %d of %d motions running\n",
+				(int)after.active, count);
+	}
+
+	for (i = 0; i < filters.num; i++) {
+		obs_source_filter_remove(scene_source, filters.array[i]);
+		obs_source_release(filters.array[i]);
+	}
+
+	da_free(filters);
+	dstr_free(&name);
+	obs_data_release(settings);
+	obs_scene_release(scene);
+	remove_sources("filter-bench", count);
+}
+
+/* Transitions */
+
+static bool move_item(obs_scene_t *scene, obs_sceneitem_t *item, void *data)
+{
+	struct vec2 pos, scale;
+
+	obs_sceneitem_get_pos(item, &pos);
+	vec2_set(&pos, pos.y + 100.0f, pos.x + 50.0f);
+	vec2_set(&scale, 1.5f, 1.5f);
+	obs_sceneitem_set_pos(item, &pos);
+	obs_sceneitem_set_scale(item, &scale);
+
+	UNUSED_PARAMETER(scene);
+	UNUSED_PARAMETER(data);
+	return true;
+}
+
+static long long transition_samples(obs_source_t *transition)
+{
+	calldata_t cd = { 0 };
+	long long samples;
+
+	proc_handler_call(obs_source_get_proc_handler(transition), "get_stats",
+		&cd);
+	samples = calldata_int(&cd, "samples");
+	calldata_free(&cd);
+	return samples;
+}
+
+/*
+ * A transition between two scenes of the same sources laid out apart.
+ * The start latency runs from the start of the transition to the first
+ * frame that moves items, which includes the prepare thread duplicating
+ * and matching both scenes.
+ */
+
+static void bench_transition(int count)
+{
+	obs_scene_t *scene_a = create_scene("transition-a", "transition-bench",
+		count);
+	obs_scene_t *scene_b = create_scene("transition-b", "transition-bench",
+		count);
+	obs_source_t *transition = obs_source_create_private(
+		"motion-transition", "transition-bench", NULL);
+	long long samples = transition_samples(transition);
+	uint64_t start, timeout;
+	int frame;
+
+	obs_scene_enum_items(scene_b, move_item, NULL);
+	obs_stub_set_program(obs_scene_get_source(scene_a));
+
+	start = os_gettime_ns();
+	timeout = start + 10000000000ULL;
+	obs_stub_transition_start(transition, obs_scene_get_source(scene_a),
+		obs_scene_get_source(scene_b));
+
+	while (transition_samples(transition) == samples &&
+		os_gettime_ns() < timeout) {
+		obs_stub_tick(0.0f);
+		obs_stub_transition_render(transition, 0.01f);
+	}
+	report_add("transition_start", count, 1, os_gettime_ns() - start);
+
+	start = os_gettime_ns();
+	for (frame = 1; frame <= bench.frames; frame++) {
+		obs_stub_tick(BENCH_FRAME);
+		obs_stub_transition_render(transition,
+			(float)frame / (bench.frames + 1));
+	}
+	report_add("transition_frame", count, bench.frames,
+		os_gettime_ns() - start);
+
+	obs_stub_transition_stop(transition);
+	obs_stub_set_program(NULL);
+	obs_source_release(transition);
+	obs_scene_release(scene_a);
+	obs_scene_release(scene_b);
+	remove_sources("transition-bench", count);
+}
+
+/* Transform commits */
+
+struct commit_frame {
+	DARRAY(obs_sceneitem_t *) items;
+	int                 frame;
+};
+
+static void commit_item(obs_sceneitem_t *item, int frame, int index)
+{
+	float t = (float)((frame + index) % 60) / 60.0f;
+	struct obs_sceneitem_crop crop = { (int)(t * 8), (int)(t * 4), 0, 0 };
+	struct vec2 pos, scale, bounds;
+
+	vec2_set(&pos, t * 1920.0f, t * 1080.0f);
+	vec2_set(&scale, 1.0f + t, 1.0f + t);
+	vec2_set(&bounds, 32.0f + t * 64.0f, 32.0f + t * 64.0f);
+	obs_sceneitem_set_pos(item, &pos);
+	obs_sceneitem_set_scale(item, &scale);
+	obs_sceneitem_set_bounds(item, &bounds);
+	obs_sceneitem_set_crop(item, &crop);
+	obs_sceneitem_set_rot(item, t * 360.0f);
+}
+
+// Same lock and defer structure as commit_item_transforms
+static void commit_batched(void *data, obs_scene_t *scene)
+{
+	struct commit_frame *commit = data;
+	size_t i;
+
+	for (i = 0; i < commit->items.num; i++) {
+		obs_sceneitem_t *item = commit->items.array[i];
+
+		obs_sceneitem_defer_update_begin(item);
+		commit_item(item, commit->frame, (int)i);
+		obs_sceneitem_defer_update_end(item);
+	}
+
+	UNUSED_PARAMETER(scene);
+}
+
+static bool collect_item(obs_scene_t *scene, obs_sceneitem_t *item,
+	void *data)
+{
+	struct commit_frame *commit = data;
+
+	da_push_back(commit->items, &item);
+
+	UNUSED_PARAMETER(scene);
+	return true;
+}
+
+static void transform_listener(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(cd);
+}
+
+/*
+ * The render thread cost of committing five transform channels of every
+ * item per frame, with a listener on "item_transform" as the UI has.
+ * commit_per_setter rebuilds and signals the transform on each setter,
+ * commit_batched is what the transition does since the commit was
+ * batched: one scene lock and one rebuild per item.
+ */
+
+static void bench_commit(int count)
+{
+	obs_scene_t *scene = create_scene("commit-bench", "commit-bench", count);
+	signal_handler_t *signals = obs_source_get_signal_handler(
+		obs_scene_get_source(scene));
+	struct commit_frame commit = { 0 };
+	uint64_t start;
+	size_t i;
+
+	obs_scene_enum_items(scene, collect_item, &commit);
+	signal_handler_connect(signals, "item_transform", transform_listener,
+		NULL);
+
+	start = os_gettime_ns();
+	for (commit.frame = 0; commit.frame < bench.frames; commit.frame++) {
+		for (i = 0; i < commit.items.num; i++)
+			commit_item(commit.items.array[i], commit.frame, (int)i);
+	}
+	report_add("commit_per_setter", count, bench.frames,
+		os_gettime_ns() - start);
+
+	start = os_gettime_ns();
+	for (commit.frame = 0; commit.frame < bench.frames; commit.frame++)
+		obs_scene_atomic_update(scene, commit_batched, &commit);
+	report_add("commit_batched", count, bench.frames,
+		os_gettime_ns() - start);
+
+	signal_handler_disconnect(signals, "item_transform", transform_listener,
+		NULL);
+	da_free(commit.items);
+	obs_scene_release(scene);
+	remove_sources("commit-bench", count);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *file = "motion-bench.json";
+	size_t filter_count = sizeof(filter_sizes) / sizeof(int);
+	size_t item_count = sizeof(item_sizes) / sizeof(int);
+	bool success;
+	size_t i;
+	int arg;
+
+	for (arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--quick") == 0)
+			bench.quick = true;
+		else if (strcmp(argv[arg], "--verbose") == 0)
+			obs_stub_set_log_level(LOG_DEBUG);
+		else
+			file = argv[arg];
+	}
+
+	bench.curve_evals = bench.quick ? 10000 : 1000000;
+	bench.frames = bench.quick ? 10 : 120;
+	if (bench.quick) {
+		filter_count = 2;
+		item_count = 2;
+	}
+
+	obs_stub_startup();
+	if (!motion_filter_module_load() || !motion_transition_module_load()) {
+		fprintf(stderr, "failed to load the modules\n");
+		return 1;
+	}
+
+	bench.report = obs_data_create();
+	bench.results = obs_data_array_create();
+	obs_data_set_string(bench.report, "module", "motion-bench");
+	obs_data_set_string(bench.report, "obs_version",
+		obs_get_version_string());
+
+	bench_curves();
+	for (i = 0; i < filter_count; i++)
+		bench_filters(filter_sizes[i]);
+	for (i = 0; i < item_count; i++)
+		bench_transition(item_sizes[i]);
+	for (i = 0; i < item_count; i++)
+		bench_commit(item_sizes[i]);
+
+	obs_data_set_array(bench.report, "results", bench.results);
+	success = obs_data_save_json(bench.report, file);
+	if (!success)
+		fprintf(stderr, "failed to write %s\n", file);
+
+	obs_data_array_release(bench.results);
+	obs_data_release(bench.report);
+	motion_transition_module_unload();
+	motion_filter_module_unload();
+	obs_stub_shutdown();
+	return success ? 0 : 1;
+}
@@ -0,0 +1,531 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <stdlib.h>
+#include <obs-stub.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include "trace-reader.h"
+
+/*
+ * Replays a transform trace headless, on top of obs-stub.
+ *
+ * usage: motion-replay [--tolerance <value>] [--record <module>]
+ *                      [--verbose] <collection.json> <trace>
+ *
+ * The scene collection is loaded as OBS saves it. The recorded triggers
+ * are fed back in order: hotkeys for filters, program changes for filters
+ * that trigger on scene switch and for scenes switched away from, and
+ * starts for transitions. Filters tick
+ * with the recorded deltas and transitions render at the recorded times.
+ * The result is written to <trace>.replay and compared with the trace,
+ * the exit code is 1 when any record differs by more than the tolerance.
+ *
+ * With --record the module runs a fixed script on the collection instead
+ * and writes it to <trace>, a reference that needs no OBS to record.
+ */
+
+bool motion_filter_module_load(void);
+void motion_filter_module_unload(void);
+bool motion_transition_module_load(void);
+void motion_transition_module_unload(void);
+
+#define REPLAY_FRAME        (1.0f / 60.0f)
+#define REPLAY_LOAD_TIMEOUT (10 * 60)
+#define REPLAY_STEPS        30
+#define PREPARE_TIMEOUT_NS  10000000000ULL
+#define BEHAVIOR_SCENE_SWITCH 3
+
+static struct {
+	DARRAY(obs_source_t *) sources;
+	DARRAY(obs_source_t *) transitions;
+	obs_source_t        *transition;
+	obs_source_t        *running;
+	obs_source_t        *scene;
+} replay;
+
+/* Collection */
+
+static void add_source(void *data, obs_source_t *source)
+{
+	obs_source_addref(source);
+	da_push_back(replay.sources, &source);
+	UNUSED_PARAMETER(data);
+}
+
+static obs_source_t *find_transition(const char *name)
+{
+	size_t i;
+
+	for (i = 0; name && i < replay.transitions.num; i++) {
+		obs_source_t *transition = replay.transitions.array[i];
+		if (strcmp(obs_source_get_name(transition), name) == 0)
+			return transition;
+	}
+	return NULL;
+}
+
+static void load_transitions(obs_data_array_t *array)
+{
+	size_t i;
+
+	for (i = 0; i < obs_data_array_count(array); i++) {
+		obs_data_t *data = obs_data_array_item(array, i);
+		obs_data_t *settings = obs_data_get_obj(data, "settings");
+		obs_source_t *transition = obs_source_create_private(
+			obs_data_get_string(data, "id"),
+			obs_data_get_string(data, "name"), settings);
+
+		if (transition)
+			da_push_back(replay.transitions, &transition);
+		obs_data_release(settings);
+		obs_data_release(data);
+	}
+}
+
+static bool load_collection(const char *path)
+{
+	obs_data_t *collection = obs_data_create_from_json_file(path);
+	obs_data_array_t *sources, *transitions;
+	obs_source_t *scene;
+
+	if (!collection)
+		return false;
+
+	sources = obs_data_get_array(collection, "sources");
+	obs_load_sources(sources, add_source, NULL);
+	obs_data_array_release(sources);
+
+	transitions = obs_data_get_array(collection, "transitions");
+	load_transitions(transitions);
+	obs_data_array_release(transitions);
+
+	replay.transition = find_transition(obs_data_get_string(collection,
+		"current_transition"));
+	if (!replay.transition && replay.transitions.num)
+		replay.transition = replay.transitions.array[0];
+	obs_stub_set_transition(replay.transition);
+
+	scene = obs_get_source_by_name(obs_data_get_string(collection,
+		"current_program_scene"));
+	obs_stub_set_program(scene);
+	replay.scene = scene;
+
+	obs_data_release(collection);
+	return true;
+}
+
+static void free_collection(void)
+{
+	size_t i;
+
+	obs_stub_set_program(NULL);
+	obs_stub_set_transition(NULL);
+	obs_source_release(replay.scene);
+
+	for (i = 0; i < replay.transitions.num; i++)
+		obs_source_release(replay.transitions.array[i]);
+	for (i = 0; i < replay.sources.num; i++) {
+		obs_source_remove(replay.sources.array[i]);
+		obs_source_release(replay.sources.array[i]);
+	}
+
+	da_free(replay.transitions);
+	da_free(replay.sources);
+}
+
+/* Filters */
+
+static bool is_motion_filter(obs_source_t *filter)
+{
+	return strcmp(obs_source_get_id(filter), "motion-filter") == 0;
+}
+
+static bool scene_switch(obs_source_t *filter)
+{
+	obs_data_t *settings = obs_source_get_settings(filter);
+	bool result = obs_data_get_int(settings, "motion_behavior") ==
+		BEHAVIOR_SCENE_SWITCH;
+
+	obs_data_release(settings);
+	return result;
+}
+
+static void check_filter(obs_source_t *parent, obs_source_t *filter,
+	void *param)
+{
+	bool *ready = param;
+	void *data = obs_obj_get_data(filter);
+
+	if (!is_motion_filter(filter))
+		return;
+
+	if (scene_switch(filter))
+		*ready = *ready && obs_stub_signal_connections(
+			obs_source_get_signal_handler(parent), "activate");
+	else
+		*ready = *ready &&
+			obs_stub_find_hotkey(data, 0) != OBS_INVALID_HOTKEY_ID;
+}
+
+/* Hotkeys and dispatchers are set up by the loader thread after a tick. */
+
+static bool wait_for_filters(void)
+{
+	int frame;
+	size_t i;
+
+	for (frame = 0; frame < REPLAY_LOAD_TIMEOUT; frame++) {
+		bool ready = true;
+
+		obs_stub_tick(REPLAY_FRAME);
+		for (i = 0; i < replay.sources.num; i++)
+			obs_source_enum_filters(replay.sources.array[i],
+				check_filter, &ready);
+		if (ready)
+			return true;
+		os_sleep_ms(1);
+	}
+	return false;
+}
+
+static void switch_scene(obs_source_t *scene, bool active)
+{
+	obs_source_t *program = obs_frontend_get_current_scene();
+
+	if (active)
+		obs_stub_set_program(scene);
+	else if (program == scene)
+		obs_stub_set_program(NULL);
+	obs_source_release(program);
+}
+
+static void trigger_filter(const struct trace_entry *entry)
+{
+	obs_source_t *scene = obs_get_source_by_name(entry->scene_name);
+	obs_source_t *filter = obs_source_get_filter_by_name(scene,
+		entry->name);
+
+	if (!filter || !is_motion_filter(filter)) {
+		blog(LOG_WARNING, "replay: no filter '%s' on scene '%s'",
+			entry->name, entry->scene_name);
+	} else if (entry->type == TRACE_DEACTIVATE) {
+		switch_scene(scene, false);
+	} else if (scene_switch(filter)) {
+		// Switching to the scene is the only trigger these filters get
+		switch_scene(scene, true);
+	} else {
+		obs_hotkey_id id = obs_stub_find_hotkey(
+			obs_obj_get_data(filter), entry->forward ? 0 : 1);
+
+		if (!obs_stub_press_hotkey(id))
+			blog(LOG_WARNING, "replay: filter '%s' has no %s hotkey",
+				entry->name, entry->forward ? "forward" :
+				"backward");
+	}
+
+	obs_source_release(filter);
+	obs_source_release(scene);
+}
+
+static void tick_frames(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		obs_stub_tick(REPLAY_FRAME);
+}
+
+static void press_filter(obs_source_t *parent, obs_source_t *filter,
+	void *param)
+{
+	size_t index = *(size_t *)param;
+
+	if (is_motion_filter(filter))
+		obs_stub_press_hotkey(obs_stub_find_hotkey(
+			obs_obj_get_data(filter), index));
+	UNUSED_PARAMETER(parent);
+}
+
+static void find_scene_switch(obs_source_t *parent, obs_source_t *filter,
+	void *param)
+{
+	bool *found = param;
+
+	if (is_motion_filter(filter) && scene_switch(filter))
+		*found = true;
+	UNUSED_PARAMETER(parent);
+}
+
+/*
+ * Every forward hotkey, every backward hotkey, then a switch to each
+ * scene with filters triggered by scene switch and back to the first.
+ */
+
+static void record_filters(void)
+{
+	size_t index, i;
+
+	for (index = 0; index < 2; index++) {
+		for (i = 0; i < replay.sources.num; i++)
+			obs_source_enum_filters(replay.sources.array[i],
+				press_filter, &index);
+		tick_frames(REPLAY_STEPS);
+	}
+
+	for (i = 0; i < replay.sources.num; i++) {
+		obs_source_t *source = replay.sources.array[i];
+		bool found = false;
+
+		obs_source_enum_filters(source, find_scene_switch, &found);
+		if (found && source != replay.scene) {
+			obs_stub_set_program(source);
+			tick_frames(REPLAY_STEPS);
+		}
+	}
+
+	obs_stub_set_program(replay.scene);
+	tick_frames(REPLAY_STEPS);
+}
+
+/* Transitions */
+
+static long long prepare_samples(obs_source_t *transition)
+{
+	calldata_t cd = { 0 };
+	long long samples;
+
+	proc_handler_call(obs_source_get_proc_handler(transition), "get_stats",
+		&cd);
+	samples = calldata_int(&cd, "prepare_samples");
+	calldata_free(&cd);
+	return samples;
+}
+
+static void stop_transition(void)
+{
+	if (replay.running)
+		obs_stub_transition_stop(replay.running);
+	replay.running = NULL;
+}
+
+/* Frames are only recorded once the prepare thread matched both scenes. */
+
+static bool start_transition(obs_source_t *transition, obs_source_t *scene)
+{
+	long long samples = prepare_samples(transition);
+	uint64_t timeout = os_gettime_ns() + PREPARE_TIMEOUT_NS;
+
+	stop_transition();
+	obs_stub_transition_start(transition, replay.scene, scene);
+	replay.running = transition;
+
+	obs_source_addref(scene);
+	obs_source_release(replay.scene);
+	replay.scene = scene;
+
+	while (prepare_samples(transition) == samples) {
+		if (os_gettime_ns() > timeout) {
+			blog(LOG_WARNING, "replay: transition to '%s' was never "
+				"prepared", obs_source_get_name(scene));
+			return false;
+		}
+		os_sleep_ms(1);
+	}
+	return true;
+}
+
+static void trigger_transition(const struct trace_entry *entry)
+{
+	obs_source_t *transition = find_transition(entry->name);
+	obs_source_t *scene = obs_get_source_by_name(entry->scene_name);
+
+	// Duplicated studio mode scenes have no name to find them by
+	if (!transition || !scene)
+		blog(LOG_WARNING, "replay: no transition '%s' to scene '%s'",
+			entry->name, entry->scene_name);
+	else
+		start_transition(transition, scene);
+
+	obs_source_release(scene);
+}
+
+static void render_transition(float t)
+{
+	if (replay.running)
+		obs_stub_transition_render(replay.running, t);
+}
+
+/* A transition to every other scene and back to the first. */
+
+static void record_transitions(void)
+{
+	obs_source_t *first = replay.scene;
+	size_t i;
+	int frame;
+
+	obs_source_addref(first);
+	for (i = 0; i <= replay.sources.num; i++) {
+		obs_source_t *scene = i < replay.sources.num ?
+			replay.sources.array[i] : first;
+
+		if (!obs_scene_from_source(scene) || scene == replay.scene)
+			continue;
+		if (!start_transition(replay.transition, scene))
+			break;
+
+		for (frame = 1; frame <= REPLAY_STEPS; frame++)
+			render_transition((float)frame / (REPLAY_STEPS + 1));
+	}
+
+	stop_transition();
+	obs_source_release(first);
+}
+
+/* Replay */
+
+static void run_trace(struct trace_reader *reader, bool filters)
+{
+	struct trace_entry entry;
+
+	while (trace_reader_next(reader, &entry)) {
+		if (entry.type == TRACE_TRIGGER) {
+			if (filters)
+				trigger_filter(&entry);
+			else
+				trigger_transition(&entry);
+		} else if (entry.type == TRACE_DEACTIVATE) {
+			trigger_filter(&entry);
+		} else if (entry.type == TRACE_FRAME) {
+			if (filters)
+				obs_stub_tick(entry.value[0]);
+			else
+				render_transition(entry.value[0]);
+		}
+	}
+
+	stop_transition();
+}
+
+static bool replay_trace(const char *trace, float tolerance)
+{
+	struct trace_reader reader;
+	struct trace_diff diff;
+	struct dstr path = { 0 };
+	bool filters, success;
+
+	if (!trace_reader_open(&reader, trace)) {
+		fprintf(stderr, "%s is not a trace\n", trace);
+		return false;
+	}
+
+	filters = strcmp(reader.module, "motion-filter") == 0;
+	dstr_printf(&path, "%s.replay", trace);
+
+	success = trace_open(reader.module, path.array);
+	if (success) {
+		run_trace(&reader, filters);
+		trace_stop();
+		success = trace_compare(trace, path.array, tolerance, &diff);
+	}
+
+	if (success) {
+		printf("%s: %llu records, %llu mismatches, max error %f\n",
+			reader.module, (unsigned long long)diff.records,
+			(unsigned long long)diff.mismatches, diff.max_error);
+		success = diff.mismatches == 0;
+	}
+
+	trace_reader_free(&reader);
+	dstr_free(&path);
+	return success;
+}
+
+static bool record_trace(const char *module, const char *trace)
+{
+	bool filters = strcmp(module, "motion-filter") == 0;
+
+	if (!filters && !replay.transition) {
+		fprintf(stderr, "the collection has no transition\n");
+		return false;
+	}
+	if (!trace_open(module, trace))
+		return false;
+
+	if (filters)
+		record_filters();
+	else
+		record_transitions();
+
+	trace_stop();
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *record = NULL;
+	const char *collection = NULL;
+	const char *trace = NULL;
+	float tolerance = 0.01f;
+	bool success = false;
+	int arg;
+
+	for (arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--tolerance") == 0 && arg + 1 < argc)
+			tolerance = (float)atof(argv[++arg]);
+		else if (strcmp(argv[arg], "--record") == 0 && arg + 1 < argc)
+			record = argv[++arg];
+		else if (strcmp(argv[arg], "--verbose") == 0)
+			obs_stub_set_log_level(LOG_DEBUG);
+		else if (!collection)
+			collection = argv[arg];
+		else
+			trace = argv[arg];
+	}
+
+	if (!collection || !trace) {
+		fprintf(stderr, "usage: motion-replay [--tolerance <value>] "
+			"[--record <module>] [--verbose] <collection.json> "
+			"<trace>\n");
+		return 2;
+	}
+
+	obs_stub_startup();
+	if (!motion_filter_module_load() || !motion_transition_module_load()) {
+		fprintf(stderr, "failed to load the modules\n");
+		return 1;
+	}
+
+	if (!load_collection(collection))
+		fprintf(stderr, "failed to load %s\n", collection);
+	else if (!wait_for_filters())
+		fprintf(stderr, "filters of %s were never loaded\n", collection);
+	else if (record)
+		success = record_trace(record, trace);
+	else
+		success = replay_trace(trace, tolerance);
+
+	free_collection();
+	motion_transition_module_unload();
+	motion_filter_module_unload();
+	obs_stub_shutdown();
+	return success ? 0 : 1;
+}
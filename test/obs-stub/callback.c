@@ -0,0 +1,334 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <callback/calldata.h>
+#include <callback/signal.h>
+#include <callback/proc.h>
+#include <util/darray.h>
+#include <util/threading.h>
+#include <obs-stub.h>
+
+/* Calldata */
+
+enum param_type {
+	PARAM_INT,
+	PARAM_FLOAT,
+	PARAM_BOOL,
+	PARAM_PTR,
+	PARAM_STRING
+};
+
+struct calldata_param {
+	char                *name;
+	enum param_type     type;
+	union {
+		long long   i;
+		double      f;
+		bool        b;
+		void        *ptr;
+		char        *str;
+	};
+};
+
+static struct calldata_param *find_param(const calldata_t *data,
+	const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < data->num; i++) {
+		if (strcmp(data->params[i].name, name) == 0)
+			return &data->params[i];
+	}
+	return NULL;
+}
+
+static struct calldata_param *set_param(calldata_t *data, const char *name,
+	enum param_type type)
+{
+	struct calldata_param *param = find_param(data, name);
+
+	if (param) {
+		if (param->type == PARAM_STRING)
+			bfree(param->str);
+	} else {
+		if (data->num == data->capacity) {
+			data->capacity = data->capacity ? data->capacity * 2 : 8;
+			data->params = brealloc(data->params,
+				sizeof(*data->params) * data->capacity);
+		}
+		param = &data->params[data->num++];
+		param->name = bstrdup(name);
+	}
+
+	param->type = type;
+	return param;
+}
+
+void calldata_free(calldata_t *data)
+{
+	size_t i;
+
+	for (i = 0; i < data->num; i++) {
+		if (data->params[i].type == PARAM_STRING)
+			bfree(data->params[i].str);
+		bfree(data->params[i].name);
+	}
+	bfree(data->params);
+	calldata_init(data);
+}
+
+void calldata_set_int(calldata_t *data, const char *name, long long val)
+{
+	set_param(data, name, PARAM_INT)->i = val;
+}
+
+void calldata_set_float(calldata_t *data, const char *name, double val)
+{
+	set_param(data, name, PARAM_FLOAT)->f = val;
+}
+
+void calldata_set_bool(calldata_t *data, const char *name, bool val)
+{
+	set_param(data, name, PARAM_BOOL)->b = val;
+}
+
+void calldata_set_ptr(calldata_t *data, const char *name, void *ptr)
+{
+	set_param(data, name, PARAM_PTR)->ptr = ptr;
+}
+
+void calldata_set_string(calldata_t *data, const char *name,
+	const char *str)
+{
+	set_param(data, name, PARAM_STRING)->str = bstrdup(str);
+}
+
+long long calldata_int(const calldata_t *data, const char *name)
+{
+	struct calldata_param *param = find_param(data, name);
+	return param && param->type == PARAM_INT ? param->i : 0;
+}
+
+double calldata_float(const calldata_t *data, const char *name)
+{
+	struct calldata_param *param = find_param(data, name);
+	return param && param->type == PARAM_FLOAT ? param->f : 0.0;
+}
+
+bool calldata_bool(const calldata_t *data, const char *name)
+{
+	struct calldata_param *param = find_param(data, name);
+	return param && param->type == PARAM_BOOL ? param->b : false;
+}
+
+void *calldata_ptr(const calldata_t *data, const char *name)
+{
+	struct calldata_param *param = find_param(data, name);
+	return param && param->type == PARAM_PTR ? param->ptr : NULL;
+}
+
+const char *calldata_string(const calldata_t *data, const char *name)
+{
+	struct calldata_param *param = find_param(data, name);
+	return param && param->type == PARAM_STRING ? param->str : NULL;
+}
+
+/* Signals */
+
+struct signal_callback {
+	char                *signal;
+	signal_callback_t   callback;
+	void                *data;
+};
+
+struct signal_handler {
+	DARRAY(struct signal_callback) callbacks;
+	pthread_mutex_t     mutex;
+};
+
+signal_handler_t *signal_handler_create(void)
+{
+	struct signal_handler *handler = bzalloc(sizeof(*handler));
+	pthread_mutexattr_t attr;
+
+	// Callbacks may connect and disconnect while a signal is running
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&handler->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	return handler;
+}
+
+void signal_handler_destroy(signal_handler_t *handler)
+{
+	size_t i;
+
+	if (!handler)
+		return;
+
+	for (i = 0; i < handler->callbacks.num; i++)
+		bfree(handler->callbacks.array[i].signal);
+	da_free(handler->callbacks);
+	pthread_mutex_destroy(&handler->mutex);
+	bfree(handler);
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+	signal_callback_t callback, void *data)
+{
+	struct signal_callback entry = { bstrdup(signal), callback, data };
+
+	if (!handler)
+		return;
+
+	pthread_mutex_lock(&handler->mutex);
+	da_push_back(handler->callbacks, &entry);
+	pthread_mutex_unlock(&handler->mutex);
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+	signal_callback_t callback, void *data)
+{
+	size_t i;
+
+	if (!handler)
+		return;
+
+	pthread_mutex_lock(&handler->mutex);
+	for (i = 0; i < handler->callbacks.num; i++) {
+		struct signal_callback *entry = &handler->callbacks.array[i];
+
+		if (entry->callback == callback && entry->data == data &&
+			strcmp(entry->signal, signal) == 0) {
+			bfree(entry->signal);
+			da_erase(handler->callbacks, i);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&handler->mutex);
+}
+
+/* The handler lock is held while callbacks run, as in libobs. */
+
+void signal_handler_signal(signal_handler_t *handler, const char *signal,
+	calldata_t *params)
+{
+	DARRAY(struct signal_callback) callbacks = { 0 };
+	size_t i;
+
+	if (!handler)
+		return;
+
+	pthread_mutex_lock(&handler->mutex);
+	for (i = 0; i < handler->callbacks.num; i++) {
+		if (strcmp(handler->callbacks.array[i].signal, signal) == 0)
+			da_push_back(callbacks, &handler->callbacks.array[i]);
+	}
+
+	for (i = 0; i < callbacks.num; i++)
+		callbacks.array[i].callback(callbacks.array[i].data, params);
+	pthread_mutex_unlock(&handler->mutex);
+
+	da_free(callbacks);
+}
+
+size_t obs_stub_signal_connections(signal_handler_t *handler,
+	const char *signal)
+{
+	size_t i, count = 0;
+
+	if (!handler)
+		return 0;
+
+	pthread_mutex_lock(&handler->mutex);
+	for (i = 0; i < handler->callbacks.num; i++) {
+		if (strcmp(handler->callbacks.array[i].signal, signal) == 0)
+			count++;
+	}
+	pthread_mutex_unlock(&handler->mutex);
+	return count;
+}
+
+/* Procs */
+
+struct proc_info {
+	char                *name;
+	proc_handler_proc_t proc;
+	void                *data;
+};
+
+struct proc_handler {
+	DARRAY(struct proc_info) procs;
+};
+
+proc_handler_t *proc_handler_create(void)
+{
+	return bzalloc(sizeof(struct proc_handler));
+}
+
+void proc_handler_destroy(proc_handler_t *handler)
+{
+	size_t i;
+
+	if (!handler)
+		return;
+
+	for (i = 0; i < handler->procs.num; i++)
+		bfree(handler->procs.array[i].name);
+	da_free(handler->procs);
+	bfree(handler);
+}
+
+/* "void name(in bool forward)", only the name is kept. */
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string,
+	proc_handler_proc_t proc, void *data)
+{
+	const char *name = strchr(decl_string, ' ');
+	const char *end = strchr(decl_string, '(');
+	struct proc_info info;
+
+	if (!handler || !name || !end || end < name)
+		return;
+
+	info.name = bstrdup_n(name + 1, end - name - 1);
+	info.proc = proc;
+	info.data = data;
+	da_push_back(handler->procs, &info);
+}
+
+bool proc_handler_call(proc_handler_t *handler, const char *name,
+	calldata_t *params)
+{
+	size_t i;
+
+	if (!handler)
+		return false;
+
+	for (i = 0; i < handler->procs.num; i++) {
+		struct proc_info *info = &handler->procs.array[i];
+
+		if (strcmp(info->name, name) == 0) {
+			info->proc(info->data, params);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,804 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <obs.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+/*
+ * Settings objects. Every item has a user value and a default, the
+ * getters fall back to the default, JSON only holds user values. That
+ * is the part of obs_data the plugins can observe.
+ */
+
+enum data_type {
+	DATA_NONE,
+	DATA_STRING,
+	DATA_NUMBER,
+	DATA_BOOL,
+	DATA_OBJECT,
+	DATA_ARRAY
+};
+
+struct data_value {
+	enum data_type      type;
+	bool                is_double;
+	union {
+		char        *str;
+		long long   i;
+		double      d;
+		bool        b;
+		obs_data_t  *obj;
+		obs_data_array_t *array;
+	};
+};
+
+struct data_item {
+	char                *name;
+	struct data_value   user;
+	struct data_value   def;
+};
+
+struct obs_data {
+	volatile long       refs;
+	DARRAY(struct data_item) items;
+	char                *json;
+};
+
+struct obs_data_array {
+	volatile long       refs;
+	DARRAY(obs_data_t *) objects;
+};
+
+static void free_value(struct data_value *value)
+{
+	switch (value->type) {
+	case DATA_STRING:
+		bfree(value->str);
+		break;
+	case DATA_OBJECT:
+		obs_data_release(value->obj);
+		break;
+	case DATA_ARRAY:
+		obs_data_array_release(value->array);
+		break;
+	default:
+		break;
+	}
+	memset(value, 0, sizeof(*value));
+}
+
+static void copy_value(struct data_value *dst, const struct data_value *src)
+{
+	free_value(dst);
+	*dst = *src;
+
+	switch (src->type) {
+	case DATA_STRING:
+		dst->str = bstrdup(src->str);
+		break;
+	case DATA_OBJECT:
+		obs_data_addref(dst->obj);
+		break;
+	case DATA_ARRAY:
+		obs_data_array_addref(dst->array);
+		break;
+	default:
+		break;
+	}
+}
+
+static struct data_item *find_item(obs_data_t *data, const char *name)
+{
+	size_t i;
+
+	if (!data || !name)
+		return NULL;
+
+	for (i = 0; i < data->items.num; i++) {
+		if (strcmp(data->items.array[i].name, name) == 0)
+			return &data->items.array[i];
+	}
+	return NULL;
+}
+
+static struct data_item *get_item(obs_data_t *data, const char *name)
+{
+	struct data_item *item = find_item(data, name);
+
+	if (!item) {
+		item = da_push_back_new(data->items);
+		item->name = bstrdup(name);
+	}
+	return item;
+}
+
+/* The user value when there is one, the default otherwise. */
+
+static const struct data_value *get_value(obs_data_t *data, const char *name)
+{
+	struct data_item *item = find_item(data, name);
+
+	if (!item)
+		return NULL;
+	return item->user.type != DATA_NONE ? &item->user : &item->def;
+}
+
+obs_data_t *obs_data_create(void)
+{
+	obs_data_t *data = bzalloc(sizeof(*data));
+	data->refs = 1;
+	return data;
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+	if (data)
+		os_atomic_inc_long(&data->refs);
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	size_t i;
+
+	if (!data || os_atomic_dec_long(&data->refs) > 0)
+		return;
+
+	for (i = 0; i < data->items.num; i++) {
+		free_value(&data->items.array[i].user);
+		free_value(&data->items.array[i].def);
+		bfree(data->items.array[i].name);
+	}
+	da_free(data->items);
+	bfree(data->json);
+	bfree(data);
+}
+
+bool obs_data_has_user_value(obs_data_t *data, const char *name)
+{
+	struct data_item *item = find_item(data, name);
+	return item && item->user.type != DATA_NONE;
+}
+
+void obs_data_apply(obs_data_t *target, obs_data_t *apply_data)
+{
+	size_t i;
+
+	if (!target || !apply_data || target == apply_data)
+		return;
+
+	for (i = 0; i < apply_data->items.num; i++) {
+		struct data_item *src = &apply_data->items.array[i];
+
+		if (src->user.type != DATA_NONE)
+			copy_value(&get_item(target, src->name)->user,
+				&src->user);
+	}
+}
+
+/* Setters */
+
+static void set_value(obs_data_t *data, const char *name, bool def,
+	const struct data_value *value)
+{
+	struct data_item *item;
+
+	if (!data || !name)
+		return;
+
+	item = get_item(data, name);
+	copy_value(def ? &item->def : &item->user, value);
+}
+
+static void set_string(obs_data_t *data, const char *name, const char *val,
+	bool def)
+{
+	struct data_value value = { DATA_STRING };
+	value.str = (char *)(val ? val : "");
+	set_value(data, name, def, &value);
+}
+
+static void set_int(obs_data_t *data, const char *name, long long val,
+	bool def)
+{
+	struct data_value value = { DATA_NUMBER };
+	value.i = val;
+	set_value(data, name, def, &value);
+}
+
+static void set_double(obs_data_t *data, const char *name, double val,
+	bool def)
+{
+	struct data_value value = { DATA_NUMBER, true };
+	value.d = val;
+	set_value(data, name, def, &value);
+}
+
+static void set_bool(obs_data_t *data, const char *name, bool val, bool def)
+{
+	struct data_value value = { DATA_BOOL };
+	value.b = val;
+	set_value(data, name, def, &value);
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	set_string(data, name, val, false);
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	set_int(data, name, val, false);
+}
+
+void obs_data_set_double(obs_data_t *data, const char *name, double val)
+{
+	set_double(data, name, val, false);
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	set_bool(data, name, val, false);
+}
+
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj)
+{
+	struct data_value value = { DATA_OBJECT };
+	value.obj = obj;
+	if (obj)
+		set_value(data, name, false, &value);
+}
+
+void obs_data_set_array(obs_data_t *data, const char *name,
+	obs_data_array_t *array)
+{
+	struct data_value value = { DATA_ARRAY };
+	value.array = array;
+	if (array)
+		set_value(data, name, false, &value);
+}
+
+void obs_data_set_default_string(obs_data_t *data, const char *name,
+	const char *val)
+{
+	set_string(data, name, val, true);
+}
+
+void obs_data_set_default_int(obs_data_t *data, const char *name,
+	long long val)
+{
+	set_int(data, name, val, true);
+}
+
+void obs_data_set_default_double(obs_data_t *data, const char *name,
+	double val)
+{
+	set_double(data, name, val, true);
+}
+
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val)
+{
+	set_bool(data, name, val, true);
+}
+
+/* Getters */
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+	return value && value->type == DATA_STRING ? value->str : "";
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+
+	if (!value || value->type != DATA_NUMBER)
+		return 0;
+	return value->is_double ? (long long)value->d : value->i;
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+
+	if (!value || value->type != DATA_NUMBER)
+		return 0.0;
+	return value->is_double ? value->d : (double)value->i;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+	return value && value->type == DATA_BOOL ? value->b : false;
+}
+
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+
+	if (!value || value->type != DATA_OBJECT)
+		return NULL;
+
+	obs_data_addref(value->obj);
+	return value->obj;
+}
+
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name)
+{
+	const struct data_value *value = get_value(data, name);
+
+	if (!value || value->type != DATA_ARRAY)
+		return NULL;
+
+	obs_data_array_addref(value->array);
+	return value->array;
+}
+
+/* Arrays */
+
+obs_data_array_t *obs_data_array_create(void)
+{
+	obs_data_array_t *array = bzalloc(sizeof(*array));
+	array->refs = 1;
+	return array;
+}
+
+void obs_data_array_addref(obs_data_array_t *array)
+{
+	if (array)
+		os_atomic_inc_long(&array->refs);
+}
+
+void obs_data_array_release(obs_data_array_t *array)
+{
+	size_t i;
+
+	if (!array || os_atomic_dec_long(&array->refs) > 0)
+		return;
+
+	for (i = 0; i < array->objects.num; i++)
+		obs_data_release(array->objects.array[i]);
+	da_free(array->objects);
+	bfree(array);
+}
+
+size_t obs_data_array_count(obs_data_array_t *array)
+{
+	return array ? array->objects.num : 0;
+}
+
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx)
+{
+	obs_data_t *data;
+
+	if (!array || idx >= array->objects.num)
+		return NULL;
+
+	data = array->objects.array[idx];
+	obs_data_addref(data);
+	return data;
+}
+
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj)
+{
+	if (!array || !obj)
+		return 0;
+
+	obs_data_addref(obj);
+	return da_push_back(array->objects, &obj);
+}
+
+/* JSON writing */
+
+static void write_object(struct dstr *json, obs_data_t *data, int depth);
+
+static void write_indent(struct dstr *json, int depth)
+{
+	while (depth-- > 0)
+		dstr_cat(json, "    ");
+}
+
+static void write_string(struct dstr *json, const char *str)
+{
+	dstr_cat_ch(json, '"');
+	for (; *str; str++) {
+		unsigned char ch = (unsigned char)*str;
+
+		if (ch == '"' || ch == '\\') {
+			dstr_cat_ch(json, '\\');
+			dstr_cat_ch(json, (char)ch);
+		} else if (ch == '\n') {
+			dstr_cat(json, "\\n");
+		} else if (ch == '\t') {
+			dstr_cat(json, "\\t");
+		} else if (ch < 0x20) {
+			dstr_catf(json, "\\u%04x", ch);
+		} else {
+			dstr_cat_ch(json, (char)ch);
+		}
+	}
+	dstr_cat_ch(json, '"');
+}
+
+static void write_value(struct dstr *json, const struct data_value *value,
+	int depth)
+{
+	size_t i;
+
+	switch (value->type) {
+	case DATA_STRING:
+		write_string(json, value->str);
+		break;
+	case DATA_NUMBER:
+		if (!value->is_double)
+			dstr_catf(json, "%lld", value->i);
+		else if (isfinite(value->d))
+			dstr_catf(json, "%.17g", value->d);
+		else
+			dstr_cat(json, "0");
+		break;
+	case DATA_BOOL:
+		dstr_cat(json, value->b ? "true" : "false");
+		break;
+	case DATA_OBJECT:
+		write_object(json, value->obj, depth);
+		break;
+	case DATA_ARRAY:
+		dstr_cat(json, "[");
+		for (i = 0; i < value->array->objects.num; i++) {
+			dstr_cat(json, i ? ",\n" : "\n");
+			write_indent(json, depth + 1);
+			write_object(json, value->array->objects.array[i],
+				depth + 1);
+		}
+		if (i) {
+			dstr_cat(json, "\n");
+			write_indent(json, depth);
+		}
+		dstr_cat(json, "]");
+		break;
+	default:
+		dstr_cat(json, "null");
+		break;
+	}
+}
+
+static void write_object(struct dstr *json, obs_data_t *data, int depth)
+{
+	bool first = true;
+	size_t i;
+
+	dstr_cat(json, "{");
+	for (i = 0; i < data->items.num; i++) {
+		struct data_item *item = &data->items.array[i];
+
+		if (item->user.type == DATA_NONE)
+			continue;
+
+		dstr_cat(json, first ? "\n" : ",\n");
+		write_indent(json, depth + 1);
+		write_string(json, item->name);
+		dstr_cat(json, ": ");
+		write_value(json, &item->user, depth + 1);
+		first = false;
+	}
+	if (!first) {
+		dstr_cat(json, "\n");
+		write_indent(json, depth);
+	}
+	dstr_cat(json, "}");
+}
+
+const char *obs_data_get_json(obs_data_t *data)
+{
+	struct dstr json = { 0 };
+
+	if (!data)
+		return NULL;
+
+	write_object(&json, data, 0);
+	bfree(data->json);
+	data->json = json.array;
+	return data->json;
+}
+
+bool obs_data_save_json(obs_data_t *data, const char *file)
+{
+	const char *json = obs_data_get_json(data);
+	FILE *f;
+	bool success;
+
+	if (!json || !file)
+		return false;
+
+	f = os_fopen(file, "wb");
+	if (!f)
+		return false;
+
+	success = fwrite(json, 1, strlen(json), f) == strlen(json) &&
+		fputc('\n', f) != EOF;
+	return fclose(f) == 0 && success;
+}
+
+bool obs_data_save_json_safe(obs_data_t *data, const char *file,
+	const char *temp_ext, const char *backup_ext)
+{
+	struct dstr temp = { 0 }, backup = { 0 };
+	bool success;
+
+	dstr_printf(&temp, "%s.%s", file, temp_ext);
+	dstr_printf(&backup, "%s.%s", file, backup_ext);
+
+	success = obs_data_save_json(data, temp.array);
+	if (success) {
+		if (os_file_exists(file))
+			os_rename(file, backup.array);
+		success = os_rename(temp.array, file) == 0;
+	}
+
+	dstr_free(&temp);
+	dstr_free(&backup);
+	return success;
+}
+
+/* JSON reading */
+
+struct json_reader {
+	const char          *pos;
+	bool                failed;
+};
+
+static bool read_value(struct json_reader *reader, struct data_value *value);
+
+static void skip_space(struct json_reader *reader)
+{
+	while (isspace((unsigned char)*reader->pos))
+		reader->pos++;
+}
+
+static bool expect(struct json_reader *reader, char ch)
+{
+	skip_space(reader);
+	if (*reader->pos != ch)
+		return false;
+
+	reader->pos++;
+	return true;
+}
+
+static void cat_utf8(struct dstr *str, unsigned int code)
+{
+	if (code < 0x80) {
+		dstr_cat_ch(str, (char)code);
+	} else if (code < 0x800) {
+		dstr_cat_ch(str, (char)(0xC0 | (code >> 6)));
+		dstr_cat_ch(str, (char)(0x80 | (code & 0x3F)));
+	} else {
+		dstr_cat_ch(str, (char)(0xE0 | (code >> 12)));
+		dstr_cat_ch(str, (char)(0x80 | ((code >> 6) & 0x3F)));
+		dstr_cat_ch(str, (char)(0x80 | (code & 0x3F)));
+	}
+}
+
+static char *read_string(struct json_reader *reader)
+{
+	struct dstr str = { 0 };
+
+	if (!expect(reader, '"'))
+		return NULL;
+
+	dstr_copy(&str, "");
+	while (*reader->pos && *reader->pos != '"') {
+		char ch = *reader->pos++;
+
+		if (ch != '\\') {
+			dstr_cat_ch(&str, ch);
+			continue;
+		}
+
+		ch = *reader->pos++;
+		switch (ch) {
+		case 'n': dstr_cat_ch(&str, '\n'); break;
+		case 't': dstr_cat_ch(&str, '\t'); break;
+		case 'r': dstr_cat_ch(&str, '\r'); break;
+		case 'b': dstr_cat_ch(&str, '\b'); break;
+		case 'f': dstr_cat_ch(&str, '\f'); break;
+		case 'u': {
+			char hex[5] = { 0 };
+			strncpy(hex, reader->pos, 4);
+			if (strlen(hex) < 4) {
+				dstr_free(&str);
+				return NULL;
+			}
+			cat_utf8(&str, (unsigned int)strtoul(hex, NULL, 16));
+			reader->pos += 4;
+			break;
+		}
+		case 0:
+			dstr_free(&str);
+			return NULL;
+		default:
+			dstr_cat_ch(&str, ch);
+		}
+	}
+
+	if (*reader->pos != '"') {
+		dstr_free(&str);
+		return NULL;
+	}
+	reader->pos++;
+	return str.array;
+}
+
+static obs_data_t *read_object(struct json_reader *reader)
+{
+	obs_data_t *data;
+
+	if (!expect(reader, '{'))
+		return NULL;
+
+	data = obs_data_create();
+	if (expect(reader, '}'))
+		return data;
+
+	do {
+		struct data_value value = { DATA_NONE };
+		char *name = read_string(reader);
+
+		if (!name || !expect(reader, ':') ||
+			!read_value(reader, &value)) {
+			bfree(name);
+			obs_data_release(data);
+			return NULL;
+		}
+
+		// Values are moved in, not copied
+		free_value(&get_item(data, name)->user);
+		get_item(data, name)->user = value;
+		bfree(name);
+	} while (expect(reader, ','));
+
+	if (!expect(reader, '}')) {
+		obs_data_release(data);
+		return NULL;
+	}
+	return data;
+}
+
+static obs_data_array_t *read_array(struct json_reader *reader)
+{
+	obs_data_array_t *array;
+
+	if (!expect(reader, '['))
+		return NULL;
+
+	array = obs_data_array_create();
+	if (expect(reader, ']'))
+		return array;
+
+	do {
+		obs_data_t *obj = read_object(reader);
+
+		if (!obj) {
+			obs_data_array_release(array);
+			return NULL;
+		}
+		da_push_back(array->objects, &obj);
+	} while (expect(reader, ','));
+
+	if (!expect(reader, ']')) {
+		obs_data_array_release(array);
+		return NULL;
+	}
+	return array;
+}
+
+static bool read_number(struct json_reader *reader, struct data_value *value)
+{
+	const char *start = reader->pos;
+	char *end;
+
+	value->type = DATA_NUMBER;
+	value->i = strtoll(start, &end, 10);
+	if (end == start)
+		return false;
+
+	if (*end == '.' || *end == 'e' || *end == 'E') {
+		value->is_double = true;
+		value->d = strtod(start, &end);
+	}
+
+	reader->pos = end;
+	return true;
+}
+
+static bool read_literal(struct json_reader *reader, const char *literal)
+{
+	size_t len = strlen(literal);
+
+	if (strncmp(reader->pos, literal, len) != 0)
+		return false;
+
+	reader->pos += len;
+	return true;
+}
+
+static bool read_value(struct json_reader *reader, struct data_value *value)
+{
+	skip_space(reader);
+
+	switch (*reader->pos) {
+	case '{':
+		value->type = DATA_OBJECT;
+		value->obj = read_object(reader);
+		return value->obj != NULL;
+	case '[':
+		value->type = DATA_ARRAY;
+		value->array = read_array(reader);
+		return value->array != NULL;
+	case '"':
+		value->type = DATA_STRING;
+		value->str = read_string(reader);
+		return value->str != NULL;
+	case 't':
+		value->type = DATA_BOOL;
+		value->b = true;
+		return read_literal(reader, "true");
+	case 'f':
+		value->type = DATA_BOOL;
+		value->b = false;
+		return read_literal(reader, "false");
+	case 'n':
+		value->type = DATA_NONE;
+		return read_literal(reader, "null");
+	}
+
+	return read_number(reader, value);
+}
+
+obs_data_t *obs_data_create_from_json(const char *json_string)
+{
+	struct json_reader reader = { json_string };
+	obs_data_t *data;
+
+	if (!json_string)
+		return NULL;
+
+	data = read_object(&reader);
+	if (!data)
+		blog(LOG_ERROR, "obs-data.c: failed to parse json at offset "
+			"%d", (int)(reader.pos - json_string));
+	return data;
+}
+
+obs_data_t *obs_data_create_from_json_file(const char *json_file)
+{
+	char *json = os_quick_read_utf8_file(json_file);
+	obs_data_t *data = obs_data_create_from_json(json);
+
+	bfree(json);
+	return data;
+}
@@ -0,0 +1,58 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "../util/c99defs.h"
+
+/*
+ * Named parameters by value. libobs packs them into one stack, here they
+ * are a plain list, which is all the plugins can tell apart.
+ */
+
+struct calldata_param;
+
+struct calldata {
+	struct calldata_param *params;
+	size_t              num;
+	size_t              capacity;
+};
+
+typedef struct calldata calldata_t;
+
+static inline void calldata_init(calldata_t *data)
+{
+	memset(data, 0, sizeof(*data));
+}
+
+void calldata_free(calldata_t *data);
+
+void calldata_set_int(calldata_t *data, const char *name, long long val);
+void calldata_set_float(calldata_t *data, const char *name, double val);
+void calldata_set_bool(calldata_t *data, const char *name, bool val);
+void calldata_set_ptr(calldata_t *data, const char *name, void *ptr);
+void calldata_set_string(calldata_t *data, const char *name,
+	const char *str);
+
+long long calldata_int(const calldata_t *data, const char *name);
+double calldata_float(const calldata_t *data, const char *name);
+bool calldata_bool(const calldata_t *data, const char *name);
+void *calldata_ptr(const calldata_t *data, const char *name);
+const char *calldata_string(const calldata_t *data, const char *name);
@@ -0,0 +1,34 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "calldata.h"
+
+typedef struct proc_handler proc_handler_t;
+typedef void (*proc_handler_proc_t)(void *data, calldata_t *cd);
+
+proc_handler_t *proc_handler_create(void);
+void proc_handler_destroy(proc_handler_t *handler);
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string,
+	proc_handler_proc_t proc, void *data);
+bool proc_handler_call(proc_handler_t *handler, const char *name,
+	calldata_t *params);
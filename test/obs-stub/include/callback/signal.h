@@ -0,0 +1,36 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "calldata.h"
+
+typedef struct signal_handler signal_handler_t;
+typedef void (*signal_callback_t)(void *data, calldata_t *cd);
+
+signal_handler_t *signal_handler_create(void);
+void signal_handler_destroy(signal_handler_t *handler);
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+	signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+	signal_callback_t callback, void *data);
+void signal_handler_signal(signal_handler_t *handler, const char *signal,
+	calldata_t *params);
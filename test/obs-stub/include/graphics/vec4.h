@@ -0,0 +1,120 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "../util/c99defs.h"
+#include "math-defs.h"
+#include <math.h>
+
+/* Scalar, libobs uses SSE here but the results are the same. */
+
+struct vec4 {
+	union {
+		struct {
+			float x, y, z, w;
+		};
+		float ptr[4];
+	};
+};
+
+static inline void vec4_zero(struct vec4 *v)
+{
+	v->x = v->y = v->z = v->w = 0.0f;
+}
+
+static inline void vec4_set(struct vec4 *dst, float x, float y, float z,
+	float w)
+{
+	dst->x = x;
+	dst->y = y;
+	dst->z = z;
+	dst->w = w;
+}
+
+static inline void vec4_copy(struct vec4 *dst, const struct vec4 *v)
+{
+	*dst = *v;
+}
+
+static inline void vec4_add(struct vec4 *dst, const struct vec4 *v1,
+	const struct vec4 *v2)
+{
+	vec4_set(dst, v1->x + v2->x, v1->y + v2->y, v1->z + v2->z,
+		v1->w + v2->w);
+}
+
+static inline void vec4_sub(struct vec4 *dst, const struct vec4 *v1,
+	const struct vec4 *v2)
+{
+	vec4_set(dst, v1->x - v2->x, v1->y - v2->y, v1->z - v2->z,
+		v1->w - v2->w);
+}
+
+static inline void vec4_mul(struct vec4 *dst, const struct vec4 *v1,
+	const struct vec4 *v2)
+{
+	vec4_set(dst, v1->x * v2->x, v1->y * v2->y, v1->z * v2->z,
+		v1->w * v2->w);
+}
+
+static inline void vec4_mulf(struct vec4 *dst, const struct vec4 *v, float f)
+{
+	vec4_set(dst, v->x * f, v->y * f, v->z * f, v->w * f);
+}
+
+static inline void vec4_addf(struct vec4 *dst, const struct vec4 *v, float f)
+{
+	vec4_set(dst, v->x + f, v->y + f, v->z + f, v->w + f);
+}
+
+static inline void vec4_subf(struct vec4 *dst, const struct vec4 *v, float f)
+{
+	vec4_set(dst, v->x - f, v->y - f, v->z - f, v->w - f);
+}
+
+static inline void vec4_divf(struct vec4 *dst, const struct vec4 *v, float f)
+{
+	vec4_mulf(dst, v, 1.0f / f);
+}
+
+static inline float vec4_dot(const struct vec4 *v1, const struct vec4 *v2)
+{
+	return v1->x * v2->x + v1->y * v2->y + v1->z * v2->z + v1->w * v2->w;
+}
+
+static inline void vec4_abs(struct vec4 *dst, const struct vec4 *v)
+{
+	vec4_set(dst, fabsf(v->x), fabsf(v->y), fabsf(v->z), fabsf(v->w));
+}
+
+static inline void vec4_min(struct vec4 *dst, const struct vec4 *v1,
+	const struct vec4 *v2)
+{
+	vec4_set(dst, fminf(v1->x, v2->x), fminf(v1->y, v2->y),
+		fminf(v1->z, v2->z), fminf(v1->w, v2->w));
+}
+
+static inline void vec4_max(struct vec4 *dst, const struct vec4 *v1,
+	const struct vec4 *v2)
+{
+	vec4_set(dst, fmaxf(v1->x, v2->x), fmaxf(v1->y, v2->y),
+		fmaxf(v1->z, v2->z), fmaxf(v1->w, v2->w));
+}
@@ -0,0 +1,42 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "obs.h"
+
+typedef size_t obs_hotkey_id;
+typedef size_t obs_hotkey_pair_id;
+typedef struct obs_hotkey obs_hotkey_t;
+
+#define OBS_INVALID_HOTKEY_ID      (~(obs_hotkey_id)0)
+#define OBS_INVALID_HOTKEY_PAIR_ID (~(obs_hotkey_pair_id)0)
+
+typedef void (*obs_hotkey_func)(void *data, obs_hotkey_id id,
+	obs_hotkey_t *hotkey, bool pressed);
+
+obs_hotkey_id obs_hotkey_register_frontend(const char *name,
+	const char *description, obs_hotkey_func func, void *data);
+obs_hotkey_id obs_hotkey_register_source(obs_source_t *source,
+	const char *name, const char *description, obs_hotkey_func func,
+	void *data);
+void obs_hotkey_unregister(obs_hotkey_id id);
+void obs_hotkey_load(obs_hotkey_id id, obs_data_array_t *data);
+obs_data_array_t *obs_hotkey_save(obs_hotkey_id id);
@@ -0,0 +1,66 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "obs.h"
+#include "util/darray.h"
+#include "util/threading.h"
+
+/* Only the fields the plugins or the stub itself read. */
+
+struct obs_context_data {
+	char                *name;
+	void                *data;
+	obs_data_t          *settings;
+	signal_handler_t    *signals;
+	proc_handler_t      *procs;
+	bool                private;
+};
+
+struct obs_weak_source {
+	volatile long       refs;
+	struct obs_source   *source;
+};
+
+struct obs_source {
+	struct obs_context_data context;
+	const struct obs_source_info *info;
+	char                *id;
+	volatile long       refs;
+	struct obs_weak_source *control;
+	volatile bool       removed;
+	volatile long       defer_update;
+
+	uint32_t            width;
+	uint32_t            height;
+	volatile long       activate_refs;
+	DARRAY(obs_source_t *) active_children;
+	DARRAY(obs_source_t *) activated;
+
+	struct obs_scene    *scene;
+	struct obs_source   *filter_parent;
+	DARRAY(obs_source_t *) filters;
+
+	float               transition_time;
+	struct obs_source   *transition_sources[2];
+
+	uint64_t            renders;
+};
@@ -0,0 +1,47 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "obs.h"
+
+/*
+ * Both plugins are linked into one executable, so every module gets its
+ * own name for the load and unload entry points through OBS_STUB_MODULE.
+ */
+
+#ifdef OBS_STUB_MODULE
+#define OBS_STUB_CAT_(a, b) a##b
+#define OBS_STUB_CAT(a, b)  OBS_STUB_CAT_(a, b)
+#define obs_module_load     OBS_STUB_CAT(OBS_STUB_MODULE, _module_load)
+#define obs_module_unload   OBS_STUB_CAT(OBS_STUB_MODULE, _module_unload)
+#endif
+
+#define OBS_DECLARE_MODULE()
+#define OBS_MODULE_USE_DEFAULT_LOCALE(module_name, default_locale)
+
+MODULE_EXPORT bool obs_module_load(void);
+MODULE_EXPORT void obs_module_unload(void);
+
+/* Locale keys are returned as they are. */
+const char *obs_module_text(const char *lookup_string);
+
+/* NULL unless obs_stub_set_config_path named a directory. */
+char *obs_module_config_path(const char *file);
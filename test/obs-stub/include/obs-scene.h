@@ -0,0 +1,58 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "obs-internal.h"
+
+struct obs_scene_item {
+	volatile long       ref;
+	volatile bool       removed;
+	bool                is_group;
+	struct obs_scene    *parent;
+	struct obs_source   *source;
+	bool                user_visible;
+	bool                visible;
+	int64_t             id;
+
+	struct vec2         pos;
+	struct vec2         scale;
+	float               rot;
+	uint32_t            align;
+	enum obs_bounds_type bounds_type;
+	uint32_t            bounds_align;
+	struct vec2         bounds;
+	struct obs_sceneitem_crop crop;
+	float               box_transform[6];
+
+	volatile long       defer_update;
+	bool                update_transform;
+
+	struct obs_scene_item *prev;
+	struct obs_scene_item *next;
+};
+
+struct obs_scene {
+	struct obs_source   *source;
+	bool                is_group;
+	pthread_mutex_t     video_mutex;
+	int64_t             id_counter;
+	struct obs_scene_item *first_item;
+};
@@ -0,0 +1,79 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "obs-module.h"
+#include "obs-frontend-api.h"
+
+/*
+ * Calls the headless tools use to drive the stub the way OBS would:
+ * ticking, program and preview changes, transitions and hotkeys. Nothing
+ * renders, rendering a source only counts the call.
+ */
+
+struct obs_stub_counters {
+	uint64_t            transform_sets;
+	uint64_t            crop_sets;
+	uint64_t            renders;
+	uint64_t            signals;
+};
+
+void obs_stub_startup(void);
+void obs_stub_shutdown(void);
+
+void obs_stub_set_log_level(int level);
+void obs_stub_set_config_path(const char *path);
+void obs_stub_set_video(uint32_t width, uint32_t height, uint32_t fps);
+
+/* Tick callbacks first, then the video_tick of every source, as libobs. */
+void obs_stub_tick(float seconds);
+
+/*
+ * Activates the source and everything it shows, deactivating the former
+ * program. Nested scenes are activated too, as they are in libobs.
+ */
+void obs_stub_set_program(obs_source_t *source);
+void obs_stub_set_preview(obs_source_t *source);
+void obs_stub_set_studio_mode(bool enabled);
+void obs_stub_set_transition(obs_source_t *transition);
+
+/*
+ * A transition from its current source, or the given one when it has
+ * none, to the new one. Rendering sets the transition time first.
+ */
+void obs_stub_transition_start(obs_source_t *transition, obs_source_t *from,
+	obs_source_t *to);
+void obs_stub_transition_render(obs_source_t *transition, float t);
+void obs_stub_transition_stop(obs_source_t *transition);
+
+/* The index-th hotkey registered with this callback data. */
+obs_hotkey_id obs_stub_find_hotkey(void *data, size_t index);
+bool obs_stub_press_hotkey(obs_hotkey_id id);
+
+/* Callbacks connected to a signal, to wait for deferred connections. */
+size_t obs_stub_signal_connections(signal_handler_t *handler,
+	const char *signal);
+
+void obs_stub_get_counters(struct obs_stub_counters *counters);
+void obs_stub_reset_counters(void);
+
+/* Sources still alive, for leak checks at the end of a test. */
+size_t obs_stub_source_count(void);
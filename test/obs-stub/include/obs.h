@@ -0,0 +1,413 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+/*
+ * Stand-in for libobs in the headless tools and tests. It declares the
+ * part of the API the plugins use with the same names and signatures,
+ * obs-stub.h has the calls that drive it.
+ */
+
+#include "util/c99defs.h"
+#include "util/bmem.h"
+#include "util/base.h"
+#include "util/profiler.h"
+#include "graphics/vec2.h"
+#include "graphics/vec4.h"
+#include "callback/signal.h"
+#include "callback/proc.h"
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_weak_source obs_weak_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+typedef struct obs_data obs_data_t;
+typedef struct obs_data_array obs_data_array_t;
+typedef struct obs_properties obs_properties_t;
+typedef struct obs_property obs_property_t;
+typedef struct gs_effect gs_effect_t;
+
+#include "obs-hotkey.h"
+
+/* Core */
+
+struct obs_video_info {
+	const char          *graphics_module;
+	uint32_t            fps_num;
+	uint32_t            fps_den;
+	uint32_t            base_width;
+	uint32_t            base_height;
+	uint32_t            output_width;
+	uint32_t            output_height;
+};
+
+bool obs_get_video_info(struct obs_video_info *ovi);
+uint64_t obs_get_video_frame_time(void);
+const char *obs_get_version_string(void);
+signal_handler_t *obs_get_signal_handler(void);
+
+/* Channel 0 is the program, set by obs_stub_set_program. */
+obs_source_t *obs_get_output_source(uint32_t channel);
+
+void obs_add_tick_callback(void (*tick)(void *param, float seconds),
+	void *param);
+void obs_remove_tick_callback(void (*tick)(void *param, float seconds),
+	void *param);
+
+void *obs_obj_get_data(void *obj);
+
+/* Data */
+
+obs_data_t *obs_data_create(void);
+obs_data_t *obs_data_create_from_json(const char *json_string);
+obs_data_t *obs_data_create_from_json_file(const char *json_file);
+void obs_data_addref(obs_data_t *data);
+void obs_data_release(obs_data_t *data);
+const char *obs_data_get_json(obs_data_t *data);
+bool obs_data_save_json(obs_data_t *data, const char *file);
+bool obs_data_save_json_safe(obs_data_t *data, const char *file,
+	const char *temp_ext, const char *backup_ext);
+void obs_data_apply(obs_data_t *target, obs_data_t *apply_data);
+bool obs_data_has_user_value(obs_data_t *data, const char *name);
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val);
+void obs_data_set_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_double(obs_data_t *data, const char *name, double val);
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val);
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj);
+void obs_data_set_array(obs_data_t *data, const char *name,
+	obs_data_array_t *array);
+
+void obs_data_set_default_string(obs_data_t *data, const char *name,
+	const char *val);
+void obs_data_set_default_int(obs_data_t *data, const char *name,
+	long long val);
+void obs_data_set_default_double(obs_data_t *data, const char *name,
+	double val);
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val);
+
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+double obs_data_get_double(obs_data_t *data, const char *name);
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name);
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name);
+
+obs_data_array_t *obs_data_array_create(void);
+void obs_data_array_addref(obs_data_array_t *array);
+void obs_data_array_release(obs_data_array_t *array);
+size_t obs_data_array_count(obs_data_array_t *array);
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx);
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj);
+
+/* Properties */
+
+enum obs_combo_type {
+	OBS_COMBO_TYPE_INVALID,
+	OBS_COMBO_TYPE_EDITABLE,
+	OBS_COMBO_TYPE_LIST
+};
+
+enum obs_combo_format {
+	OBS_COMBO_FORMAT_INVALID,
+	OBS_COMBO_FORMAT_INT,
+	OBS_COMBO_FORMAT_FLOAT,
+	OBS_COMBO_FORMAT_STRING
+};
+
+enum obs_text_type {
+	OBS_TEXT_DEFAULT,
+	OBS_TEXT_PASSWORD,
+	OBS_TEXT_MULTILINE
+};
+
+enum obs_editable_list_type {
+	OBS_EDITABLE_LIST_TYPE_STRINGS,
+	OBS_EDITABLE_LIST_TYPE_FILES,
+	OBS_EDITABLE_LIST_TYPE_FILES_AND_URLS
+};
+
+typedef bool (*obs_property_clicked_t)(obs_properties_t *props,
+	obs_property_t *property, void *data);
+typedef bool (*obs_property_modified2_t)(void *priv, obs_properties_t *props,
+	obs_property_t *property, obs_data_t *settings);
+
+obs_properties_t *obs_properties_create(void);
+void obs_properties_destroy(obs_properties_t *props);
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *prop);
+
+obs_property_t *obs_properties_add_bool(obs_properties_t *props,
+	const char *name, const char *description);
+obs_property_t *obs_properties_add_int(obs_properties_t *props,
+	const char *name, const char *description, int min, int max, int step);
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *props,
+	const char *name, const char *description, int min, int max, int step);
+obs_property_t *obs_properties_add_float(obs_properties_t *props,
+	const char *name, const char *description, double min, double max,
+	double step);
+obs_property_t *obs_properties_add_float_slider(obs_properties_t *props,
+	const char *name, const char *description, double min, double max,
+	double step);
+obs_property_t *obs_properties_add_text(obs_properties_t *props,
+	const char *name, const char *description, enum obs_text_type type);
+obs_property_t *obs_properties_add_list(obs_properties_t *props,
+	const char *name, const char *description, enum obs_combo_type type,
+	enum obs_combo_format format);
+obs_property_t *obs_properties_add_button(obs_properties_t *props,
+	const char *name, const char *text, obs_property_clicked_t callback);
+obs_property_t *obs_properties_add_editable_list(obs_properties_t *props,
+	const char *name, const char *description,
+	enum obs_editable_list_type type, const char *filter,
+	const char *default_path);
+
+void obs_property_set_visible(obs_property_t *p, bool visible);
+void obs_property_set_long_description(obs_property_t *p,
+	const char *long_description);
+void obs_property_set_modified_callback2(obs_property_t *p,
+	obs_property_modified2_t modified, void *priv);
+size_t obs_property_list_add_string(obs_property_t *p, const char *name,
+	const char *val);
+size_t obs_property_list_add_int(obs_property_t *p, const char *name,
+	long long val);
+void obs_property_list_clear(obs_property_t *p);
+
+/* Sources */
+
+enum obs_source_type {
+	OBS_SOURCE_TYPE_INPUT,
+	OBS_SOURCE_TYPE_FILTER,
+	OBS_SOURCE_TYPE_TRANSITION,
+	OBS_SOURCE_TYPE_SCENE
+};
+
+#define OBS_SOURCE_VIDEO    (1 << 0)
+
+enum obs_transition_target {
+	OBS_TRANSITION_SOURCE_A,
+	OBS_TRANSITION_SOURCE_B
+};
+
+struct obs_source_audio_mix;
+
+typedef void (*obs_source_enum_proc_t)(obs_source_t *parent,
+	obs_source_t *child, void *param);
+
+typedef float (*obs_transition_audio_mix_callback_t)(void *data, float t);
+
+struct obs_source_info {
+	const char          *id;
+	enum obs_source_type type;
+	uint32_t            output_flags;
+
+	const char *(*get_name)(void *type_data);
+	void *(*create)(obs_data_t *settings, obs_source_t *source);
+	void (*destroy)(void *data);
+	uint32_t (*get_width)(void *data);
+	uint32_t (*get_height)(void *data);
+	void (*get_defaults)(obs_data_t *settings);
+	obs_properties_t *(*get_properties)(void *data);
+	void (*update)(void *data, obs_data_t *settings);
+	void (*video_tick)(void *data, float seconds);
+	void (*video_render)(void *data, gs_effect_t *effect);
+	void (*enum_active_sources)(void *data,
+		obs_source_enum_proc_t enum_callback, void *param);
+	void (*enum_all_sources)(void *data,
+		obs_source_enum_proc_t enum_callback, void *param);
+	void (*save)(void *data, obs_data_t *settings);
+	void (*load)(void *data, obs_data_t *settings);
+	void (*filter_remove)(void *data, obs_source_t *source);
+	void (*transition_start)(void *data);
+	void (*transition_stop)(void *data);
+	bool (*audio_render)(void *data, uint64_t *ts_out,
+		struct obs_source_audio_mix *audio_output, uint32_t mixers,
+		size_t channels, size_t sample_rate);
+};
+
+void obs_register_source(struct obs_source_info *info);
+
+obs_source_t *obs_source_create(const char *id, const char *name,
+	obs_data_t *settings, obs_data_t *hotkey_data);
+obs_source_t *obs_source_create_private(const char *id, const char *name,
+	obs_data_t *settings);
+void obs_source_addref(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+void obs_source_remove(obs_source_t *source);
+bool obs_source_removed(const obs_source_t *source);
+obs_source_t *obs_get_source_by_name(const char *name);
+void obs_enum_scenes(bool (*enum_proc)(void *param, obs_source_t *source),
+	void *param);
+
+/*
+ * Sources saved in a scene collection. Everything is created first and
+ * loaded after, so scenes find the sources of their items by name.
+ */
+typedef void (*obs_load_source_cb)(void *private_data, obs_source_t *source);
+obs_source_t *obs_load_source(obs_data_t *data);
+void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
+	void *private_data);
+void obs_source_load(obs_source_t *source);
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source);
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak);
+void obs_weak_source_addref(obs_weak_source_t *weak);
+void obs_weak_source_release(obs_weak_source_t *weak);
+bool obs_weak_source_references_source(obs_weak_source_t *weak,
+	obs_source_t *source);
+
+const char *obs_source_get_name(const obs_source_t *source);
+const char *obs_source_get_id(const obs_source_t *source);
+enum obs_source_type obs_source_get_type(const obs_source_t *source);
+obs_data_t *obs_source_get_settings(const obs_source_t *source);
+void obs_source_update(obs_source_t *source, obs_data_t *settings);
+uint32_t obs_source_get_width(obs_source_t *source);
+uint32_t obs_source_get_height(obs_source_t *source);
+uint32_t obs_source_get_base_width(obs_source_t *source);
+uint32_t obs_source_get_base_height(obs_source_t *source);
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source);
+proc_handler_t *obs_source_get_proc_handler(const obs_source_t *source);
+
+bool obs_source_active(const obs_source_t *source);
+bool obs_source_showing(const obs_source_t *source);
+bool obs_source_add_active_child(obs_source_t *parent, obs_source_t *child);
+void obs_source_remove_active_child(obs_source_t *parent,
+	obs_source_t *child);
+void obs_source_video_render(obs_source_t *source);
+
+void obs_source_filter_add(obs_source_t *source, obs_source_t *filter);
+void obs_source_filter_remove(obs_source_t *source, obs_source_t *filter);
+void obs_source_enum_filters(obs_source_t *source,
+	obs_source_enum_proc_t callback, void *param);
+obs_source_t *obs_filter_get_parent(const obs_source_t *filter);
+obs_source_t *obs_source_get_filter_by_name(obs_source_t *source,
+	const char *name);
+
+float obs_transition_get_time(obs_source_t *transition);
+obs_source_t *obs_transition_get_source(obs_source_t *transition,
+	enum obs_transition_target target);
+obs_source_t *obs_transition_get_active_source(obs_source_t *transition);
+void obs_transition_video_render_direct(obs_source_t *transition,
+	enum obs_transition_target target);
+bool obs_transition_audio_render(obs_source_t *transition, uint64_t *ts_out,
+	struct obs_source_audio_mix *audio, uint32_t mixers, size_t channels,
+	size_t sample_rate, obs_transition_audio_mix_callback_t mix_a,
+	obs_transition_audio_mix_callback_t mix_b);
+
+/* Scenes */
+
+enum obs_bounds_type {
+	OBS_BOUNDS_NONE,
+	OBS_BOUNDS_STRETCH,
+	OBS_BOUNDS_SCALE_INNER,
+	OBS_BOUNDS_SCALE_OUTER,
+	OBS_BOUNDS_SCALE_TO_WIDTH,
+	OBS_BOUNDS_SCALE_TO_HEIGHT,
+	OBS_BOUNDS_MAX_ONLY
+};
+
+struct obs_transform_info {
+	struct vec2         pos;
+	float               rot;
+	struct vec2         scale;
+	uint32_t            alignment;
+	enum obs_bounds_type bounds_type;
+	uint32_t            bounds_alignment;
+	struct vec2         bounds;
+};
+
+struct obs_sceneitem_crop {
+	int                 left;
+	int                 top;
+	int                 right;
+	int                 bottom;
+};
+
+enum obs_scene_duplicate_type {
+	OBS_SCENE_DUP_REFS,
+	OBS_SCENE_DUP_COPY,
+	OBS_SCENE_DUP_PRIVATE_REFS,
+	OBS_SCENE_DUP_PRIVATE_COPY
+};
+
+typedef bool (*obs_scene_enum_t)(obs_scene_t *scene, obs_sceneitem_t *item,
+	void *param);
+typedef void (*obs_scene_atomic_update_func)(void *data, obs_scene_t *scene);
+
+obs_scene_t *obs_scene_create(const char *name);
+obs_scene_t *obs_scene_create_private(const char *name);
+obs_scene_t *obs_scene_duplicate(obs_scene_t *scene, const char *name,
+	enum obs_scene_duplicate_type type);
+void obs_scene_addref(obs_scene_t *scene);
+void obs_scene_release(obs_scene_t *scene);
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene);
+obs_scene_t *obs_scene_from_source(const obs_source_t *source);
+obs_scene_t *obs_group_from_source(const obs_source_t *source);
+
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source);
+obs_sceneitem_t *obs_scene_add_group(obs_scene_t *scene, const char *name);
+obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *name);
+obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene,
+	int64_t id);
+void obs_scene_enum_items(obs_scene_t *scene, obs_scene_enum_t callback,
+	void *param);
+void obs_scene_atomic_update(obs_scene_t *scene,
+	obs_scene_atomic_update_func func, void *data);
+
+void obs_sceneitem_addref(obs_sceneitem_t *item);
+void obs_sceneitem_release(obs_sceneitem_t *item);
+void obs_sceneitem_remove(obs_sceneitem_t *item);
+obs_scene_t *obs_sceneitem_get_scene(const obs_sceneitem_t *item);
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item);
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item);
+
+void obs_sceneitem_set_pos(obs_sceneitem_t *item, const struct vec2 *pos);
+void obs_sceneitem_set_rot(obs_sceneitem_t *item, float rot_deg);
+void obs_sceneitem_set_scale(obs_sceneitem_t *item, const struct vec2 *scale);
+void obs_sceneitem_set_bounds(obs_sceneitem_t *item,
+	const struct vec2 *bounds);
+void obs_sceneitem_set_bounds_type(obs_sceneitem_t *item,
+	enum obs_bounds_type type);
+void obs_sceneitem_set_alignment(obs_sceneitem_t *item, uint32_t alignment);
+void obs_sceneitem_set_crop(obs_sceneitem_t *item,
+	const struct obs_sceneitem_crop *crop);
+void obs_sceneitem_set_info(obs_sceneitem_t *item,
+	const struct obs_transform_info *info);
+bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible);
+
+void obs_sceneitem_get_pos(const obs_sceneitem_t *item, struct vec2 *pos);
+float obs_sceneitem_get_rot(const obs_sceneitem_t *item);
+void obs_sceneitem_get_scale(const obs_sceneitem_t *item, struct vec2 *scale);
+void obs_sceneitem_get_bounds(const obs_sceneitem_t *item,
+	struct vec2 *bounds);
+void obs_sceneitem_get_crop(const obs_sceneitem_t *item,
+	struct obs_sceneitem_crop *crop);
+void obs_sceneitem_get_info(const obs_sceneitem_t *item,
+	struct obs_transform_info *info);
+bool obs_sceneitem_visible(const obs_sceneitem_t *item);
+
+void obs_sceneitem_defer_update_begin(obs_sceneitem_t *item);
+void obs_sceneitem_defer_update_end(obs_sceneitem_t *item);
+
+bool obs_sceneitem_is_group(obs_sceneitem_t *item);
+obs_scene_t *obs_sceneitem_group_get_scene(const obs_sceneitem_t *group);
+void obs_sceneitem_group_add_item(obs_sceneitem_t *group,
+	obs_sceneitem_t *item);
+void obs_sceneitem_group_enum_items(obs_sceneitem_t *group,
+	obs_scene_enum_t callback, void *param);
@@ -0,0 +1,46 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "bmem.h"
+
+struct dstr {
+	char                *array;
+	size_t              len;
+	size_t              capacity;
+};
+
+static inline void dstr_init(struct dstr *dst)
+{
+	dst->array = NULL;
+	dst->len = 0;
+	dst->capacity = 0;
+}
+
+void dstr_free(struct dstr *dst);
+void dstr_copy(struct dstr *dst, const char *array);
+void dstr_ncopy(struct dstr *dst, const char *array, const size_t len);
+void dstr_cat(struct dstr *dst, const char *array);
+void dstr_ncat(struct dstr *dst, const char *array, const size_t len);
+void dstr_cat_ch(struct dstr *dst, char ch);
+void dstr_replace(struct dstr *str, const char *find, const char *replace);
+void dstr_printf(struct dstr *dst, const char *format, ...);
+void dstr_catf(struct dstr *dst, const char *format, ...);
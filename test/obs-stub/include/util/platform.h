@@ -0,0 +1,42 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "c99defs.h"
+
+uint64_t os_gettime_ns(void);
+void os_sleep_ms(uint32_t duration);
+
+FILE *os_fopen(const char *path, const char *mode);
+int64_t os_fgetsize(FILE *file);
+char *os_quick_read_utf8_file(const char *path);
+
+#define MKDIR_EXISTS   1
+#define MKDIR_SUCCESS  0
+#define MKDIR_ERROR    -1
+
+int os_mkdir(const char *path);
+int os_mkdirs(const char *path);
+bool os_file_exists(const char *path);
+int os_unlink(const char *path);
+int os_rename(const char *old_path, const char *new_path);
+
+int os_get_logical_cores(void);
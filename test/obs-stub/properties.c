@@ -0,0 +1,200 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <util/darray.h>
+#include "stub.h"
+
+/* Properties only need to exist, nothing shows them. */
+
+struct obs_property {
+	char                *name;
+	bool                visible;
+};
+
+struct obs_properties {
+	DARRAY(struct obs_property *) props;
+};
+
+obs_properties_t *obs_properties_create(void)
+{
+	return bzalloc(sizeof(struct obs_properties));
+}
+
+void obs_properties_destroy(obs_properties_t *props)
+{
+	size_t i;
+
+	if (!props)
+		return;
+
+	for (i = 0; i < props->props.num; i++) {
+		bfree(props->props.array[i]->name);
+		bfree(props->props.array[i]);
+	}
+	da_free(props->props);
+	bfree(props);
+}
+
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *prop)
+{
+	size_t i;
+
+	for (i = 0; props && i < props->props.num; i++) {
+		if (strcmp(props->props.array[i]->name, prop) == 0)
+			return props->props.array[i];
+	}
+	return NULL;
+}
+
+static obs_property_t *add_property(obs_properties_t *props,
+	const char *name)
+{
+	obs_property_t *p = bzalloc(sizeof(*p));
+
+	p->name = bstrdup(name);
+	p->visible = true;
+	da_push_back(props->props, &p);
+	return p;
+}
+
+obs_property_t *obs_properties_add_bool(obs_properties_t *props,
+	const char *name, const char *description)
+{
+	UNUSED_PARAMETER(description);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_int(obs_properties_t *props,
+	const char *name, const char *description, int min, int max, int step)
+{
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(min);
+	UNUSED_PARAMETER(max);
+	UNUSED_PARAMETER(step);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *props,
+	const char *name, const char *description, int min, int max, int step)
+{
+	return obs_properties_add_int(props, name, description, min, max,
+		step);
+}
+
+obs_property_t *obs_properties_add_float(obs_properties_t *props,
+	const char *name, const char *description, double min, double max,
+	double step)
+{
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(min);
+	UNUSED_PARAMETER(max);
+	UNUSED_PARAMETER(step);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_float_slider(obs_properties_t *props,
+	const char *name, const char *description, double min, double max,
+	double step)
+{
+	return obs_properties_add_float(props, name, description, min, max,
+		step);
+}
+
+obs_property_t *obs_properties_add_text(obs_properties_t *props,
+	const char *name, const char *description, enum obs_text_type type)
+{
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(type);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_list(obs_properties_t *props,
+	const char *name, const char *description, enum obs_combo_type type,
+	enum obs_combo_format format)
+{
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(type);
+	UNUSED_PARAMETER(format);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_button(obs_properties_t *props,
+	const char *name, const char *text, obs_property_clicked_t callback)
+{
+	UNUSED_PARAMETER(text);
+	UNUSED_PARAMETER(callback);
+	return add_property(props, name);
+}
+
+obs_property_t *obs_properties_add_editable_list(obs_properties_t *props,
+	const char *name, const char *description,
+	enum obs_editable_list_type type, const char *filter,
+	const char *default_path)
+{
+	UNUSED_PARAMETER(description);
+	UNUSED_PARAMETER(type);
+	UNUSED_PARAMETER(filter);
+	UNUSED_PARAMETER(default_path);
+	return add_property(props, name);
+}
+
+void obs_property_set_visible(obs_property_t *p, bool visible)
+{
+	if (p)
+		p->visible = visible;
+}
+
+void obs_property_set_long_description(obs_property_t *p,
+	const char *long_description)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(long_description);
+}
+
+void obs_property_set_modified_callback2(obs_property_t *p,
+	obs_property_modified2_t modified, void *priv)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(modified);
+	UNUSED_PARAMETER(priv);
+}
+
+size_t obs_property_list_add_string(obs_property_t *p, const char *name,
+	const char *val)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(val);
+	return 0;
+}
+
+size_t obs_property_list_add_int(obs_property_t *p, const char *name,
+	long long val)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(val);
+	return 0;
+}
+
+void obs_property_list_clear(obs_property_t *p)
+{
+	UNUSED_PARAMETER(p);
+}
@@ -0,0 +1,756 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <math.h>
+#include <graphics/math-defs.h>
+#include <util/threading.h>
+#include "stub.h"
+
+/*
+ * Scenes and groups as doubly linked item lists under the scene's video
+ * mutex. Setters store the value, count the call, rebuild the affine part
+ * of the box transform and signal "item_transform", so that a setter
+ * costs roughly what it does in libobs. Like libobs they ignore a NULL
+ * item, and a removed item only stores the value.
+ */
+
+#define ALIGN_TOP_LEFT      (1 | 4)
+
+static void *scene_create(obs_data_t *settings, obs_source_t *source)
+{
+	obs_scene_t *scene = bzalloc(sizeof(*scene));
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&scene->video_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	scene->source = source;
+	scene->is_group = strcmp(source->id, "group") == 0;
+	source->scene = scene;
+	UNUSED_PARAMETER(settings);
+	return scene;
+}
+
+static void detach_item(obs_sceneitem_t *item)
+{
+	obs_scene_t *scene = item->parent;
+
+	if (item->prev)
+		item->prev->next = item->next;
+	else
+		scene->first_item = item->next;
+	if (item->next)
+		item->next->prev = item->prev;
+
+	item->prev = NULL;
+	item->next = NULL;
+}
+
+static void attach_item(obs_scene_t *scene, obs_sceneitem_t *item)
+{
+	obs_sceneitem_t *last = scene->first_item;
+
+	item->parent = scene;
+	if (!last) {
+		scene->first_item = item;
+		return;
+	}
+
+	while (last->next)
+		last = last->next;
+	last->next = item;
+	item->prev = last;
+}
+
+static void scene_destroy(void *data)
+{
+	obs_scene_t *scene = data;
+
+	while (scene->first_item)
+		obs_sceneitem_remove(scene->first_item);
+
+	pthread_mutex_destroy(&scene->video_mutex);
+	bfree(scene);
+}
+
+static void scene_enum_active(void *data, obs_source_enum_proc_t callback,
+	void *param)
+{
+	obs_scene_t *scene = data;
+	obs_sceneitem_t *item;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	for (item = scene->first_item; item; item = item->next) {
+		if (item->visible)
+			callback(scene->source, item->source, param);
+	}
+	pthread_mutex_unlock(&scene->video_mutex);
+}
+
+static void scene_enum_all(void *data, obs_source_enum_proc_t callback,
+	void *param)
+{
+	obs_scene_t *scene = data;
+	obs_sceneitem_t *item;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	for (item = scene->first_item; item; item = item->next)
+		callback(scene->source, item->source, param);
+	pthread_mutex_unlock(&scene->video_mutex);
+}
+
+static obs_sceneitem_t *add_item(obs_scene_t *scene, obs_source_t *source,
+	int64_t id);
+
+static void get_vec2(obs_data_t *data, const char *name, struct vec2 *val)
+{
+	obs_data_t *obj = obs_data_get_obj(data, name);
+
+	if (!obj)
+		return;
+	val->x = (float)obs_data_get_double(obj, "x");
+	val->y = (float)obs_data_get_double(obj, "y");
+	obs_data_release(obj);
+}
+
+/*
+ * Items of a saved scene, with the keys libobs writes. Sources are looked
+ * up by name, so everything has to be created before scenes are loaded.
+ */
+
+static void load_item(obs_scene_t *scene, obs_data_t *data)
+{
+	const char *name = obs_data_get_string(data, "name");
+	obs_source_t *source = obs_get_source_by_name(name);
+	obs_sceneitem_t *item;
+
+	if (!source) {
+		blog(LOG_WARNING, "stub: no source '%s' for scene '%s'", name,
+			obs_source_get_name(scene->source));
+		return;
+	}
+
+	item = add_item(scene, source, obs_data_get_int(data, "id"));
+	obs_source_release(source);
+
+	get_vec2(data, "pos", &item->pos);
+	get_vec2(data, "scale", &item->scale);
+	get_vec2(data, "bounds", &item->bounds);
+	item->rot = (float)obs_data_get_double(data, "rot");
+	if (obs_data_has_user_value(data, "align"))
+		item->align = (uint32_t)obs_data_get_int(data, "align");
+	item->bounds_type = (enum obs_bounds_type)obs_data_get_int(data,
+		"bounds_type");
+	item->bounds_align = (uint32_t)obs_data_get_int(data, "bounds_align");
+	item->crop.left = (int)obs_data_get_int(data, "crop_left");
+	item->crop.top = (int)obs_data_get_int(data, "crop_top");
+	item->crop.right = (int)obs_data_get_int(data, "crop_right");
+	item->crop.bottom = (int)obs_data_get_int(data, "crop_bottom");
+
+	if (obs_data_has_user_value(data, "visible"))
+		obs_sceneitem_set_visible(item, obs_data_get_bool(data,
+			"visible"));
+}
+
+static void scene_load(void *data, obs_data_t *settings)
+{
+	obs_scene_t *scene = data;
+	obs_data_array_t *items = obs_data_get_array(settings, "items");
+	size_t i, count = obs_data_array_count(items);
+
+	for (i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(items, i);
+		load_item(scene, item);
+		obs_data_release(item);
+	}
+
+	obs_data_array_release(items);
+}
+
+struct obs_source_info stub_scene_info = {
+	.id = "scene",
+	.type = OBS_SOURCE_TYPE_SCENE,
+	.output_flags = OBS_SOURCE_VIDEO,
+	.create = scene_create,
+	.destroy = scene_destroy,
+	.enum_active_sources = scene_enum_active,
+	.enum_all_sources = scene_enum_all,
+	.load = scene_load
+};
+
+struct obs_source_info stub_group_info = {
+	.id = "group",
+	.type = OBS_SOURCE_TYPE_SCENE,
+	.output_flags = OBS_SOURCE_VIDEO,
+	.create = scene_create,
+	.destroy = scene_destroy,
+	.enum_active_sources = scene_enum_active,
+	.enum_all_sources = scene_enum_all,
+	.load = scene_load
+};
+
+/* Scenes */
+
+obs_scene_t *obs_scene_create(const char *name)
+{
+	obs_source_t *source = obs_source_create("scene", name, NULL, NULL);
+	return source ? source->scene : NULL;
+}
+
+obs_scene_t *obs_scene_create_private(const char *name)
+{
+	obs_source_t *source = obs_source_create_private("scene", name, NULL);
+	return source ? source->scene : NULL;
+}
+
+void obs_scene_addref(obs_scene_t *scene)
+{
+	if (scene)
+		obs_source_addref(scene->source);
+}
+
+void obs_scene_release(obs_scene_t *scene)
+{
+	if (scene)
+		obs_source_release(scene->source);
+}
+
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene)
+{
+	return scene ? scene->source : NULL;
+}
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+	if (!source || strcmp(source->id, "scene") != 0)
+		return NULL;
+	return source->scene;
+}
+
+obs_scene_t *obs_group_from_source(const obs_source_t *source)
+{
+	if (!source || strcmp(source->id, "group") != 0)
+		return NULL;
+	return source->scene;
+}
+
+static void signal_item(obs_sceneitem_t *item, const char *signal)
+{
+	calldata_t cd = { 0 };
+
+	if (!item->parent)
+		return;
+
+	calldata_set_ptr(&cd, "scene", item->parent);
+	calldata_set_ptr(&cd, "item", item);
+	stub_signal(item->parent->source, signal, &cd);
+	calldata_free(&cd);
+}
+
+static obs_sceneitem_t *add_item(obs_scene_t *scene, obs_source_t *source,
+	int64_t id)
+{
+	obs_sceneitem_t *item;
+
+	if (!scene || !source)
+		return NULL;
+
+	item = bzalloc(sizeof(*item));
+	item->ref = 1;
+	item->source = source;
+	item->user_visible = true;
+	item->visible = true;
+	item->is_group = obs_group_from_source(source) != NULL;
+	item->align = ALIGN_TOP_LEFT;
+	vec2_set(&item->scale, 1.0f, 1.0f);
+	obs_source_addref(source);
+
+	pthread_mutex_lock(&scene->video_mutex);
+	item->id = id ? id : ++scene->id_counter;
+	if (item->id > scene->id_counter)
+		scene->id_counter = item->id;
+	attach_item(scene, item);
+	pthread_mutex_unlock(&scene->video_mutex);
+
+	signal_item(item, "item_add");
+	stub_refresh_active(scene->source);
+	return item;
+}
+
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source)
+{
+	return add_item(scene, source, 0);
+}
+
+obs_sceneitem_t *obs_scene_add_group(obs_scene_t *scene, const char *name)
+{
+	obs_source_t *source = obs_source_create("group", name, NULL, NULL);
+	obs_sceneitem_t *item = obs_scene_add(scene, source);
+
+	obs_source_release(source);
+	return item;
+}
+
+obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *name)
+{
+	obs_sceneitem_t *item;
+
+	if (!scene || !name)
+		return NULL;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	for (item = scene->first_item; item; item = item->next) {
+		const char *item_name = obs_source_get_name(item->source);
+
+		if (item_name && strcmp(item_name, name) == 0)
+			break;
+	}
+	pthread_mutex_unlock(&scene->video_mutex);
+	return item;
+}
+
+obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene,
+	int64_t id)
+{
+	obs_sceneitem_t *item;
+
+	if (!scene)
+		return NULL;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	for (item = scene->first_item; item; item = item->next) {
+		if (item->id == id)
+			break;
+	}
+	pthread_mutex_unlock(&scene->video_mutex);
+	return item;
+}
+
+void obs_scene_enum_items(obs_scene_t *scene, obs_scene_enum_t callback,
+	void *param)
+{
+	obs_sceneitem_t *item;
+
+	if (!scene)
+		return;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	item = scene->first_item;
+	while (item) {
+		obs_sceneitem_t *next = item->next;
+
+		obs_sceneitem_addref(item);
+		if (!callback(scene, item, param)) {
+			obs_sceneitem_release(item);
+			break;
+		}
+		obs_sceneitem_release(item);
+		item = next;
+	}
+	pthread_mutex_unlock(&scene->video_mutex);
+}
+
+void obs_scene_atomic_update(obs_scene_t *scene,
+	obs_scene_atomic_update_func func, void *data)
+{
+	if (!scene)
+		return;
+
+	obs_scene_addref(scene);
+	pthread_mutex_lock(&scene->video_mutex);
+	func(data, scene);
+	pthread_mutex_unlock(&scene->video_mutex);
+	obs_scene_release(scene);
+}
+
+/*
+ * Items keep their ids, groups are duplicated with their items. Private
+ * duplicates get private groups, as the frontend's program copy does.
+ */
+
+static void duplicate_items(obs_scene_t *dst, obs_scene_t *src,
+	bool private)
+{
+	obs_sceneitem_t *item;
+
+	for (item = src->first_item; item; item = item->next) {
+		obs_source_t *source = item->source;
+		obs_sceneitem_t *copy;
+
+		if (item->is_group) {
+			source = private ? obs_source_create_private("group",
+				obs_source_get_name(source), NULL) :
+				obs_source_create("group",
+				obs_source_get_name(source), NULL, NULL);
+			duplicate_items(source->scene, item->source->scene,
+				private);
+			source->scene->id_counter = item->source->scene->id_counter;
+		} else {
+			obs_source_addref(source);
+		}
+
+		copy = add_item(dst, source, item->id);
+		copy->user_visible = item->user_visible;
+		copy->visible = item->visible;
+		copy->pos = item->pos;
+		copy->scale = item->scale;
+		copy->rot = item->rot;
+		copy->align = item->align;
+		copy->bounds_type = item->bounds_type;
+		copy->bounds_align = item->bounds_align;
+		copy->bounds = item->bounds;
+		copy->crop = item->crop;
+		obs_source_release(source);
+	}
+}
+
+obs_scene_t *obs_scene_duplicate(obs_scene_t *scene, const char *name,
+	enum obs_scene_duplicate_type type)
+{
+	bool private = type == OBS_SCENE_DUP_PRIVATE_REFS ||
+		type == OBS_SCENE_DUP_PRIVATE_COPY;
+	obs_scene_t *copy;
+
+	if (!scene)
+		return NULL;
+
+	copy = private ? obs_scene_create_private(name) :
+		obs_scene_create(name);
+
+	pthread_mutex_lock(&scene->video_mutex);
+	duplicate_items(copy, scene, private);
+	copy->id_counter = scene->id_counter;
+	pthread_mutex_unlock(&scene->video_mutex);
+
+	stub_refresh_active(copy->source);
+	return copy;
+}
+
+/* Items */
+
+void obs_sceneitem_addref(obs_sceneitem_t *item)
+{
+	if (item)
+		os_atomic_inc_long(&item->ref);
+}
+
+void obs_sceneitem_release(obs_sceneitem_t *item)
+{
+	if (!item || os_atomic_dec_long(&item->ref) > 0)
+		return;
+
+	obs_source_release(item->source);
+	bfree(item);
+}
+
+void obs_sceneitem_remove(obs_sceneitem_t *item)
+{
+	obs_scene_t *scene;
+
+	if (!item || item->removed)
+		return;
+
+	scene = item->parent;
+	item->removed = true;
+
+	pthread_mutex_lock(&scene->video_mutex);
+	detach_item(item);
+	pthread_mutex_unlock(&scene->video_mutex);
+
+	signal_item(item, "item_remove");
+	stub_refresh_active(scene->source);
+
+	// A removed item that is still referenced has no scene, as in libobs
+	item->parent = NULL;
+	obs_sceneitem_release(item);
+}
+
+obs_scene_t *obs_sceneitem_get_scene(const obs_sceneitem_t *item)
+{
+	return item ? item->parent : NULL;
+}
+
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+	return item ? item->source : NULL;
+}
+
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item)
+{
+	return item ? item->id : 0;
+}
+
+static void update_item_transform(obs_sceneitem_t *item)
+{
+	struct obs_sceneitem_crop *crop = &item->crop;
+	float rad = RAD(item->rot);
+	float c = cosf(rad), s = sinf(rad);
+	struct vec2 size;
+
+	if (item->bounds_type != OBS_BOUNDS_NONE) {
+		size = item->bounds;
+	} else {
+		uint32_t width = obs_source_get_width(item->source);
+		uint32_t height = obs_source_get_height(item->source);
+
+		vec2_set(&size,
+			(float)((int)width - crop->left - crop->right) *
+			item->scale.x,
+			(float)((int)height - crop->top - crop->bottom) *
+			item->scale.y);
+	}
+
+	item->box_transform[0] = c * size.x;
+	item->box_transform[1] = s * size.x;
+	item->box_transform[2] = -s * size.y;
+	item->box_transform[3] = c * size.y;
+	item->box_transform[4] = item->pos.x;
+	item->box_transform[5] = item->pos.y;
+
+	signal_item(item, "item_transform");
+}
+
+static void transform_changed(obs_sceneitem_t *item)
+{
+	if (os_atomic_load_long(&item->defer_update))
+		item->update_transform = true;
+	else
+		update_item_transform(item);
+}
+
+void obs_sceneitem_set_pos(obs_sceneitem_t *item, const struct vec2 *pos)
+{
+	if (!item)
+		return;
+
+	item->pos = *pos;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_rot(obs_sceneitem_t *item, float rot_deg)
+{
+	if (!item)
+		return;
+
+	item->rot = rot_deg;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_scale(obs_sceneitem_t *item, const struct vec2 *scale)
+{
+	if (!item)
+		return;
+
+	item->scale = *scale;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_bounds(obs_sceneitem_t *item,
+	const struct vec2 *bounds)
+{
+	if (!item)
+		return;
+
+	item->bounds = *bounds;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_bounds_type(obs_sceneitem_t *item,
+	enum obs_bounds_type type)
+{
+	if (!item)
+		return;
+
+	item->bounds_type = type;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_alignment(obs_sceneitem_t *item, uint32_t alignment)
+{
+	if (!item)
+		return;
+
+	item->align = alignment;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_info(obs_sceneitem_t *item,
+	const struct obs_transform_info *info)
+{
+	if (!item)
+		return;
+
+	item->pos = info->pos;
+	item->rot = info->rot;
+	item->scale = info->scale;
+	item->align = info->alignment;
+	item->bounds_type = info->bounds_type;
+	item->bounds_align = info->bounds_alignment;
+	item->bounds = info->bounds;
+	stub_count(&stub_counters.transform_sets);
+	transform_changed(item);
+}
+
+void obs_sceneitem_set_crop(obs_sceneitem_t *item,
+	const struct obs_sceneitem_crop *crop)
+{
+	if (!item)
+		return;
+
+	stub_count(&stub_counters.crop_sets);
+	item->crop = *crop;
+	transform_changed(item);
+}
+
+bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
+{
+	calldata_t cd = { 0 };
+
+	if (!item)
+		return false;
+	if (item->user_visible == visible)
+		return true;
+
+	item->user_visible = visible;
+	item->visible = visible;
+	if (!item->parent)
+		return true;
+
+	calldata_set_ptr(&cd, "scene", item->parent);
+	calldata_set_ptr(&cd, "item", item);
+	calldata_set_bool(&cd, "visible", visible);
+	stub_signal(item->parent->source, "item_visible", &cd);
+	calldata_free(&cd);
+
+	stub_refresh_active(item->parent->source);
+	return true;
+}
+
+void obs_sceneitem_get_pos(const obs_sceneitem_t *item, struct vec2 *pos)
+{
+	*pos = item->pos;
+}
+
+float obs_sceneitem_get_rot(const obs_sceneitem_t *item)
+{
+	return item->rot;
+}
+
+void obs_sceneitem_get_scale(const obs_sceneitem_t *item, struct vec2 *scale)
+{
+	*scale = item->scale;
+}
+
+void obs_sceneitem_get_bounds(const obs_sceneitem_t *item,
+	struct vec2 *bounds)
+{
+	*bounds = item->bounds;
+}
+
+void obs_sceneitem_get_crop(const obs_sceneitem_t *item,
+	struct obs_sceneitem_crop *crop)
+{
+	*crop = item->crop;
+}
+
+void obs_sceneitem_get_info(const obs_sceneitem_t *item,
+	struct obs_transform_info *info)
+{
+	info->pos = item->pos;
+	info->rot = item->rot;
+	info->scale = item->scale;
+	info->alignment = item->align;
+	info->bounds_type = item->bounds_type;
+	info->bounds_alignment = item->bounds_align;
+	info->bounds = item->bounds;
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t *item)
+{
+	return item ? item->user_visible : false;
+}
+
+void obs_sceneitem_defer_update_begin(obs_sceneitem_t *item)
+{
+	os_atomic_inc_long(&item->defer_update);
+}
+
+void obs_sceneitem_defer_update_end(obs_sceneitem_t *item)
+{
+	if (os_atomic_dec_long(&item->defer_update) == 0 &&
+		item->update_transform) {
+		item->update_transform = false;
+		update_item_transform(item);
+	}
+}
+
+/* Groups */
+
+bool obs_sceneitem_is_group(obs_sceneitem_t *item)
+{
+	return item && item->is_group;
+}
+
+obs_scene_t *obs_sceneitem_group_get_scene(const obs_sceneitem_t *group)
+{
+	return group && group->is_group ? group->source->scene : NULL;
+}
+
+/* Moves the item into the group, keeping its id and transform. */
+
+void obs_sceneitem_group_add_item(obs_sceneitem_t *group,
+	obs_sceneitem_t *item)
+{
+	obs_scene_t *from, *to;
+
+	if (!group || !group->is_group || !item || item == group)
+		return;
+
+	from = item->parent;
+	to = group->source->scene;
+
+	pthread_mutex_lock(&from->video_mutex);
+	detach_item(item);
+	pthread_mutex_unlock(&from->video_mutex);
+
+	pthread_mutex_lock(&to->video_mutex);
+	attach_item(to, item);
+	if (item->id > to->id_counter)
+		to->id_counter = item->id;
+	pthread_mutex_unlock(&to->video_mutex);
+
+	stub_refresh_active(from->source);
+	stub_refresh_active(to->source);
+}
+
+void obs_sceneitem_group_enum_items(obs_sceneitem_t *group,
+	obs_scene_enum_t callback, void *param)
+{
+	obs_scene_enum_items(obs_sceneitem_group_get_scene(group), callback,
+		param);
+}
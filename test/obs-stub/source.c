@@ -0,0 +1,1208 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/threading.h>
+#include "stub.h"
+
+/*
+ * Sources, activation, transitions, hotkeys and the frontend. Sources are
+ * kept in one list that is ticked like libobs ticks them, activation is
+ * tracked per source so that "activate" and "deactivate" fire on the same
+ * edges as in OBS.
+ */
+
+struct tick_callback {
+	void (*tick)(void *param, float seconds);
+	void                *param;
+};
+
+struct hotkey {
+	obs_hotkey_id       id;
+	obs_hotkey_func     func;
+	void                *data;
+};
+
+struct frontend_callback {
+	obs_frontend_event_cb callback;
+	void                *data;
+};
+
+struct color_source {
+	uint32_t            width;
+	uint32_t            height;
+};
+
+static struct {
+	pthread_mutex_t     mutex;
+	DARRAY(struct obs_source_info) types;
+	DARRAY(obs_source_t *) sources;
+	DARRAY(struct tick_callback) ticks;
+	DARRAY(struct hotkey) hotkeys;
+	obs_hotkey_id       next_hotkey;
+	DARRAY(struct frontend_callback) events;
+	signal_handler_t    *signals;
+	obs_source_t        *program;
+	obs_source_t        *preview;
+	obs_source_t        *transition;
+	bool                studio_mode;
+	struct obs_video_info ovi;
+	uint64_t            frame_time;
+	char                *config_path;
+} obs;
+
+struct obs_stub_counters stub_counters;
+
+/* Builtin sources */
+
+static void *color_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct color_source *color = bzalloc(sizeof(*color));
+	color->width = (uint32_t)obs_data_get_int(settings, "width");
+	color->height = (uint32_t)obs_data_get_int(settings, "height");
+	UNUSED_PARAMETER(source);
+	return color;
+}
+
+static void color_update(void *data, obs_data_t *settings)
+{
+	struct color_source *color = data;
+	color->width = (uint32_t)obs_data_get_int(settings, "width");
+	color->height = (uint32_t)obs_data_get_int(settings, "height");
+}
+
+static void color_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "width", 400);
+	obs_data_set_default_int(settings, "height", 400);
+}
+
+static uint32_t color_width(void *data)
+{
+	return ((struct color_source *)data)->width;
+}
+
+static uint32_t color_height(void *data)
+{
+	return ((struct color_source *)data)->height;
+}
+
+static struct obs_source_info color_info = {
+	.id = "color_source",
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_VIDEO,
+	.create = color_create,
+	.destroy = bfree,
+	.update = color_update,
+	.get_defaults = color_defaults,
+	.get_width = color_width,
+	.get_height = color_height
+};
+
+/* Core */
+
+void obs_stub_startup(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&obs.mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	obs.signals = signal_handler_create();
+	obs_stub_set_video(1920, 1080, 60);
+	obs_register_source(&stub_scene_info);
+	obs_register_source(&stub_group_info);
+	obs_register_source(&color_info);
+}
+
+void obs_stub_shutdown(void)
+{
+	obs_stub_set_program(NULL);
+	obs_source_release(obs.preview);
+	obs_source_release(obs.transition);
+	obs.preview = NULL;
+	obs.transition = NULL;
+
+	if (obs.sources.num)
+		blog(LOG_WARNING, "stub: %d sources leaked",
+			(int)obs.sources.num);
+
+	da_free(obs.types);
+	da_free(obs.sources);
+	da_free(obs.ticks);
+	da_free(obs.hotkeys);
+	da_free(obs.events);
+	signal_handler_destroy(obs.signals);
+	bfree(obs.config_path);
+	pthread_mutex_destroy(&obs.mutex);
+	memset(&obs, 0, sizeof(obs));
+}
+
+void obs_stub_set_config_path(const char *path)
+{
+	bfree(obs.config_path);
+	obs.config_path = bstrdup(path);
+}
+
+void obs_stub_set_video(uint32_t width, uint32_t height, uint32_t fps)
+{
+	obs.ovi.graphics_module = "stub";
+	obs.ovi.fps_num = fps;
+	obs.ovi.fps_den = 1;
+	obs.ovi.base_width = obs.ovi.output_width = width;
+	obs.ovi.base_height = obs.ovi.output_height = height;
+}
+
+bool obs_get_video_info(struct obs_video_info *ovi)
+{
+	*ovi = obs.ovi;
+	return true;
+}
+
+uint64_t obs_get_video_frame_time(void)
+{
+	return obs.frame_time;
+}
+
+obs_source_t *obs_get_output_source(uint32_t channel)
+{
+	obs_source_t *source;
+
+	if (channel != 0)
+		return NULL;
+
+	pthread_mutex_lock(&obs.mutex);
+	source = obs.program;
+	obs_source_addref(source);
+	pthread_mutex_unlock(&obs.mutex);
+	return source;
+}
+
+const char *obs_get_version_string(void)
+{
+	return "stub";
+}
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+	return obs.signals;
+}
+
+void *obs_obj_get_data(void *obj)
+{
+	return obj ? ((obs_source_t *)obj)->context.data : NULL;
+}
+
+const char *obs_module_text(const char *lookup_string)
+{
+	return lookup_string;
+}
+
+char *obs_module_config_path(const char *file)
+{
+	struct dstr path = { 0 };
+
+	if (!obs.config_path)
+		return NULL;
+
+	dstr_printf(&path, "%s/%s", obs.config_path, file);
+	return path.array;
+}
+
+void obs_stub_get_counters(struct obs_stub_counters *counters)
+{
+	*counters = stub_counters;
+}
+
+void obs_stub_reset_counters(void)
+{
+	memset(&stub_counters, 0, sizeof(stub_counters));
+}
+
+size_t obs_stub_source_count(void)
+{
+	size_t count;
+
+	pthread_mutex_lock(&obs.mutex);
+	count = obs.sources.num;
+	pthread_mutex_unlock(&obs.mutex);
+	return count;
+}
+
+/* Ticking */
+
+void obs_add_tick_callback(void (*tick)(void *param, float seconds),
+	void *param)
+{
+	struct tick_callback callback = { tick, param };
+
+	pthread_mutex_lock(&obs.mutex);
+	da_push_back(obs.ticks, &callback);
+	pthread_mutex_unlock(&obs.mutex);
+}
+
+void obs_remove_tick_callback(void (*tick)(void *param, float seconds),
+	void *param)
+{
+	struct tick_callback callback = { tick, param };
+
+	pthread_mutex_lock(&obs.mutex);
+	da_erase_item(obs.ticks, &callback);
+	pthread_mutex_unlock(&obs.mutex);
+}
+
+void obs_stub_tick(float seconds)
+{
+	DARRAY(struct tick_callback) ticks = { 0 };
+	DARRAY(obs_source_t *) sources = { 0 };
+	size_t i;
+
+	pthread_mutex_lock(&obs.mutex);
+	obs.frame_time += (uint64_t)(seconds * 1000000000.0);
+	da_copy(ticks, obs.ticks);
+	da_copy(sources, obs.sources);
+	for (i = 0; i < sources.num; i++)
+		obs_source_addref(sources.array[i]);
+	pthread_mutex_unlock(&obs.mutex);
+
+	for (i = 0; i < ticks.num; i++)
+		ticks.array[i].tick(ticks.array[i].param, seconds);
+
+	for (i = 0; i < sources.num; i++) {
+		obs_source_t *source = sources.array[i];
+
+		if (source->context.data &&
+			os_atomic_set_long(&source->defer_update, 0))
+			source->info->update(source->context.data,
+				source->context.settings);
+		if (source->info->video_tick && source->context.data)
+			source->info->video_tick(source->context.data, seconds);
+		obs_source_release(source);
+	}
+
+	da_free(ticks);
+	da_free(sources);
+}
+
+/* Sources */
+
+void obs_register_source(struct obs_source_info *info)
+{
+	da_push_back(obs.types, info);
+}
+
+static const struct obs_source_info *find_type(const char *id)
+{
+	size_t i;
+
+	for (i = 0; i < obs.types.num; i++) {
+		if (strcmp(obs.types.array[i].id, id) == 0)
+			return &obs.types.array[i];
+	}
+	return NULL;
+}
+
+void stub_signal(obs_source_t *source, const char *signal, calldata_t *cd)
+{
+	stub_count(&stub_counters.signals);
+	signal_handler_signal(source->context.signals, signal, cd);
+}
+
+static void signal_source(obs_source_t *source, const char *signal)
+{
+	calldata_t cd = { 0 };
+
+	calldata_set_ptr(&cd, "source", source);
+	stub_signal(source, signal, &cd);
+	calldata_free(&cd);
+}
+
+static obs_source_t *create_source(const char *id, const char *name,
+	obs_data_t *settings, bool private)
+{
+	const struct obs_source_info *info = find_type(id);
+	obs_source_t *source;
+
+	if (!info) {
+		blog(LOG_WARNING, "stub: source type '%s' not found", id);
+		return NULL;
+	}
+
+	source = bzalloc(sizeof(*source));
+	source->info = info;
+	source->id = bstrdup(id);
+	source->refs = 1;
+	source->control = bzalloc(sizeof(*source->control));
+	source->control->refs = 1;
+	source->control->source = source;
+	source->context.name = bstrdup(name);
+	source->context.private = private;
+	source->context.signals = signal_handler_create();
+	source->context.procs = proc_handler_create();
+	source->context.settings = obs_data_create();
+
+	if (info->get_defaults)
+		info->get_defaults(source->context.settings);
+	obs_data_apply(source->context.settings, settings);
+
+	if (info->create)
+		source->context.data = info->create(source->context.settings,
+			source);
+
+	pthread_mutex_lock(&obs.mutex);
+	da_push_back(obs.sources, &source);
+	pthread_mutex_unlock(&obs.mutex);
+
+	if (!private) {
+		calldata_t cd = { 0 };
+		calldata_set_ptr(&cd, "source", source);
+		signal_handler_signal(obs.signals, "source_create", &cd);
+		calldata_free(&cd);
+	}
+	return source;
+}
+
+obs_source_t *obs_source_create(const char *id, const char *name,
+	obs_data_t *settings, obs_data_t *hotkey_data)
+{
+	UNUSED_PARAMETER(hotkey_data);
+	return create_source(id, name, settings, false);
+}
+
+obs_source_t *obs_source_create_private(const char *id, const char *name,
+	obs_data_t *settings)
+{
+	return create_source(id, name, settings, true);
+}
+
+void obs_source_addref(obs_source_t *source)
+{
+	if (source)
+		os_atomic_inc_long(&source->refs);
+}
+
+static void destroy_source(obs_source_t *source)
+{
+	signal_source(source, "destroy");
+
+	while (source->filters.num)
+		obs_source_filter_remove(source, source->filters.array[0]);
+
+	if (source->info->type == OBS_SOURCE_TYPE_TRANSITION) {
+		obs_source_release(source->transition_sources[0]);
+		obs_source_release(source->transition_sources[1]);
+		source->transition_sources[0] = NULL;
+		source->transition_sources[1] = NULL;
+	}
+
+	while (source->active_children.num)
+		obs_source_remove_active_child(source,
+			source->active_children.array[0]);
+
+	if (source->info->destroy && source->context.data)
+		source->info->destroy(source->context.data);
+
+	while (source->activated.num) {
+		obs_source_t *child = source->activated.array[0];
+		da_erase(source->activated, 0);
+		obs_source_release(child);
+	}
+
+	source->control->source = NULL;
+	obs_weak_source_release(source->control);
+	obs_data_release(source->context.settings);
+	signal_handler_destroy(source->context.signals);
+	proc_handler_destroy(source->context.procs);
+	da_free(source->active_children);
+	da_free(source->activated);
+	da_free(source->filters);
+	bfree(source->context.name);
+	bfree(source->id);
+	bfree(source);
+}
+
+/* The list lock keeps a tick from picking up a source being destroyed. */
+
+void obs_source_release(obs_source_t *source)
+{
+	bool destroy;
+
+	if (!source)
+		return;
+
+	pthread_mutex_lock(&obs.mutex);
+	destroy = os_atomic_dec_long(&source->refs) == 0;
+	if (destroy)
+		da_erase_item(obs.sources, &source);
+	pthread_mutex_unlock(&obs.mutex);
+
+	if (destroy)
+		destroy_source(source);
+}
+
+void obs_source_remove(obs_source_t *source)
+{
+	if (!source || source->removed)
+		return;
+
+	source->removed = true;
+	signal_source(source, "remove");
+}
+
+bool obs_source_removed(const obs_source_t *source)
+{
+	return source ? source->removed : true;
+}
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+	obs_source_t *result = NULL;
+	size_t i;
+
+	if (!name)
+		return NULL;
+
+	pthread_mutex_lock(&obs.mutex);
+	for (i = 0; i < obs.sources.num; i++) {
+		obs_source_t *source = obs.sources.array[i];
+
+		if (!source->context.private && !source->removed &&
+			source->context.name &&
+			strcmp(source->context.name, name) == 0) {
+			result = source;
+			obs_source_addref(result);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&obs.mutex);
+	return result;
+}
+
+/* Public scenes and groups, called without the list lock held. */
+
+void obs_enum_scenes(bool (*enum_proc)(void *param, obs_source_t *source),
+	void *param)
+{
+	DARRAY(obs_source_t *) scenes = { 0 };
+	size_t i;
+
+	pthread_mutex_lock(&obs.mutex);
+	for (i = 0; i < obs.sources.num; i++) {
+		obs_source_t *source = obs.sources.array[i];
+
+		if (source->scene && !source->context.private &&
+			!source->removed) {
+			obs_source_addref(source);
+			da_push_back(scenes, &source);
+		}
+	}
+	pthread_mutex_unlock(&obs.mutex);
+
+	for (i = 0; i < scenes.num; i++) {
+		if (!enum_proc(param, scenes.array[i]))
+			break;
+	}
+	for (i = 0; i < scenes.num; i++)
+		obs_source_release(scenes.array[i]);
+	da_free(scenes);
+}
+
+/* Filters are private, their names only have to be unique per source. */
+
+obs_source_t *obs_load_source(obs_data_t *data)
+{
+	obs_data_array_t *filters = obs_data_get_array(data, "filters");
+	obs_data_t *settings = obs_data_get_obj(data, "settings");
+	obs_source_t *source = obs_source_create(obs_data_get_string(data, "id"),
+		obs_data_get_string(data, "name"), settings, NULL);
+	size_t i;
+
+	for (i = 0; source && i < obs_data_array_count(filters); i++) {
+		obs_data_t *filter_data = obs_data_array_item(filters, i);
+		obs_data_t *filter_settings = obs_data_get_obj(filter_data,
+			"settings");
+		obs_source_t *filter = obs_source_create_private(
+			obs_data_get_string(filter_data, "id"),
+			obs_data_get_string(filter_data, "name"),
+			filter_settings);
+
+		obs_source_filter_add(source, filter);
+		obs_source_release(filter);
+		obs_data_release(filter_settings);
+		obs_data_release(filter_data);
+	}
+
+	obs_data_release(settings);
+	obs_data_array_release(filters);
+	return source;
+}
+
+void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
+	void *private_data)
+{
+	DARRAY(obs_source_t *) sources = { 0 };
+	size_t i;
+
+	for (i = 0; i < obs_data_array_count(array); i++) {
+		obs_data_t *data = obs_data_array_item(array, i);
+		obs_source_t *source = obs_load_source(data);
+
+		if (source)
+			da_push_back(sources, &source);
+		obs_data_release(data);
+	}
+
+	for (i = 0; i < sources.num; i++)
+		obs_source_load(sources.array[i]);
+
+	for (i = 0; i < sources.num; i++) {
+		if (cb)
+			cb(private_data, sources.array[i]);
+		obs_source_release(sources.array[i]);
+	}
+	da_free(sources);
+}
+
+void obs_source_load(obs_source_t *source)
+{
+	if (source && source->info->load && source->context.data)
+		source->info->load(source->context.data,
+			source->context.settings);
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+	if (!source)
+		return NULL;
+
+	obs_weak_source_addref(source->control);
+	return source->control;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+	obs_source_t *source = NULL;
+
+	if (!weak)
+		return NULL;
+
+	pthread_mutex_lock(&obs.mutex);
+	if (weak->source && os_atomic_load_long(&weak->source->refs) > 0) {
+		source = weak->source;
+		obs_source_addref(source);
+	}
+	pthread_mutex_unlock(&obs.mutex);
+	return source;
+}
+
+void obs_weak_source_addref(obs_weak_source_t *weak)
+{
+	if (weak)
+		os_atomic_inc_long(&weak->refs);
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+	if (weak && os_atomic_dec_long(&weak->refs) == 0)
+		bfree(weak);
+}
+
+bool obs_weak_source_references_source(obs_weak_source_t *weak,
+	obs_source_t *source)
+{
+	return weak && source && weak->source == source;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->context.name : NULL;
+}
+
+const char *obs_source_get_id(const obs_source_t *source)
+{
+	return source ? source->id : NULL;
+}
+
+enum obs_source_type obs_source_get_type(const obs_source_t *source)
+{
+	return source ? source->info->type : OBS_SOURCE_TYPE_INPUT;
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	if (!source)
+		return NULL;
+
+	obs_data_addref(source->context.settings);
+	return source->context.settings;
+}
+
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	if (!source)
+		return;
+
+	obs_data_apply(source->context.settings, settings);
+	if (!source->info->update)
+		return;
+
+	// Like libobs, video sources pick the update up on their next tick
+	if (source->info->output_flags & OBS_SOURCE_VIDEO)
+		os_atomic_set_long(&source->defer_update, 1);
+	else if (source->context.data)
+		source->info->update(source->context.data,
+			source->context.settings);
+}
+
+uint32_t obs_source_get_width(obs_source_t *source)
+{
+	if (!source || !source->info->get_width || !source->context.data)
+		return 0;
+	return source->info->get_width(source->context.data);
+}
+
+uint32_t obs_source_get_height(obs_source_t *source)
+{
+	if (!source || !source->info->get_height || !source->context.data)
+		return 0;
+	return source->info->get_height(source->context.data);
+}
+
+uint32_t obs_source_get_base_width(obs_source_t *source)
+{
+	return obs_source_get_width(source);
+}
+
+uint32_t obs_source_get_base_height(obs_source_t *source)
+{
+	return obs_source_get_height(source);
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+	return source ? source->context.signals : NULL;
+}
+
+proc_handler_t *obs_source_get_proc_handler(const obs_source_t *source)
+{
+	return source ? source->context.procs : NULL;
+}
+
+void obs_source_video_render(obs_source_t *source)
+{
+	if (!source)
+		return;
+
+	stub_count(&stub_counters.renders);
+	source->renders++;
+	if (source->info->video_render && source->context.data)
+		source->info->video_render(source->context.data, NULL);
+}
+
+/* Activation */
+
+static void activate(obs_source_t *source)
+{
+	if (os_atomic_inc_long(&source->activate_refs) == 1) {
+		signal_source(source, "activate");
+		stub_refresh_active(source);
+	}
+}
+
+static void deactivate(obs_source_t *source)
+{
+	if (os_atomic_dec_long(&source->activate_refs) == 0) {
+		signal_source(source, "deactivate");
+		stub_refresh_active(source);
+	}
+}
+
+struct source_list {
+	DARRAY(obs_source_t *) sources;
+};
+
+static void add_shown(obs_source_t *parent, obs_source_t *child, void *param)
+{
+	struct source_list *shown = param;
+
+	if (child && da_find(shown->sources, &child, 0) == DARRAY_INVALID)
+		da_push_back(shown->sources, &child);
+	UNUSED_PARAMETER(parent);
+}
+
+void stub_refresh_active(obs_source_t *source)
+{
+	struct source_list list = { 0 };
+	size_t i;
+
+	// Sources nobody shows, like scenes being duplicated, stay out of it
+	if (!os_atomic_load_long(&source->activate_refs) &&
+		!source->activated.num)
+		return;
+
+	pthread_mutex_lock(&obs.mutex);
+
+	if (os_atomic_load_long(&source->activate_refs)) {
+		if (source->info->type == OBS_SOURCE_TYPE_TRANSITION) {
+			add_shown(source, source->transition_sources[0], &list);
+			add_shown(source, source->transition_sources[1], &list);
+		}
+		if (source->info->enum_active_sources && source->context.data)
+			source->info->enum_active_sources(source->context.data,
+				add_shown, &list);
+		for (i = 0; i < source->active_children.num; i++)
+			add_shown(source, source->active_children.array[i],
+				&list);
+	}
+
+	for (i = source->activated.num; i > 0; i--) {
+		obs_source_t *child = source->activated.array[i - 1];
+
+		if (da_find(list.sources, &child, 0) == DARRAY_INVALID) {
+			da_erase(source->activated, i - 1);
+			deactivate(child);
+			obs_source_release(child);
+		}
+	}
+
+	for (i = 0; i < list.sources.num; i++) {
+		obs_source_t *child = list.sources.array[i];
+
+		if (da_find(source->activated, &child, 0) == DARRAY_INVALID) {
+			obs_source_addref(child);
+			da_push_back(source->activated, &child);
+			activate(child);
+		}
+	}
+
+	pthread_mutex_unlock(&obs.mutex);
+	da_free(list.sources);
+}
+
+bool obs_source_active(const obs_source_t *source)
+{
+	return source && os_atomic_load_long(&source->activate_refs) > 0;
+}
+
+bool obs_source_showing(const obs_source_t *source)
+{
+	return obs_source_active(source);
+}
+
+bool obs_source_add_active_child(obs_source_t *parent, obs_source_t *child)
+{
+	if (!parent || !child || parent == child)
+		return false;
+
+	obs_source_addref(child);
+	da_push_back(parent->active_children, &child);
+	stub_refresh_active(parent);
+	return true;
+}
+
+void obs_source_remove_active_child(obs_source_t *parent,
+	obs_source_t *child)
+{
+	size_t idx;
+
+	if (!parent || !child)
+		return;
+
+	idx = da_find(parent->active_children, &child, 0);
+	if (idx == DARRAY_INVALID)
+		return;
+
+	da_erase(parent->active_children, idx);
+	stub_refresh_active(parent);
+	obs_source_release(child);
+}
+
+static void send_event(enum obs_frontend_event event)
+{
+	DARRAY(struct frontend_callback) events = { 0 };
+	size_t i;
+
+	da_copy(events, obs.events);
+	for (i = 0; i < events.num; i++)
+		events.array[i].callback(event, events.array[i].data);
+	da_free(events);
+}
+
+void obs_stub_set_program(obs_source_t *source)
+{
+	obs_source_t *prev = obs.program;
+
+	if (source == prev)
+		return;
+
+	obs.program = source;
+	if (source) {
+		obs_source_addref(source);
+		activate(source);
+	}
+	if (prev) {
+		deactivate(prev);
+		obs_source_release(prev);
+	}
+
+	if (source)
+		send_event(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+}
+
+void obs_stub_set_preview(obs_source_t *source)
+{
+	obs_source_addref(source);
+	obs_source_release(obs.preview);
+	obs.preview = source;
+	send_event(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+}
+
+void obs_stub_set_studio_mode(bool enabled)
+{
+	obs.studio_mode = enabled;
+	send_event(enabled ? OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED :
+		OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED);
+}
+
+void obs_stub_set_transition(obs_source_t *transition)
+{
+	obs_source_addref(transition);
+	obs_source_release(obs.transition);
+	obs.transition = transition;
+	send_event(OBS_FRONTEND_EVENT_TRANSITION_CHANGED);
+}
+
+/* Filters */
+
+void obs_source_filter_add(obs_source_t *source, obs_source_t *filter)
+{
+	calldata_t cd = { 0 };
+
+	if (!source || !filter || filter->filter_parent)
+		return;
+
+	obs_source_addref(filter);
+	filter->filter_parent = source;
+	da_push_back(source->filters, &filter);
+
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_ptr(&cd, "filter", filter);
+	stub_signal(source, "filter_add", &cd);
+	calldata_free(&cd);
+}
+
+void obs_source_filter_remove(obs_source_t *source, obs_source_t *filter)
+{
+	calldata_t cd = { 0 };
+	size_t idx;
+
+	if (!source || !filter)
+		return;
+
+	idx = da_find(source->filters, &filter, 0);
+	if (idx == DARRAY_INVALID)
+		return;
+
+	da_erase(source->filters, idx);
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_ptr(&cd, "filter", filter);
+	stub_signal(source, "filter_remove", &cd);
+	calldata_free(&cd);
+
+	if (filter->info->filter_remove && filter->context.data)
+		filter->info->filter_remove(filter->context.data, source);
+	filter->filter_parent = NULL;
+	obs_source_release(filter);
+}
+
+void obs_source_enum_filters(obs_source_t *source,
+	obs_source_enum_proc_t callback, void *param)
+{
+	size_t i;
+
+	if (!source)
+		return;
+
+	for (i = source->filters.num; i > 0; i--)
+		callback(source, source->filters.array[i - 1], param);
+}
+
+obs_source_t *obs_filter_get_parent(const obs_source_t *filter)
+{
+	return filter ? filter->filter_parent : NULL;
+}
+
+obs_source_t *obs_source_get_filter_by_name(obs_source_t *source,
+	const char *name)
+{
+	size_t i;
+
+	if (!source || !name)
+		return NULL;
+
+	for (i = 0; i < source->filters.num; i++) {
+		obs_source_t *filter = source->filters.array[i];
+
+		if (filter->context.name &&
+			strcmp(filter->context.name, name) == 0) {
+			obs_source_addref(filter);
+			return filter;
+		}
+	}
+	return NULL;
+}
+
+/* Transitions */
+
+float obs_transition_get_time(obs_source_t *transition)
+{
+	return transition ? transition->transition_time : 0.0f;
+}
+
+obs_source_t *obs_transition_get_source(obs_source_t *transition,
+	enum obs_transition_target target)
+{
+	obs_source_t *source;
+
+	if (!transition)
+		return NULL;
+
+	source = transition->transition_sources[target];
+	obs_source_addref(source);
+	return source;
+}
+
+/* The destination while transitioning, as libobs. */
+
+obs_source_t *obs_transition_get_active_source(obs_source_t *transition)
+{
+	obs_source_t *source;
+
+	if (!transition)
+		return NULL;
+
+	source = transition->transition_sources[OBS_TRANSITION_SOURCE_B];
+	if (!source)
+		source = transition->transition_sources[OBS_TRANSITION_SOURCE_A];
+	obs_source_addref(source);
+	return source;
+}
+
+void obs_transition_video_render_direct(obs_source_t *transition,
+	enum obs_transition_target target)
+{
+	if (transition)
+		obs_source_video_render(transition->transition_sources[target]);
+}
+
+bool obs_transition_audio_render(obs_source_t *transition, uint64_t *ts_out,
+	struct obs_source_audio_mix *audio, uint32_t mixers, size_t channels,
+	size_t sample_rate, obs_transition_audio_mix_callback_t mix_a,
+	obs_transition_audio_mix_callback_t mix_b)
+{
+	UNUSED_PARAMETER(transition);
+	UNUSED_PARAMETER(ts_out);
+	UNUSED_PARAMETER(audio);
+	UNUSED_PARAMETER(mixers);
+	UNUSED_PARAMETER(channels);
+	UNUSED_PARAMETER(sample_rate);
+	UNUSED_PARAMETER(mix_a);
+	UNUSED_PARAMETER(mix_b);
+	return false;
+}
+
+void obs_stub_transition_start(obs_source_t *transition, obs_source_t *from,
+	obs_source_t *to)
+{
+	obs_source_t **sources = transition->transition_sources;
+
+	if (from && from != sources[OBS_TRANSITION_SOURCE_A]) {
+		obs_source_addref(from);
+		obs_source_release(sources[OBS_TRANSITION_SOURCE_A]);
+		sources[OBS_TRANSITION_SOURCE_A] = from;
+	}
+
+	obs_source_addref(to);
+	obs_source_release(sources[OBS_TRANSITION_SOURCE_B]);
+	sources[OBS_TRANSITION_SOURCE_B] = to;
+	transition->transition_time = 0.0f;
+	stub_refresh_active(transition);
+
+	if (transition->info->transition_start)
+		transition->info->transition_start(transition->context.data);
+}
+
+void obs_stub_transition_render(obs_source_t *transition, float t)
+{
+	transition->transition_time = t;
+	obs_source_video_render(transition);
+}
+
+void obs_stub_transition_stop(obs_source_t *transition)
+{
+	obs_source_t **sources = transition->transition_sources;
+
+	if (transition->info->transition_stop)
+		transition->info->transition_stop(transition->context.data);
+
+	obs_source_release(sources[OBS_TRANSITION_SOURCE_A]);
+	sources[OBS_TRANSITION_SOURCE_A] = sources[OBS_TRANSITION_SOURCE_B];
+	sources[OBS_TRANSITION_SOURCE_B] = NULL;
+	transition->transition_time = 1.0f;
+	stub_refresh_active(transition);
+}
+
+/* Hotkeys */
+
+static obs_hotkey_id register_hotkey(obs_hotkey_func func, void *data)
+{
+	struct hotkey hotkey = { 0, func, data };
+
+	pthread_mutex_lock(&obs.mutex);
+	hotkey.id = obs.next_hotkey++;
+	da_push_back(obs.hotkeys, &hotkey);
+	pthread_mutex_unlock(&obs.mutex);
+	return hotkey.id;
+}
+
+obs_hotkey_id obs_hotkey_register_frontend(const char *name,
+	const char *description, obs_hotkey_func func, void *data)
+{
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	return register_hotkey(func, data);
+}
+
+obs_hotkey_id obs_hotkey_register_source(obs_source_t *source,
+	const char *name, const char *description, obs_hotkey_func func,
+	void *data)
+{
+	UNUSED_PARAMETER(source);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(description);
+	return register_hotkey(func, data);
+}
+
+void obs_hotkey_unregister(obs_hotkey_id id)
+{
+	size_t i;
+
+	pthread_mutex_lock(&obs.mutex);
+	for (i = 0; i < obs.hotkeys.num; i++) {
+		if (obs.hotkeys.array[i].id == id) {
+			da_erase(obs.hotkeys, i);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&obs.mutex);
+}
+
+void obs_hotkey_load(obs_hotkey_id id, obs_data_array_t *data)
+{
+	UNUSED_PARAMETER(id);
+	UNUSED_PARAMETER(data);
+}
+
+obs_data_array_t *obs_hotkey_save(obs_hotkey_id id)
+{
+	UNUSED_PARAMETER(id);
+	return obs_data_array_create();
+}
+
+obs_hotkey_id obs_stub_find_hotkey(void *data, size_t index)
+{
+	obs_hotkey_id id = OBS_INVALID_HOTKEY_ID;
+	size_t i;
+
+	pthread_mutex_lock(&obs.mutex);
+	for (i = 0; i < obs.hotkeys.num; i++) {
+		if (obs.hotkeys.array[i].data == data && index-- == 0) {
+			id = obs.hotkeys.array[i].id;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&obs.mutex);
+	return id;
+}
+
+bool obs_stub_press_hotkey(obs_hotkey_id id)
+{
+	struct hotkey hotkey = { 0 };
+	size_t i;
+
+	pthread_mutex_lock(&obs.mutex);
+	for (i = 0; i < obs.hotkeys.num; i++) {
+		if (obs.hotkeys.array[i].id == id) {
+			hotkey = obs.hotkeys.array[i];
+			break;
+		}
+	}
+	pthread_mutex_unlock(&obs.mutex);
+
+	if (!hotkey.func)
+		return false;
+
+	hotkey.func(hotkey.data, id, NULL, true);
+	return true;
+}
+
+/* Frontend */
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback,
+	void *private_data)
+{
+	struct frontend_callback entry = { callback, private_data };
+	da_push_back(obs.events, &entry);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback,
+	void *private_data)
+{
+	struct frontend_callback entry = { callback, private_data };
+	da_erase_item(obs.events, &entry);
+}
+
+obs_source_t *obs_frontend_get_current_scene(void)
+{
+	obs_source_addref(obs.program);
+	return obs.program;
+}
+
+obs_source_t *obs_frontend_get_current_preview_scene(void)
+{
+	obs_source_t *scene = obs.studio_mode ? obs.preview : obs.program;
+
+	obs_source_addref(scene);
+	return scene;
+}
+
+obs_source_t *obs_frontend_get_current_transition(void)
+{
+	obs_source_addref(obs.transition);
+	return obs.transition;
+}
+
+bool obs_frontend_preview_program_mode_active(void)
+{
+	return obs.studio_mode;
+}
@@ -0,0 +1,43 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <obs-scene.h>
+#include "obs-stub.h"
+
+/* Shared between the parts of the stub, not seen by the plugins. */
+
+extern struct obs_source_info stub_scene_info;
+extern struct obs_source_info stub_group_info;
+extern struct obs_stub_counters stub_counters;
+
+static inline void stub_count(uint64_t *counter)
+{
+	__atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+void stub_signal(obs_source_t *source, const char *signal, calldata_t *cd);
+
+/*
+ * Brings the sources activated by this one in line with what it shows
+ * now, after items, visibility or transition sources changed.
+ */
+void stub_refresh_active(obs_source_t *source);
@@ -0,0 +1,451 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <util/base.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/threading.h>
+#include "obs-stub.h"
+
+/* Memory and logging */
+
+static int log_level = LOG_WARNING;
+
+void *bmalloc(size_t size)
+{
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		fprintf(stderr, "out of memory allocating %zu bytes\n", size);
+		abort();
+	}
+	return ptr;
+}
+
+void *brealloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size ? size : 1);
+	if (!ptr) {
+		fprintf(stderr, "out of memory allocating %zu bytes\n", size);
+		abort();
+	}
+	return ptr;
+}
+
+void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+void obs_stub_set_log_level(int level)
+{
+	log_level = level;
+}
+
+void blog(int level, const char *format, ...)
+{
+	static const char *names[] = { "error", "warning", "info", "debug" };
+	va_list args;
+
+	if (level > log_level)
+		return;
+
+	va_start(args, format);
+	fprintf(stderr, "%s: ", names[level / 100 - 1 < 4 ? level / 100 - 1 :
+		3]);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+}
+
+void profile_start(const char *name)
+{
+	UNUSED_PARAMETER(name);
+}
+
+void profile_end(const char *name)
+{
+	UNUSED_PARAMETER(name);
+}
+
+/* Strings */
+
+static void dstr_ensure_capacity(struct dstr *dst, size_t size)
+{
+	if (size <= dst->capacity)
+		return;
+
+	dst->capacity = size < dst->capacity * 2 ? dst->capacity * 2 : size;
+	dst->array = brealloc(dst->array, dst->capacity);
+}
+
+void dstr_free(struct dstr *dst)
+{
+	bfree(dst->array);
+	dstr_init(dst);
+}
+
+void dstr_ncopy(struct dstr *dst, const char *array, const size_t len)
+{
+	dstr_free(dst);
+	if (!array || !len)
+		return;
+
+	dstr_ensure_capacity(dst, len + 1);
+	memcpy(dst->array, array, len);
+	dst->array[len] = 0;
+	dst->len = len;
+}
+
+void dstr_copy(struct dstr *dst, const char *array)
+{
+	dstr_ncopy(dst, array, array ? strlen(array) : 0);
+}
+
+void dstr_ncat(struct dstr *dst, const char *array, const size_t len)
+{
+	if (!array || !len)
+		return;
+
+	dstr_ensure_capacity(dst, dst->len + len + 1);
+	memcpy(dst->array + dst->len, array, len);
+	dst->len += len;
+	dst->array[dst->len] = 0;
+}
+
+void dstr_cat(struct dstr *dst, const char *array)
+{
+	if (array)
+		dstr_ncat(dst, array, strlen(array));
+}
+
+void dstr_cat_ch(struct dstr *dst, char ch)
+{
+	dstr_ncat(dst, &ch, 1);
+}
+
+void dstr_replace(struct dstr *str, const char *find, const char *replace)
+{
+	struct dstr result = { 0 };
+	size_t find_len = find ? strlen(find) : 0;
+	const char *pos, *match;
+
+	if (!str->array || !find_len)
+		return;
+
+	for (pos = str->array; (match = strstr(pos, find)) != NULL;
+		pos = match + find_len) {
+		dstr_ncat(&result, pos, match - pos);
+		dstr_cat(&result, replace);
+	}
+	dstr_cat(&result, pos);
+
+	dstr_free(str);
+	*str = result;
+}
+
+static void dstr_vcatf(struct dstr *dst, const char *format, va_list args)
+{
+	va_list copy;
+	int len;
+
+	va_copy(copy, args);
+	len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (len <= 0)
+		return;
+
+	dstr_ensure_capacity(dst, dst->len + len + 1);
+	vsnprintf(dst->array + dst->len, len + 1, format, args);
+	dst->len += len;
+}
+
+void dstr_printf(struct dstr *dst, const char *format, ...)
+{
+	va_list args;
+
+	dstr_free(dst);
+	va_start(args, format);
+	dstr_vcatf(dst, format, args);
+	va_end(args);
+}
+
+void dstr_catf(struct dstr *dst, const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	dstr_vcatf(dst, format, args);
+	va_end(args);
+}
+
+/* Platform */
+
+uint64_t os_gettime_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void os_sleep_ms(uint32_t duration)
+{
+	usleep(duration * 1000);
+}
+
+FILE *os_fopen(const char *path, const char *mode)
+{
+	return path ? fopen(path, mode) : NULL;
+}
+
+int64_t os_fgetsize(FILE *file)
+{
+	long cur = ftell(file);
+	long size;
+
+	if (cur < 0 || fseek(file, 0, SEEK_END) != 0)
+		return -1;
+
+	size = ftell(file);
+	fseek(file, cur, SEEK_SET);
+	return size;
+}
+
+char *os_quick_read_utf8_file(const char *path)
+{
+	FILE *file = os_fopen(path, "rb");
+	int64_t size;
+	char *data;
+
+	if (!file)
+		return NULL;
+
+	size = os_fgetsize(file);
+	if (size < 0) {
+		fclose(file);
+		return NULL;
+	}
+
+	data = bmalloc((size_t)size + 1);
+	data[fread(data, 1, (size_t)size, file)] = 0;
+	fclose(file);
+	return data;
+}
+
+int os_mkdir(const char *path)
+{
+	if (mkdir(path, 0755) == 0)
+		return MKDIR_SUCCESS;
+	return errno == EEXIST ? MKDIR_EXISTS : MKDIR_ERROR;
+}
+
+int os_mkdirs(const char *dir)
+{
+	char *path = bstrdup(dir);
+	char *pos;
+	int result;
+
+	for (pos = strchr(path + 1, '/'); pos; pos = strchr(pos + 1, '/')) {
+		*pos = 0;
+		if (os_mkdir(path) == MKDIR_ERROR) {
+			bfree(path);
+			return MKDIR_ERROR;
+		}
+		*pos = '/';
+	}
+
+	result = os_mkdir(path);
+	bfree(path);
+	return result;
+}
+
+bool os_file_exists(const char *path)
+{
+	return access(path, F_OK) == 0;
+}
+
+int os_unlink(const char *path)
+{
+	return unlink(path);
+}
+
+int os_rename(const char *old_path, const char *new_path)
+{
+	return rename(old_path, new_path);
+}
+
+int os_get_logical_cores(void)
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (int)cores : 1;
+}
+
+/* Threading */
+
+struct os_event_data {
+	pthread_mutex_t     mutex;
+	pthread_cond_t      cond;
+	volatile bool       signalled;
+	bool                manual;
+};
+
+int os_event_init(os_event_t **event, enum os_event_type type)
+{
+	struct os_event_data *data = bzalloc(sizeof(*data));
+
+	pthread_mutex_init(&data->mutex, NULL);
+	pthread_cond_init(&data->cond, NULL);
+	data->manual = type == OS_EVENT_TYPE_MANUAL;
+	*event = data;
+	return 0;
+}
+
+void os_event_destroy(os_event_t *event)
+{
+	if (!event)
+		return;
+
+	pthread_cond_destroy(&event->cond);
+	pthread_mutex_destroy(&event->mutex);
+	bfree(event);
+}
+
+int os_event_wait(os_event_t *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	while (!event->signalled)
+		pthread_cond_wait(&event->cond, &event->mutex);
+	if (!event->manual)
+		event->signalled = false;
+	pthread_mutex_unlock(&event->mutex);
+	return 0;
+}
+
+int os_event_timedwait(os_event_t *event, unsigned long milliseconds)
+{
+	struct timespec ts;
+	int code = 0;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += milliseconds / 1000;
+	ts.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&event->mutex);
+	while (!event->signalled && code == 0)
+		code = pthread_cond_timedwait(&event->cond, &event->mutex, &ts);
+	if (event->signalled) {
+		if (!event->manual)
+			event->signalled = false;
+		code = 0;
+	}
+	pthread_mutex_unlock(&event->mutex);
+	return code;
+}
+
+int os_event_try(os_event_t *event)
+{
+	int code = EAGAIN;
+
+	pthread_mutex_lock(&event->mutex);
+	if (event->signalled) {
+		if (!event->manual)
+			event->signalled = false;
+		code = 0;
+	}
+	pthread_mutex_unlock(&event->mutex);
+	return code;
+}
+
+int os_event_signal(os_event_t *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	event->signalled = true;
+	pthread_cond_broadcast(&event->cond);
+	pthread_mutex_unlock(&event->mutex);
+	return 0;
+}
+
+void os_event_reset(os_event_t *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	event->signalled = false;
+	pthread_mutex_unlock(&event->mutex);
+}
+
+struct os_sem_data {
+	pthread_mutex_t     mutex;
+	pthread_cond_t      cond;
+	int                 count;
+};
+
+int os_sem_init(os_sem_t **sem, int value)
+{
+	struct os_sem_data *data = bzalloc(sizeof(*data));
+
+	pthread_mutex_init(&data->mutex, NULL);
+	pthread_cond_init(&data->cond, NULL);
+	data->count = value;
+	*sem = data;
+	return 0;
+}
+
+void os_sem_destroy(os_sem_t *sem)
+{
+	if (!sem)
+		return;
+
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->mutex);
+	bfree(sem);
+}
+
+int os_sem_post(os_sem_t *sem)
+{
+	pthread_mutex_lock(&sem->mutex);
+	sem->count++;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->mutex);
+	return 0;
+}
+
+int os_sem_wait(os_sem_t *sem)
+{
+	pthread_mutex_lock(&sem->mutex);
+	while (sem->count <= 0)
+		pthread_cond_wait(&sem->cond, &sem->mutex);
+	sem->count--;
+	pthread_mutex_unlock(&sem->mutex);
+	return 0;
+}
+
+void os_set_thread_name(const char *name)
+{
+	UNUSED_PARAMETER(name);
+}
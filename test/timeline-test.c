@@ -0,0 +1,85 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include "motion-timeline.h"
+#include "check.h"
+
+static void set_vec4(struct vec4 *v, float value)
+{
+	vec4_set(v, value, value, value, value);
+}
+
+/* Easing 1 is an ease in, t^2, and -1 an ease out, 2t - t^2. */
+
+static void test_eased_segment(float easing, float expected)
+{
+	struct motion_timeline timeline = { 0 };
+	struct timeline_segment *seg;
+	struct vec4 from, to, result;
+
+	set_vec4(&from, 0.0f);
+	set_vec4(&to, 100.0f);
+	timeline_reset(&timeline, &from);
+	timeline_add_segment(&timeline, 1.0f, 3.0f, &from, &to, easing);
+
+	seg = &timeline.segments.array[0];
+	CHECK(seg->eased);
+	CHECK(seg->ease_poly[CURVE_MAX_ORDER] == 0.0f);
+
+	// Halfway through the segment the linear ramp is at 50
+	timeline_eval(&timeline, 2.0f, &result);
+	CHECK_NEAR(result.x, expected, 0.01);
+	CHECK(fabsf(result.x - 50.0f) > 10.0f);
+	CHECK_NEAR(result.w, result.x, 0.0001);
+
+	timeline_eval(&timeline, 1.0f, &result);
+	CHECK_NEAR(result.x, 0.0, 0.0001);
+	timeline_eval(&timeline, 3.0f, &result);
+	CHECK_NEAR(result.x, 100.0, 0.0001);
+
+	timeline_free(&timeline);
+}
+
+static void test_linear_segment(void)
+{
+	struct motion_timeline timeline = { 0 };
+	struct vec4 from, to, result;
+
+	set_vec4(&from, -20.0f);
+	set_vec4(&to, 20.0f);
+	timeline_reset(&timeline, &from);
+	timeline_add_segment(&timeline, 0.0f, 1.0f, &from, &to, 0.0f);
+
+	CHECK(!timeline.segments.array[0].eased);
+	timeline_eval(&timeline, 0.25f, &result);
+	CHECK_NEAR(result.y, -10.0, 0.0001);
+
+	timeline_free(&timeline);
+}
+
+int main(void)
+{
+	test_eased_segment(1.0f, 25.0f);
+	test_eased_segment(-1.0f, 75.0f);
+	test_linear_segment();
+	return check_failures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include <math.h>
+#include <util/platform.h>
+#include "trace-reader.h"
+
+#define TRACE_MAX_REPORTS   10
+
+static bool get(struct trace_reader *reader, void *data, size_t size)
+{
+	if (reader->size - reader->pos < size)
+		return false;
+
+	memcpy(data, reader->data + reader->pos, size);
+	reader->pos += size;
+	return true;
+}
+
+static bool get_string(struct trace_reader *reader, char *str)
+{
+	uint16_t size;
+
+	if (!get(reader, &size, sizeof(size)) || size >= TRACE_NAME_SIZE)
+		return false;
+	if (!get(reader, str, size))
+		return false;
+
+	str[size] = 0;
+	return true;
+}
+
+bool trace_reader_open(struct trace_reader *reader, const char *path)
+{
+	char magic[4];
+	uint32_t version;
+	FILE *file = os_fopen(path, "rb");
+	int64_t size;
+
+	memset(reader, 0, sizeof(*reader));
+	if (!file)
+		return false;
+
+	size = os_fgetsize(file);
+	reader->data = bmalloc(size > 0 ? (size_t)size : 1);
+	reader->size = size > 0 ? (size_t)fread(reader->data, 1, (size_t)size,
+		file) : 0;
+	fclose(file);
+
+	if (get(reader, magic, sizeof(magic)) &&
+		memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0 &&
+		get(reader, &version, sizeof(version)) &&
+		version == TRACE_VERSION &&
+		get_string(reader, reader->module))
+		return true;
+
+	trace_reader_free(reader);
+	return false;
+}
+
+void trace_reader_free(struct trace_reader *reader)
+{
+	bfree(reader->data);
+	memset(reader, 0, sizeof(*reader));
+}
+
+bool trace_reader_next(struct trace_reader *reader, struct trace_entry *entry)
+{
+	int32_t crop[4];
+	int i;
+
+	memset(entry, 0, sizeof(*entry));
+	if (!get(reader, &entry->type, sizeof(entry->type)))
+		return false;
+
+	switch (entry->type) {
+	case TRACE_FRAME:
+		return get(reader, &entry->value[0], sizeof(float));
+	case TRACE_TRIGGER:
+		return get(reader, &entry->forward, sizeof(uint8_t)) &&
+			get_string(reader, entry->scene_name) &&
+			get_string(reader, entry->name);
+	case TRACE_DEACTIVATE:
+		return get_string(reader, entry->scene_name) &&
+			get_string(reader, entry->name);
+	}
+
+	if (!get(reader, &entry->scene, sizeof(uint32_t)) ||
+		!get(reader, &entry->item, sizeof(uint32_t)))
+		return false;
+
+	switch (entry->type) {
+	case TRACE_POS:
+	case TRACE_SCALE:
+	case TRACE_BOUNDS:
+		return get(reader, entry->value, sizeof(float) * 2);
+	case TRACE_ROT:
+		return get(reader, entry->value, sizeof(float));
+	case TRACE_CROP:
+		if (!get(reader, crop, sizeof(crop)))
+			return false;
+		for (i = 0; i < 4; i++)
+			entry->value[i] = (float)crop[i];
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Anything but a value out of tolerance means the two runs went apart and
+ * the rest of the traces can not be lined up any more.
+ */
+
+static bool same_entry(const struct trace_entry *a,
+	const struct trace_entry *b, float tolerance, float *error)
+{
+	int i;
+
+	*error = 0.0f;
+
+	if (a->type != b->type || a->scene != b->scene || a->item != b->item)
+		return false;
+
+	if (a->type == TRACE_TRIGGER || a->type == TRACE_DEACTIVATE)
+		return a->forward == b->forward &&
+			strcmp(a->scene_name, b->scene_name) == 0 &&
+			strcmp(a->name, b->name) == 0;
+
+	for (i = 0; i < 4; i++) {
+		float diff = fabsf(a->value[i] - b->value[i]);
+		if (diff > *error)
+			*error = diff;
+	}
+
+	return *error <= tolerance;
+}
+
+bool trace_compare(const char *reference, const char *replay, float tolerance,
+	struct trace_diff *diff)
+{
+	struct trace_reader ref_reader, replay_reader;
+	struct trace_entry a, b;
+	float error;
+	bool same;
+
+	memset(diff, 0, sizeof(*diff));
+	if (!trace_reader_open(&ref_reader, reference)) {
+		blog(LOG_WARNING, "trace: failed to read %s", reference);
+		return false;
+	}
+	if (!trace_reader_open(&replay_reader, replay) ||
+		strcmp(ref_reader.module, replay_reader.module) != 0) {
+		blog(LOG_WARNING, "trace: failed to read %s", replay);
+		trace_reader_free(&ref_reader);
+		return false;
+	}
+
+	while (trace_reader_next(&ref_reader, &a)) {
+		if (!trace_reader_next(&replay_reader, &b)) {
+			blog(LOG_WARNING, "trace: replay ended early");
+			diff->mismatches++;
+			break;
+		}
+
+		diff->records++;
+		same = same_entry(&a, &b, tolerance, &error);
+		if (error > diff->max_error)
+			diff->max_error = error;
+		if (same)
+			continue;
+
+		if (diff->mismatches++ < TRACE_MAX_REPORTS)
+			blog(LOG_WARNING, "trace: record %llu differs, type %d/%d "
+				"item %u/%u, error %f",
+				(unsigned long long)diff->records, a.type, b.type,
+				a.item, b.item, error);
+
+		if (a.type != b.type || a.item != b.item)
+			break;
+	}
+
+	// Anything the replay did on top of the reference is a mismatch too
+	if (!diff->mismatches && trace_reader_next(&replay_reader, &b)) {
+		blog(LOG_WARNING, "trace: replay recorded more than the "
+			"reference");
+		diff->mismatches++;
+	}
+
+	trace_reader_free(&replay_reader);
+	trace_reader_free(&ref_reader);
+	return true;
+}
@@ -0,0 +1,62 @@
+/*
+*	motion-effect, an OBS-Studio plugin for animating sources using
+*	transform manipulation on the scene.
+*	Copyright(C) <2018>  <CatxFish>
+*
+*	This program is free software; you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation; either version 2 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License along
+*	with this program; if not, write to the Free Software Foundation, Inc.,
+*	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include "trace.h"
+
+/*
+ * Reading traces written by trace.c and comparing two of them record by
+ * record, for the offline tools.
+ */
+
+struct trace_reader {
+	uint8_t             *data;
+	size_t              size;
+	size_t              pos;
+	char                module[TRACE_NAME_SIZE];
+};
+
+struct trace_entry {
+	uint8_t             type;
+	bool                forward;
+	uint32_t            scene;
+	uint32_t            item;
+	float               value[4];
+	char                scene_name[TRACE_NAME_SIZE];
+	char                name[TRACE_NAME_SIZE];
+};
+
+struct trace_diff {
+	uint64_t            records;
+	uint64_t            mismatches;
+	float               max_error;
+};
+
+bool trace_reader_open(struct trace_reader *reader, const char *path);
+void trace_reader_free(struct trace_reader *reader);
+bool trace_reader_next(struct trace_reader *reader, struct trace_entry *entry);
+
+/*
+ * Values may differ by the tolerance. Returns false when either trace can
+ * not be read or they belong to different modules.
+ */
+bool trace_compare(const char *reference, const char *replay, float tolerance,
+	struct trace_diff *diff);